@@ -0,0 +1,69 @@
+// STL includes
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <chrono>
+
+// Optimization lib includes
+#include <libs/optimization_lib/include/data_providers/mesh_wrapper.h>
+#include <libs/optimization_lib/include/iterative_methods/batch_localization.h>
+
+/**
+ * Usage: batch_localization <shape> <output directory> <partial 1> [<partial 2> ...]
+ *
+ * Localizes every partial in the shape, and writes <output directory>/<partial name>.txt for each partial:
+ * the objective value, followed by the localization indicator v (one value per shape vertex)
+ */
+int main(int argc, char* argv[])
+{
+	if (argc < 4)
+	{
+		std::cerr << "Usage: batch_localization <shape> <output directory> <partial 1> [<partial 2> ...]" << std::endl;
+		return 1;
+	}
+
+	const std::string shape_file_path = argv[1];
+	const std::filesystem::path output_directory = argv[2];
+	const std::vector<std::string> partial_file_paths(argv + 3, argv + argc);
+
+	auto shape = std::make_shared<MeshWrapper>(shape_file_path);
+	if (shape->GetDomainVerticesCount() == 0)
+	{
+		std::cerr << "Failed to load shape: " << shape_file_path << std::endl;
+		return 1;
+	}
+
+	std::filesystem::create_directories(output_directory);
+
+	const auto start = std::chrono::steady_clock::now();
+	BatchLocalization<Eigen::StorageOptions::RowMajor> batch_localization(shape);
+	batch_localization.Run(partial_file_paths);
+	const auto end = std::chrono::steady_clock::now();
+
+	int exit_code = 0;
+	for (const auto& result : batch_localization.GetResults())
+	{
+		if (!result.succeeded)
+		{
+			std::cerr << "Failed to localize partial: " << result.partial_file_path << std::endl;
+			exit_code = 1;
+			continue;
+		}
+
+		const std::filesystem::path output_file_path = output_directory / std::filesystem::path(result.partial_file_path).stem().concat(".txt");
+		std::ofstream output_file(output_file_path);
+		output_file.precision(17);
+		output_file << result.best.value << std::endl;
+		for (int64_t i = 0; i < result.best.x.rows(); i++)
+		{
+			output_file << result.best.x.coeff(i) << std::endl;
+		}
+
+		std::cout << result.partial_file_path << ": value " << result.best.value << ", " << result.best.iterations << " iterations, seed vertex " << result.best.seed_vertex_index << std::endl;
+	}
+
+	std::cout << "Localized " << partial_file_paths.size() << " partials in " << std::chrono::duration<double>(end - start).count() << "s" << std::endl;
+	return exit_code;
+}
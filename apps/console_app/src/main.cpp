@@ -82,7 +82,6 @@ void main()
 	//	auto image_vertices = mesh_wrapper_->GetImageVertices();
 	//	auto x0 = Eigen::Map<const Eigen::VectorXd>(image_vertices.data(), image_vertices.cols() * image_vertices.rows());
 	//	newton_method_ = std::make_unique<NewtonMethod<PardisoSolver, Eigen::StorageOptions::RowMajor>>(summation_objective_, x0);
-	//	newton_method_->EnableFlipAvoidingLineSearch(mesh_wrapper_->GetImageFaces());
 	//	newton_method_->Start();
 	//});
 
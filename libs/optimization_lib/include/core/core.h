@@ -4,6 +4,7 @@
 
 // STL includes
 #include <unordered_map>
+#include <vector>
 
 // Boost includes
 #include <boost/container_hash/hash.hpp>
@@ -17,6 +18,7 @@
 
 #define RDS_NEV 21
 #define RDS_NCV 80
+#define RDS_REDUCED_BASIS_SIZE 300
 
 namespace RDS
 {
@@ -265,6 +267,16 @@ namespace RDS
 	using DenseVariableIndexToSparseVariableIndexMap = std::unordered_map<RDS::DenseVariableIndex, RDS::SparseVariableIndex>;
 	using HessianEntryToTripletIndexMap = std::unordered_map<RDS::HessianEntry, RDS::HessianTripletIndex, HessianEntryHash, HessianEntryEquals>;
 
+	/**
+	 * Flat index map types (for objectives over a small, fixed set of variables)
+	 */
+	using DenseVariableIndexToSparseVariableIndexArray = std::vector<RDS::SparseVariableIndex>;
+	using DenseVariableIndexToVertexIndexArray = std::vector<RDS::VertexIndex>;
+	using HessianTripletIndexToHessianEntryArray = std::vector<RDS::HessianEntry>;
+
+	// Row-major (row * variables_count + column)
+	using HessianEntryToTripletIndexArray = std::vector<RDS::HessianTripletIndex>;
+
 }
 
 #endif
\ No newline at end of file
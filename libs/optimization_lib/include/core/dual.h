@@ -0,0 +1,279 @@
+#pragma once
+#ifndef OPTIMIZATION_LIB_DUAL_H
+#define OPTIMIZATION_LIB_DUAL_H
+
+// STL includes
+#include <cmath>
+
+// Eigen includes
+#include <Eigen/Core>
+
+// First order forward-mode automatic differentiation scalar: the value of an expression of N variables, together with its gradient.
+// The first order counterpart of HyperDual (same interface, without the hessian), for evaluations that need no second derivatives.
+template<int N>
+class Dual
+{
+public:
+	/**
+	 * Public type definitions
+	 */
+	using GradientType = Eigen::Matrix<double, N, 1>;
+
+	/**
+	 * Constructors and destructor
+	 */
+
+	// A constant
+	Dual(const double value = 0) :
+		value_(value),
+		gradient_(GradientType::Zero())
+	{
+
+	}
+
+	// The variable_index-th variable
+	static Dual Variable(const double value, const int variable_index)
+	{
+		Dual variable(value);
+		variable.gradient_.coeffRef(variable_index) = 1;
+		return variable;
+	}
+
+	/**
+	 * Public getters
+	 */
+	double GetValue() const
+	{
+		return value_;
+	}
+
+	const GradientType& GetGradient() const
+	{
+		return gradient_;
+	}
+
+	/**
+	 * Public setters
+	 */
+
+	// Replaces the value, keeping the gradient (e.g. moves a variable to a new point)
+	void SetValue(const double value)
+	{
+		value_ = value;
+	}
+
+	/**
+	 * Chain rule
+	 */
+
+	// f(a), where df is the derivative of f at a
+	static Dual Chain(const Dual& a, const double f, const double df)
+	{
+		return Dual(f, df * a.gradient_);
+	}
+
+	// f(a, b), where fa and fb are the partial derivatives of f at (a, b)
+	static Dual Chain(const Dual& a, const Dual& b, const double f, const double fa, const double fb)
+	{
+		return Dual(f, (fa * a.gradient_) + (fb * b.gradient_));
+	}
+
+	/**
+	 * Operators
+	 */
+	Dual operator-() const
+	{
+		return Dual(-value_, -gradient_);
+	}
+
+	Dual& operator+=(const Dual& other)
+	{
+		value_ += other.value_;
+		gradient_ += other.gradient_;
+		return *this;
+	}
+
+	Dual& operator-=(const Dual& other)
+	{
+		value_ -= other.value_;
+		gradient_ -= other.gradient_;
+		return *this;
+	}
+
+	Dual& operator*=(const Dual& other)
+	{
+		*this = *this * other;
+		return *this;
+	}
+
+	Dual& operator/=(const Dual& other)
+	{
+		*this = *this / other;
+		return *this;
+	}
+
+	Dual& operator+=(const double other)
+	{
+		value_ += other;
+		return *this;
+	}
+
+	Dual& operator-=(const double other)
+	{
+		value_ -= other;
+		return *this;
+	}
+
+	Dual& operator*=(const double other)
+	{
+		value_ *= other;
+		gradient_ *= other;
+		return *this;
+	}
+
+	Dual& operator/=(const double other)
+	{
+		return *this *= (1 / other);
+	}
+
+	friend Dual operator+(const Dual& a, const Dual& b)
+	{
+		return Dual(a.value_ + b.value_, a.gradient_ + b.gradient_);
+	}
+
+	friend Dual operator-(const Dual& a, const Dual& b)
+	{
+		return Dual(a.value_ - b.value_, a.gradient_ - b.gradient_);
+	}
+
+	friend Dual operator*(const Dual& a, const Dual& b)
+	{
+		return Chain(a, b, a.value_ * b.value_, b.value_, a.value_);
+	}
+
+	friend Dual operator/(const Dual& a, const Dual& b)
+	{
+		const double inverse = 1 / b.value_;
+		const double quotient = a.value_ * inverse;
+		return Chain(a, b, quotient, inverse, -quotient * inverse);
+	}
+
+	friend Dual operator+(const Dual& a, const double b)
+	{
+		return Dual(a.value_ + b, a.gradient_);
+	}
+
+	friend Dual operator+(const double a, const Dual& b)
+	{
+		return b + a;
+	}
+
+	friend Dual operator-(const Dual& a, const double b)
+	{
+		return a + (-b);
+	}
+
+	friend Dual operator-(const double a, const Dual& b)
+	{
+		return Dual(a - b.value_, -b.gradient_);
+	}
+
+	friend Dual operator*(const Dual& a, const double b)
+	{
+		return Dual(a.value_ * b, b * a.gradient_);
+	}
+
+	friend Dual operator*(const double a, const Dual& b)
+	{
+		return b * a;
+	}
+
+	friend Dual operator/(const Dual& a, const double b)
+	{
+		return a * (1 / b);
+	}
+
+	friend Dual operator/(const double a, const Dual& b)
+	{
+		const double inverse = 1 / b.value_;
+		return Chain(b, a * inverse, -a * inverse * inverse);
+	}
+
+	friend bool operator<(const Dual& a, const Dual& b)
+	{
+		return a.value_ < b.value_;
+	}
+
+	friend bool operator>(const Dual& a, const Dual& b)
+	{
+		return a.value_ > b.value_;
+	}
+
+	/**
+	 * Functions (found by argument dependent lookup, so expressions may call them unqualified for both double and Dual)
+	 */
+	friend Dual sqrt(const Dual& a)
+	{
+		const double f = std::sqrt(a.value_);
+		return Chain(a, f, 0.5 / f);
+	}
+
+	// The derivative is evaluated directly (not as exponent * f / a), so it is also defined at a = 0
+	friend Dual pow(const Dual& a, const double exponent)
+	{
+		const double df = exponent == 0 ? 0 : exponent * std::pow(a.value_, exponent - 1);
+		return Chain(a, std::pow(a.value_, exponent), df);
+	}
+
+	friend Dual exp(const Dual& a)
+	{
+		const double f = std::exp(a.value_);
+		return Chain(a, f, f);
+	}
+
+	friend Dual log(const Dual& a)
+	{
+		return Chain(a, std::log(a.value_), 1 / a.value_);
+	}
+
+	friend Dual sin(const Dual& a)
+	{
+		return Chain(a, std::sin(a.value_), std::cos(a.value_));
+	}
+
+	friend Dual cos(const Dual& a)
+	{
+		return Chain(a, std::cos(a.value_), -std::sin(a.value_));
+	}
+
+	friend Dual abs(const Dual& a)
+	{
+		return a.value_ < 0 ? -a : a;
+	}
+
+	friend Dual atan2(const Dual& y, const Dual& x)
+	{
+		const double inverse = 1 / ((x.value_ * x.value_) + (y.value_ * y.value_));
+		return Chain(y, x, std::atan2(y.value_, x.value_), x.value_ * inverse, -y.value_ * inverse);
+	}
+
+private:
+	/**
+	 * Private constructors
+	 */
+	template<typename GradientExpression_>
+	Dual(const double value, const GradientExpression_& gradient) :
+		value_(value),
+		gradient_(gradient)
+	{
+
+	}
+
+	/**
+	 * Private fields
+	 */
+	double value_;
+	GradientType gradient_;
+};
+
+#endif
@@ -0,0 +1,483 @@
+#pragma once
+#ifndef OPTIMIZATION_LIB_HYPER_DUAL_H
+#define OPTIMIZATION_LIB_HYPER_DUAL_H
+
+// STL includes
+#include <cmath>
+#include <utility>
+
+// Eigen includes
+#include <Eigen/Core>
+
+// Second order forward-mode automatic differentiation scalar: the value of an expression of N variables, together with its gradient and (dense) hessian.
+// The derivatives are fixed-size Eigen vectors (stack allocated and vectorized), and each operation propagates them by the chain rule;
+// an expression that is written once in terms of a generic scalar type yields its value (double) or all of its derivatives up to second order (HyperDual<N>).
+// The hessian is symmetric, so only its upper triangle is kept, packed column by column (the layout of the local hessian triplets of ConcreteObjective).
+// Constants, variables and their linear combinations carry no hessian (it is zero), so the leaves of an expression cost no hessian arithmetic.
+template<int N>
+class HyperDual
+{
+public:
+	/**
+	 * Public type definitions
+	 */
+	static constexpr int PackedHessianSize = (N * (N + 1)) / 2;
+
+	using GradientType = Eigen::Matrix<double, N, 1>;
+	using HessianType = Eigen::Matrix<double, N, N>;
+	using PackedHessianType = Eigen::Matrix<double, PackedHessianSize, 1>;
+
+	/**
+	 * Constructors and destructor
+	 */
+
+	// A constant
+	HyperDual(const double value = 0) :
+		value_(value),
+		gradient_(GradientType::Zero()),
+		linear_(true)
+	{
+
+	}
+
+	// The hessian is copied only if it is used
+	HyperDual(const HyperDual& other) :
+		value_(other.value_),
+		gradient_(other.gradient_),
+		linear_(other.linear_)
+	{
+		if (!linear_)
+		{
+			hessian_ = other.hessian_;
+		}
+	}
+
+	HyperDual& operator=(const HyperDual& other)
+	{
+		value_ = other.value_;
+		gradient_ = other.gradient_;
+		linear_ = other.linear_;
+		if (!linear_)
+		{
+			hessian_ = other.hessian_;
+		}
+
+		return *this;
+	}
+
+	// The variable_index-th variable
+	static HyperDual Variable(const double value, const int variable_index)
+	{
+		HyperDual variable(value);
+		variable.gradient_.coeffRef(variable_index) = 1;
+		return variable;
+	}
+
+	/**
+	 * Public getters
+	 */
+	double GetValue() const
+	{
+		return value_;
+	}
+
+	const GradientType& GetGradient() const
+	{
+		return gradient_;
+	}
+
+	PackedHessianType GetPackedHessian() const
+	{
+		return linear_ ? PackedHessianType::Zero() : hessian_;
+	}
+
+	HessianType GetHessian() const
+	{
+		HessianType hessian;
+		const PackedHessianType packed_hessian = GetPackedHessian();
+		for (int column = 0, packed_index = 0; column < N; column++)
+		{
+			for (int row = 0; row <= column; row++, packed_index++)
+			{
+				hessian.coeffRef(row, column) = packed_hessian.coeff(packed_index);
+				hessian.coeffRef(column, row) = packed_hessian.coeff(packed_index);
+			}
+		}
+
+		return hessian;
+	}
+
+	/**
+	 * Public setters
+	 */
+
+	// Replaces the value, keeping the derivatives (e.g. moves a variable to a new point)
+	void SetValue(const double value)
+	{
+		value_ = value;
+	}
+
+	/**
+	 * Chain rule
+	 */
+
+	// f(a), where df and ddf are the first and second derivatives of f at a
+	static HyperDual Chain(const HyperDual& a, const double f, const double df, const double ddf)
+	{
+		HyperDual result(f, df * a.gradient_);
+		const GradientType scaled_gradient = ddf * a.gradient_;
+		SetOuterProduct(result.hessian_, a.gradient_, scaled_gradient, std::make_integer_sequence<int, N>());
+
+		if (!a.linear_)
+		{
+			result.hessian_ += df * a.hessian_;
+		}
+
+		return result;
+	}
+
+	// f(a, b), where fa, fb, faa, fab and fbb are the partial derivatives of f at (a, b)
+	static HyperDual Chain(const HyperDual& a, const HyperDual& b, const double f, const double fa, const double fb, const double faa, const double fab, const double fbb)
+	{
+		HyperDual result(f, (fa * a.gradient_) + (fb * b.gradient_));
+
+		// The second order terms form the rank 2 update [grad(a) grad(b)] * [faa fab; fab fbb] * [grad(a) grad(b)]^T, applied as two outer products
+		const GradientType scaled_gradient_a = (faa * a.gradient_) + (fab * b.gradient_);
+		const GradientType scaled_gradient_b = (fab * a.gradient_) + (fbb * b.gradient_);
+		SetOuterProducts(result.hessian_, a.gradient_, scaled_gradient_a, b.gradient_, scaled_gradient_b, std::make_integer_sequence<int, N>());
+
+		if (!a.linear_)
+		{
+			result.hessian_ += fa * a.hessian_;
+		}
+
+		if (!b.linear_)
+		{
+			result.hessian_ += fb * b.hessian_;
+		}
+
+		return result;
+	}
+
+	/**
+	 * Operators
+	 */
+	HyperDual operator-() const
+	{
+		return Scale(*this, -1, 0);
+	}
+
+	HyperDual& operator+=(const HyperDual& other)
+	{
+		value_ += other.value_;
+		gradient_ += other.gradient_;
+		if (!other.linear_)
+		{
+			if (linear_)
+			{
+				hessian_ = other.hessian_;
+				linear_ = false;
+			}
+			else
+			{
+				hessian_ += other.hessian_;
+			}
+		}
+
+		return *this;
+	}
+
+	HyperDual& operator-=(const HyperDual& other)
+	{
+		value_ -= other.value_;
+		gradient_ -= other.gradient_;
+		if (!other.linear_)
+		{
+			if (linear_)
+			{
+				hessian_ = -other.hessian_;
+				linear_ = false;
+			}
+			else
+			{
+				hessian_ -= other.hessian_;
+			}
+		}
+
+		return *this;
+	}
+
+	HyperDual& operator*=(const HyperDual& other)
+	{
+		*this = *this * other;
+		return *this;
+	}
+
+	HyperDual& operator/=(const HyperDual& other)
+	{
+		*this = *this / other;
+		return *this;
+	}
+
+	HyperDual& operator+=(const double other)
+	{
+		value_ += other;
+		return *this;
+	}
+
+	HyperDual& operator-=(const double other)
+	{
+		value_ -= other;
+		return *this;
+	}
+
+	HyperDual& operator*=(const double other)
+	{
+		value_ *= other;
+		gradient_ *= other;
+		if (!linear_)
+		{
+			hessian_ *= other;
+		}
+
+		return *this;
+	}
+
+	HyperDual& operator/=(const double other)
+	{
+		return *this *= (1 / other);
+	}
+
+	friend HyperDual operator+(const HyperDual& a, const HyperDual& b)
+	{
+		return Sum(a, b, 1);
+	}
+
+	friend HyperDual operator-(const HyperDual& a, const HyperDual& b)
+	{
+		return Sum(a, b, -1);
+	}
+
+	friend HyperDual operator*(const HyperDual& a, const HyperDual& b)
+	{
+		return Chain(a, b, a.value_ * b.value_, b.value_, a.value_, 0, 1, 0);
+	}
+
+	friend HyperDual operator/(const HyperDual& a, const HyperDual& b)
+	{
+		const double inverse = 1 / b.value_;
+		const double quotient = a.value_ * inverse;
+		return Chain(a, b, quotient, inverse, -quotient * inverse, 0, -inverse * inverse, 2 * quotient * inverse * inverse);
+	}
+
+	friend HyperDual operator+(const HyperDual& a, const double b)
+	{
+		HyperDual result(a);
+		result.value_ += b;
+		return result;
+	}
+
+	friend HyperDual operator+(const double a, const HyperDual& b)
+	{
+		return b + a;
+	}
+
+	friend HyperDual operator-(const HyperDual& a, const double b)
+	{
+		return a + (-b);
+	}
+
+	friend HyperDual operator-(const double a, const HyperDual& b)
+	{
+		return Scale(b, -1, a);
+	}
+
+	friend HyperDual operator*(const HyperDual& a, const double b)
+	{
+		return Scale(a, b, 0);
+	}
+
+	friend HyperDual operator*(const double a, const HyperDual& b)
+	{
+		return Scale(b, a, 0);
+	}
+
+	friend HyperDual operator/(const HyperDual& a, const double b)
+	{
+		return Scale(a, 1 / b, 0);
+	}
+
+	friend HyperDual operator/(const double a, const HyperDual& b)
+	{
+		const double inverse = 1 / b.value_;
+		return Chain(b, a * inverse, -a * inverse * inverse, 2 * a * inverse * inverse * inverse);
+	}
+
+	friend bool operator<(const HyperDual& a, const HyperDual& b)
+	{
+		return a.value_ < b.value_;
+	}
+
+	friend bool operator>(const HyperDual& a, const HyperDual& b)
+	{
+		return a.value_ > b.value_;
+	}
+
+	/**
+	 * Functions (found by argument dependent lookup, so expressions may call them unqualified for both double and HyperDual)
+	 */
+	friend HyperDual sqrt(const HyperDual& a)
+	{
+		const double f = std::sqrt(a.value_);
+		const double df = 0.5 / f;
+		return Chain(a, f, df, -0.5 * df / a.value_);
+	}
+
+	// The derivatives are evaluated directly (not through a^(exponent - 2), which is not finite at a = 0 for exponents below 2). At a = 0,
+	// (exponent - 1) * df / a is 0 / 0, and the second derivative is exponent * (exponent - 1) * 0^(exponent - 2) (zero for the exponents 0 and 1)
+	friend HyperDual pow(const HyperDual& a, const double exponent)
+	{
+		const double f = std::pow(a.value_, exponent);
+		const double df = exponent == 0 ? 0 : exponent * std::pow(a.value_, exponent - 1);
+		double ddf = 0;
+		if (a.value_ != 0)
+		{
+			ddf = (exponent - 1) * df / a.value_;
+		}
+		else if (exponent != 0 && exponent != 1)
+		{
+			ddf = exponent * (exponent - 1) * std::pow(a.value_, exponent - 2);
+		}
+
+		return Chain(a, f, df, ddf);
+	}
+
+	friend HyperDual exp(const HyperDual& a)
+	{
+		const double f = std::exp(a.value_);
+		return Chain(a, f, f, f);
+	}
+
+	friend HyperDual log(const HyperDual& a)
+	{
+		const double df = 1 / a.value_;
+		return Chain(a, std::log(a.value_), df, -df * df);
+	}
+
+	friend HyperDual sin(const HyperDual& a)
+	{
+		const double f = std::sin(a.value_);
+		return Chain(a, f, std::cos(a.value_), -f);
+	}
+
+	friend HyperDual cos(const HyperDual& a)
+	{
+		const double f = std::cos(a.value_);
+		return Chain(a, f, -std::sin(a.value_), -f);
+	}
+
+	friend HyperDual abs(const HyperDual& a)
+	{
+		return a.value_ < 0 ? -a : a;
+	}
+
+	friend HyperDual atan2(const HyperDual& y, const HyperDual& x)
+	{
+		const double squared_norm = (x.value_ * x.value_) + (y.value_ * y.value_);
+		const double inverse = 1 / squared_norm;
+		const double inverse_squared = inverse * inverse;
+		return Chain(
+			y,
+			x,
+			std::atan2(y.value_, x.value_),
+			x.value_ * inverse,
+			-y.value_ * inverse,
+			-2 * x.value_ * y.value_ * inverse_squared,
+			((y.value_ * y.value_) - (x.value_ * x.value_)) * inverse_squared,
+			2 * x.value_ * y.value_ * inverse_squared);
+	}
+
+private:
+	/**
+	 * Private constructors
+	 */
+
+	// The hessian is left to the caller
+	template<typename GradientExpression_>
+	HyperDual(const double value, const GradientExpression_& gradient) :
+		value_(value),
+		gradient_(gradient),
+		linear_(false)
+	{
+
+	}
+
+	/**
+	 * Private methods
+	 */
+
+	// Packed upper triangle of u * v^T (and of u * v^T + w * z^T); the columns are unrolled, so each one is a fixed-size (vectorized) segment
+	template<int... Columns_>
+	static void SetOuterProduct(PackedHessianType& hessian, const GradientType& u, const GradientType& v, std::integer_sequence<int, Columns_...>)
+	{
+		((hessian.template segment<Columns_ + 1>((Columns_ * (Columns_ + 1)) / 2) = u.coeff(Columns_) * v.template head<Columns_ + 1>()), ...);
+	}
+
+	template<int... Columns_>
+	static void SetOuterProducts(PackedHessianType& hessian, const GradientType& u, const GradientType& v, const GradientType& w, const GradientType& z, std::integer_sequence<int, Columns_...>)
+	{
+		((hessian.template segment<Columns_ + 1>((Columns_ * (Columns_ + 1)) / 2) = (u.coeff(Columns_) * v.template head<Columns_ + 1>()) + (w.coeff(Columns_) * z.template head<Columns_ + 1>())), ...);
+	}
+
+	// a + sign * b
+	static HyperDual Sum(const HyperDual& a, const HyperDual& b, const double sign)
+	{
+		HyperDual result(a.value_ + (sign * b.value_), a.gradient_ + (sign * b.gradient_));
+		if (a.linear_ && b.linear_)
+		{
+			result.linear_ = true;
+		}
+		else if (a.linear_)
+		{
+			result.hessian_ = sign * b.hessian_;
+		}
+		else if (b.linear_)
+		{
+			result.hessian_ = a.hessian_;
+		}
+		else
+		{
+			result.hessian_ = a.hessian_ + (sign * b.hessian_);
+		}
+
+		return result;
+	}
+
+	// scale * a + offset
+	static HyperDual Scale(const HyperDual& a, const double scale, const double offset)
+	{
+		HyperDual result((scale * a.value_) + offset, scale * a.gradient_);
+		if (a.linear_)
+		{
+			result.linear_ = true;
+		}
+		else
+		{
+			result.hessian_ = scale * a.hessian_;
+		}
+
+		return result;
+	}
+
+	/**
+	 * Private fields
+	 */
+	double value_;
+	GradientType gradient_;
+
+	// Packed upper triangle of the hessian (unused while linear_ is set)
+	PackedHessianType hessian_;
+	bool linear_;
+};
+
+#endif
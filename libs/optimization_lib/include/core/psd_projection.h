@@ -0,0 +1,255 @@
+#pragma once
+#ifndef OPTIMIZATION_LIB_PSD_PROJECTION_H
+#define OPTIMIZATION_LIB_PSD_PROJECTION_H
+
+// STL includes
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+// Eigen includes
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <Eigen/Eigenvalues>
+
+// TBB includes
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
+// Projection of symmetric N x N local hessians onto the PSD cone (negative eigenvalues are replaced by min_eigenvalue).
+// A local hessian is stored as N * (N + 1) / 2 consecutive triplets holding its upper triangle, column by column (the layout created by ConcreteObjective).
+template<int N>
+class PsdProjection
+{
+public:
+	static constexpr int TripletsCount = (N * (N + 1)) / 2;
+
+	// Number of hessians that are diagonalized together (one per SIMD lane)
+	static constexpr int LanesCount = 8;
+
+	// Fixed-size (allocation free) projection of a single hessian
+	static void Project(Eigen::Matrix<double, N, N>& H, const double min_eigenvalue = 10e-8)
+	{
+		Eigen::SelfAdjointEigenSolver<Eigen::Matrix<double, N, N>> solver(H);
+		Eigen::Matrix<double, N, 1> D = solver.eigenvalues();
+		if (D.minCoeff() >= 0)
+		{
+			return;
+		}
+
+		for (int i = 0; i < N; i++)
+		{
+			if (D.coeff(i) < 0)
+			{
+				D.coeffRef(i) = min_eigenvalue;
+			}
+		}
+
+		H = solver.eigenvectors() * D.asDiagonal() * solver.eigenvectors().transpose();
+	}
+
+	// Projects the hessians stored at triplets[offsets[i], offsets[i] + TripletsCount), in place.
+	// The hessians are gathered LanesCount at a time into structure-of-arrays blocks, which are diagonalized by cyclic jacobi sweeps that vectorize across the lanes;
+	// the blocks are processed in parallel.
+	static void Project(std::vector<Eigen::Triplet<double>>& triplets, const std::vector<std::size_t>& offsets, const double min_eigenvalue = 10e-8)
+	{
+		ProjectBlocks(triplets, offsets, nullptr, min_eigenvalue);
+	}
+
+	// Same as above, where the i-th projected hessian is then multiplied by scales[i] (e.g. the weight of the objective it belongs to, of any sign)
+	static void Project(std::vector<Eigen::Triplet<double>>& triplets, const std::vector<std::size_t>& offsets, const std::vector<double>& scales, const double min_eigenvalue = 10e-8)
+	{
+		ProjectBlocks(triplets, offsets, scales.data(), min_eigenvalue);
+	}
+
+private:
+	static constexpr int MaxSweepsCount = 16;
+
+	static void ProjectBlocks(std::vector<Eigen::Triplet<double>>& triplets, const std::vector<std::size_t>& offsets, const double* scales, const double min_eigenvalue)
+	{
+		const std::size_t blocks_count = (offsets.size() + LanesCount - 1) / LanesCount;
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, blocks_count), [&](const tbb::blocked_range<std::size_t>& range) {
+			for (std::size_t block_index = range.begin(); block_index != range.end(); block_index++)
+			{
+				const std::size_t first = block_index * LanesCount;
+				ProjectBlock(triplets, offsets, scales, first, static_cast<int>(std::min<std::size_t>(LanesCount, offsets.size() - first)), min_eigenvalue);
+			}
+		});
+	}
+
+	static void ProjectBlock(std::vector<Eigen::Triplet<double>>& triplets, const std::vector<std::size_t>& offsets, const double* scales, const std::size_t first, const int lanes_count, const double min_eigenvalue)
+	{
+		alignas(64) double a[N][N][LanesCount];
+		alignas(64) double v[N][N][LanesCount];
+		alignas(64) double c[LanesCount];
+		alignas(64) double s[LanesCount];
+
+		/**
+		 * Gather (unused lanes hold the identity)
+		 */
+		for (int lane = 0; lane < LanesCount; lane++)
+		{
+			if (lane < lanes_count)
+			{
+				auto triplet_index = offsets[first + lane];
+				for (int column = 0; column < N; column++)
+				{
+					for (int row = 0; row <= column; row++)
+					{
+						const double value = triplets[triplet_index++].value();
+						a[row][column][lane] = value;
+						a[column][row][lane] = value;
+					}
+				}
+			}
+			else
+			{
+				for (int row = 0; row < N; row++)
+				{
+					for (int column = 0; column < N; column++)
+					{
+						a[row][column][lane] = row == column ? 1 : 0;
+					}
+				}
+			}
+
+			for (int row = 0; row < N; row++)
+			{
+				for (int column = 0; column < N; column++)
+				{
+					v[row][column][lane] = row == column ? 1 : 0;
+				}
+			}
+		}
+
+		/**
+		 * Cyclic jacobi sweeps (A <- P^T * A * P, V <- V * P)
+		 */
+		for (int sweep = 0; sweep < MaxSweepsCount; sweep++)
+		{
+			double off_diagonal = 0;
+			double diagonal = 0;
+			for (int row = 0; row < N; row++)
+			{
+				for (int column = 0; column < N; column++)
+				{
+					double sum = 0;
+					#pragma omp simd reduction(+:sum)
+					for (int lane = 0; lane < LanesCount; lane++)
+					{
+						sum += a[row][column][lane] * a[row][column][lane];
+					}
+
+					if (row == column)
+					{
+						diagonal += sum;
+					}
+					else
+					{
+						off_diagonal += sum;
+					}
+				}
+			}
+
+			if (off_diagonal <= 1e-30 * diagonal)
+			{
+				break;
+			}
+
+			for (int p = 0; p < N - 1; p++)
+			{
+				for (int q = p + 1; q < N; q++)
+				{
+					#pragma omp simd
+					for (int lane = 0; lane < LanesCount; lane++)
+					{
+						const double apq = a[p][q][lane];
+						const bool rotate = std::abs(apq) > 1e-300;
+						const double theta = rotate ? (a[q][q][lane] - a[p][p][lane]) / (2 * apq) : 0;
+						const double t = rotate ? std::copysign(1.0, theta) / (std::abs(theta) + std::sqrt(theta * theta + 1)) : 0;
+						c[lane] = 1 / std::sqrt(t * t + 1);
+						s[lane] = t * c[lane];
+					}
+
+					for (int k = 0; k < N; k++)
+					{
+						#pragma omp simd
+						for (int lane = 0; lane < LanesCount; lane++)
+						{
+							const double akp = a[k][p][lane];
+							const double akq = a[k][q][lane];
+							a[k][p][lane] = c[lane] * akp - s[lane] * akq;
+							a[k][q][lane] = s[lane] * akp + c[lane] * akq;
+
+							const double vkp = v[k][p][lane];
+							const double vkq = v[k][q][lane];
+							v[k][p][lane] = c[lane] * vkp - s[lane] * vkq;
+							v[k][q][lane] = s[lane] * vkp + c[lane] * vkq;
+						}
+					}
+
+					for (int k = 0; k < N; k++)
+					{
+						#pragma omp simd
+						for (int lane = 0; lane < LanesCount; lane++)
+						{
+							const double apk = a[p][k][lane];
+							const double aqk = a[q][k][lane];
+							a[p][k][lane] = c[lane] * apk - s[lane] * aqk;
+							a[q][k][lane] = s[lane] * apk + c[lane] * aqk;
+						}
+					}
+				}
+			}
+		}
+
+		/**
+		 * Clamp the eigenvalues and scatter back (H = scale * V * D * V^T); hessians that are already PSD are only scaled
+		 */
+		for (int lane = 0; lane < lanes_count; lane++)
+		{
+			const double scale = scales != nullptr ? scales[first + lane] : 1;
+			double d[N];
+			bool projected = false;
+			for (int i = 0; i < N; i++)
+			{
+				d[i] = a[i][i][lane];
+				if (d[i] < 0)
+				{
+					d[i] = min_eigenvalue;
+					projected = true;
+				}
+			}
+
+			auto triplet_index = offsets[first + lane];
+			if (!projected)
+			{
+				if (scale != 1)
+				{
+					for (int i = 0; i < TripletsCount; i++, triplet_index++)
+					{
+						const_cast<double&>(triplets[triplet_index].value()) *= scale;
+					}
+				}
+
+				continue;
+			}
+
+			for (int column = 0; column < N; column++)
+			{
+				for (int row = 0; row <= column; row++)
+				{
+					double value = 0;
+					for (int k = 0; k < N; k++)
+					{
+						value += v[row][k][lane] * d[k] * v[column][k][lane];
+					}
+
+					const_cast<double&>(triplets[triplet_index++].value()) = scale * value;
+				}
+			}
+		}
+	}
+};
+
+#endif
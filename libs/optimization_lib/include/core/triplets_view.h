@@ -0,0 +1,67 @@
+#pragma once
+#ifndef OPTIMIZATION_LIB_TRIPLETS_VIEW_H
+#define OPTIMIZATION_LIB_TRIPLETS_VIEW_H
+
+// STL includes
+#include <vector>
+#include <cstddef>
+
+// Eigen includes
+#include <Eigen/Sparse>
+
+// Writable view of the range [offset, offset + size) of a triplets vector: either all the triplets of an objective, or the range of an objective
+// in the triplets of its parent. The vector is held by address (and not by the address of its data), so the view follows its reallocations.
+class TripletsView
+{
+public:
+	/**
+	 * Constructors and destructor
+	 */
+	TripletsView(std::vector<Eigen::Triplet<double>>& triplets) :
+		TripletsView(triplets, 0, triplets.size())
+	{
+
+	}
+
+	TripletsView(std::vector<Eigen::Triplet<double>>& triplets, const std::size_t offset, const std::size_t size) :
+		triplets_(&triplets),
+		offset_(offset),
+		size_(size)
+	{
+
+	}
+
+	/**
+	 * Public getters
+	 */
+	std::size_t size() const
+	{
+		return size_;
+	}
+
+	Eigen::Triplet<double>& operator[](const std::size_t index) const
+	{
+		return (*triplets_)[offset_ + index];
+	}
+
+	/**
+	 * Public methods
+	 */
+	void Scale(const double w) const
+	{
+		for (std::size_t i = 0; i < size_; i++)
+		{
+			const_cast<double&>((*this)[i].value()) *= w;
+		}
+	}
+
+private:
+	/**
+	 * Private fields
+	 */
+	std::vector<Eigen::Triplet<double>>* triplets_;
+	std::size_t offset_;
+	std::size_t size_;
+};
+
+#endif
@@ -2,8 +2,15 @@
 #ifndef OPTIMIZATION_LIB_UPDATABLE_OBJECT_H
 #define OPTIMIZATION_LIB_UPDATABLE_OBJECT_H
 
+// STL includes
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
 // TBB includes
 #include <tbb/concurrent_vector.h>
+#include <tbb/flow_graph.h>
 
 // Eigen Includes
 #include <Eigen/Core>
@@ -11,15 +18,23 @@
 // Optimization lib includes
 #include "../data_providers/mesh_data_provider.h"
 
-//#include <unordered_set>
-
 class UpdatableObject
 {
 public:
+	/**
+	 * Public type definitions
+	 */
+
+	// Original object -> its clone
+	using CloneMap = std::unordered_map<const UpdatableObject*, std::shared_ptr<UpdatableObject>>;
+
 	/**
 	 * Constructors and destructor
 	 */
 	UpdatableObject(const std::shared_ptr<MeshDataProvider>& mesh_data_provider);
+
+	// Copies the definition of the object (the dependency graph of the copy is built by Clone)
+	UpdatableObject(const UpdatableObject& other);
 	virtual ~UpdatableObject();
 
 	/**
@@ -27,15 +42,76 @@ public:
 	 */
 	[[nodiscard]] std::shared_ptr<MeshDataProvider> GetMeshDataProvider() const;
 	const tbb::concurrent_vector<std::shared_ptr<UpdatableObject>>& GetDependencies() const;
-	
+
+	// Latest state version of this object and of its (direct and indirect) dependencies. State versions are drawn from a single counter shared by
+	// all objects, so this changes with every Invalidate() or Initialize() anywhere in the tree, and never returns to a value it had before.
+	// Reads the dependency graph, so it must not run concurrently with Initialize() (of this object).
+	[[nodiscard]] uint64_t GetStateVersion() const;
+
+	// Rough estimate of the work done by a single update; used to chunk the dependency graph
+	virtual int64_t GetUpdateCost() const;
+
+	// The variables that Update reads directly from x (variables that are reached through dependencies are not included).
+	// Returns false when unknown; such an object is considered changed on every update.
+	virtual bool GetVariablesFootprint(std::vector<RDS::SparseVariableIndex>& variables_footprint) const;
+
+	/**
+	 * Public setters
+	 */
+
+	// When enabled, each update of the dependencies is compared against the previous x, and only dependencies whose
+	// footprint (or one of whose own dependencies) changed are updated; the others keep their cached results.
+	// Changes that are not reflected in x must be reported by Invalidate() (weights and PSD settings do so already), or followed by InvalidateDependencies().
+	void SetDirtyTracking(const bool dirty_tracking);
+
 	/**
 	 * Public methods
 	 */
 	virtual void Initialize();
 	virtual void Update(const Eigen::VectorXd& x) = 0;
 	virtual void Update(const Eigen::VectorXd& x, const int32_t update_modifiers) = 0;
-	
+
+	// Marks this object as changed in a way that is not reflected in x, so the next dirty tracking update re-evaluates it (and whatever depends on it)
+	void Invalidate();
+
+	// Drops the cached results of the dependencies, so the next update re-evaluates all of them
+	void InvalidateDependencies();
+
+	// Deep copy of this object and its (direct and indirect) dependencies; the copies share nothing mutable with the originals
+	// (only the mesh data provider and stateless objects such as EmptyDataProvider), so both may be updated concurrently.
+	// An object that is shared by several dependents is cloned once.
+	std::shared_ptr<UpdatableObject> Clone(CloneMap& clones) const;
+
+	// The clone of updatable_object, or updatable_object itself if it was not cloned
+	template<typename UpdatableObjectType_>
+	static std::shared_ptr<UpdatableObjectType_> Remap(const std::shared_ptr<UpdatableObjectType_>& updatable_object, const CloneMap& clones)
+	{
+		const auto it = clones.find(updatable_object.get());
+		if (it == clones.end())
+		{
+			return updatable_object;
+		}
+
+		return std::static_pointer_cast<UpdatableObjectType_>(it->second);
+	}
+
 protected:
+	/**
+	 * Protected methods
+	 */
+
+	// Updates all (direct and indirect) dependencies; each chunk of the dependency graph runs as soon as the chunks it depends on are done
+	void UpdateDependencies(const Eigen::VectorXd& x, const int32_t update_modifiers);
+
+	// Same as above, where the caller guarantees that only changed_variables differ from the previous update
+	void UpdateDependencies(const Eigen::VectorXd& x, const int32_t update_modifiers, const std::vector<RDS::SparseVariableIndex>& changed_variables);
+
+	// Copy of this object (usually std::make_shared<T>(*this)); must be overridden by every class that supports cloning
+	virtual std::shared_ptr<UpdatableObject> CloneObject() const;
+
+	// Points the copied references to other objects at their clones; derived classes that keep such references (beyond dependencies_) extend it
+	virtual void RemapDependencies(const CloneMap& clones);
+
 	/**
 	 * Protected Fields
 	 */
@@ -43,14 +119,60 @@ protected:
 	// Mesh data provider
 	std::shared_ptr<MeshDataProvider> mesh_data_provider_;
 	tbb::concurrent_vector<std::shared_ptr<UpdatableObject>> dependencies_;
-	std::vector<std::vector<std::shared_ptr<UpdatableObject>>> dependency_layers_;
 
 private:
+	/**
+	 * Private type definitions
+	 */
+	using UpdateNode = tbb::flow::continue_node<tbb::flow::continue_msg>;
+
+	// Objects of the same topological level are packed into chunks of (at least) this estimated cost
+	static constexpr int64_t UpdateChunkCost = 256;
+
 	/**
 	 * Private methods
 	 */
-	void InitializeDependencyLayers(std::vector<std::vector<std::shared_ptr<UpdatableObject>>>& dependency_layers);
-	int BuildDependencyLayers(const std::shared_ptr<UpdatableObject>& updatable_object, std::vector<std::vector<std::shared_ptr<UpdatableObject>>>& dependency_layers) const;
+	void InitializeDependencyGraph();
+	std::size_t BuildDependencyGraph(const std::shared_ptr<UpdatableObject>& updatable_object, std::unordered_map<UpdatableObject*, std::size_t>& node_indices);
+	void InitializeVariablesFootprints();
+	void MarkChangedNodes(const int32_t update_modifiers, const std::vector<RDS::SparseVariableIndex>& changed_variables);
+	void RunUpdateGraph(const Eigen::VectorXd& x, const int32_t update_modifiers);
+	void UpdateChunk(const std::size_t chunk_index);
+
+	/**
+	 * Private fields
+	 */
+
+	// Direct and indirect dependencies, in topological order
+	std::vector<std::shared_ptr<UpdatableObject>> nodes_;
+	std::vector<std::vector<std::size_t>> node_dependencies_;
+
+	// Chunks of the dependency graph (node indices; each chunk is updated serially, by a single graph node)
+	std::vector<std::vector<std::size_t>> update_chunks_;
+	std::vector<std::size_t> source_update_chunks_;
+
+	// Task graph (one node per chunk)
+	std::unique_ptr<tbb::flow::graph> update_graph_;
+	std::vector<std::unique_ptr<UpdateNode>> update_nodes_;
+
+	// Arguments of the running update
+	const Eigen::VectorXd* update_x_;
+	int32_t update_modifiers_;
+
+	// Drawn from last_state_version_ by Invalidate(); atomic, since other threads read it (see GetStateVersion) while this object is invalidated
+	std::atomic<uint64_t> state_version_;
+	static std::atomic<uint64_t> last_state_version_;
+
+	// Dirty tracking (variable -> nodes whose footprint contains it, in CSR layout)
+	bool dirty_tracking_;
+	Eigen::VectorXd previous_x_;
+	std::vector<std::size_t> variable_node_offsets_;
+	std::vector<std::size_t> variable_nodes_;
+	std::vector<bool> node_footprint_known_;
+	std::vector<int32_t> node_update_modifiers_;
+	std::vector<uint64_t> node_state_versions_;
+	std::vector<char> node_changed_;
+	std::vector<RDS::SparseVariableIndex> changed_variables_;
 };
 
 #endif
\ No newline at end of file
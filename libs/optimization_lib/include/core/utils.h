@@ -2,6 +2,9 @@
 #ifndef OPTIMIZATION_LIB_UTILS_H
 #define OPTIMIZATION_LIB_UTILS_H
 
+// STL includes
+#include <cmath>
+
 // Boost includes
 #include <boost/functional/hash.hpp>
 
@@ -48,6 +51,66 @@ public:
 		V(3) = c;
 	}
 
+	// Batched SSVD2x2 of the matrices [a(i) b(i); c(i) d(i)]; row i of S holds the singular values, and rows i of U and V hold the (column major) singular vectors.
+	// Instead of evaluating atan2, sin and cos, the halves of both angles are derived from their half angle identities (sqrt only), and then combined,
+	// so the loop vectorizes. Matches SSVD2x2 to a few ulps.
+	static inline void SSVD2x2(
+		const Eigen::Ref<const Eigen::VectorXd>& a,
+		const Eigen::Ref<const Eigen::VectorXd>& b,
+		const Eigen::Ref<const Eigen::VectorXd>& c,
+		const Eigen::Ref<const Eigen::VectorXd>& d,
+		Eigen::Ref<Eigen::MatrixX2d> S,
+		Eigen::Ref<Eigen::MatrixX4d> U,
+		Eigen::Ref<Eigen::MatrixX4d> V)
+	{
+		const auto count = a.size();
+		#pragma omp simd
+		for (Eigen::Index i = 0; i < count; i++)
+		{
+			const double e = (a(i) + d(i)) * 0.5;
+			const double f = (a(i) - d(i)) * 0.5;
+			const double g = (c(i) + b(i)) * 0.5;
+			const double h = (c(i) - b(i)) * 0.5;
+			const double q = sqrt((e * e) + (h * h));
+			const double r = sqrt((f * f) + (g * g));
+
+			// a1 = atan2(g, f), a2 = atan2(h, e)
+			double c1, s1, c2, s2;
+			HalfAngle(f, g, r, c1, s1);
+			HalfAngle(e, h, q, c2, s2);
+
+			S(i, 0) = q + r;
+			S(i, 1) = q - r;
+
+			// phi = (a2 + a1) / 2
+			const double c_phi = (c2 * c1) - (s2 * s1);
+			const double s_phi = (s2 * c1) + (c2 * s1);
+			U(i, 0) = c_phi;
+			U(i, 1) = s_phi;
+			U(i, 2) = -s_phi;
+			U(i, 3) = c_phi;
+
+			// rho = (a2 - a1) / 2
+			const double c_rho = (c2 * c1) + (s2 * s1);
+			const double s_rho = (s2 * c1) - (c2 * s1);
+			V(i, 0) = c_rho;
+			V(i, 1) = -s_rho;
+			V(i, 2) = s_rho;
+			V(i, 3) = c_rho;
+		}
+	}
+
+	// Cosine and sine of atan2(y, x) / 2, where radius = sqrt(x^2 + y^2); cos = sqrt((radius + x) / (2 * radius)) and sin = sqrt((radius - x) / (2 * radius)),
+	// where the smaller of (radius + |x|) and (radius - |x|) is taken as y^2 / (radius + |x|) to avoid cancellation
+	static inline void HalfAngle(const double x, const double y, const double radius, double& half_cos, double& half_sin)
+	{
+		const double large = radius + std::abs(x);
+		const double small = large > 0 ? (y * y) / large : 0;
+		const double scale = radius > 0 ? 1 / (2 * radius) : 0;
+		half_cos = radius > 0 ? sqrt((x >= 0 ? large : small) * scale) : 1;
+		half_sin = std::copysign(sqrt((x >= 0 ? small : large) * scale), y);
+	}
+
 	/**
 	 * Remove row & column from eigen matrix
 	 */
@@ -25,9 +25,16 @@ public:
 	 */
 	void Update(const Eigen::VectorXd& x) override;
 	void Update(const Eigen::VectorXd& x, const int32_t update_modifiers) override;
+	bool GetVariablesFootprint(std::vector<RDS::SparseVariableIndex>& variables_footprint) const override;
 	double GetCoordinateValue() const;
 	RDS::SparseVariableIndex GetSparseVariableIndex() const;
 	
+protected:
+	/**
+	 * Protected overrides
+	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override;
+
 private:
 	/**
 	 * Private fields
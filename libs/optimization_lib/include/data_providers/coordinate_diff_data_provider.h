@@ -25,10 +25,17 @@ public:
 	 */
 	void Update(const Eigen::VectorXd& x) override;
 	void Update(const Eigen::VectorXd& x, const int32_t update_modifiers) override;
+	bool GetVariablesFootprint(std::vector<RDS::SparseVariableIndex>& variables_footprint) const override;
 	double GetCoordinateDiffValue() const;
 	RDS::SparseVariableIndex GetSparseVariable1Index() const;
 	RDS::SparseVariableIndex GetSparseVariable2Index() const;
 
+protected:
+	/**
+	 * Protected overrides
+	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override;
+
 private:
 	/**
 	 * Private fields
@@ -31,6 +31,7 @@ public:
 	 */
 	void Update(const Eigen::VectorXd& x) override;
 	void Update(const Eigen::VectorXd& x, const int32_t update_modifiers) override;
+	bool GetVariablesFootprint(std::vector<RDS::SparseVariableIndex>& variables_footprint) const override;
 	double GetCoordinate1DiffValue() const;
 	double GetCoordinate2DiffValue() const;
 	double GetCrossCoordinateDiffValue() const;
@@ -40,6 +41,12 @@ public:
 	RDS::SparseVariableIndex GetEdge2Variable1Index() const;
 	RDS::SparseVariableIndex GetEdge2Variable2Index() const;
 	
+protected:
+	/**
+	 * Protected overrides
+	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override;
+
 private:
 	/**
 	 * Private fields
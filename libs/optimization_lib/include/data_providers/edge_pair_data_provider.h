@@ -26,10 +26,16 @@ public:
 	 */
 	void Update(const Eigen::VectorXd& x) override;
 	void Update(const Eigen::VectorXd& x, int32_t update_modifiers) override;
+	bool GetVariablesFootprint(std::vector<RDS::SparseVariableIndex>& variables_footprint) const override;
 
 	/**
 	 * Getters
 	 */
+	const RDS::EdgePairDescriptor& EdgePairDataProvider::GetEdgePairDescriptor() const
+	{
+		return edge_pair_descriptor_;
+	}
+
 	const Eigen::Vector2d& EdgePairDataProvider::GetEdge1() const
 	{
 		return edge1_;
@@ -195,6 +201,12 @@ public:
 		return vertex2_y_diff_;
 	}
 	
+protected:
+	/**
+	 * Protected overrides
+	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override;
+
 private:
 	RDS::EdgePairDescriptor edge_pair_descriptor_;
 	RDS::EdgeIndex image_edge_1_index_;
@@ -25,6 +25,13 @@ public:
 	 */
 	void Update(const Eigen::VectorXd& x) override;
 	void Update(const Eigen::VectorXd& x, int32_t update_modifiers) override;
+	bool GetVariablesFootprint(std::vector<RDS::SparseVariableIndex>& variables_footprint) const override;
+
+protected:
+	/**
+	 * Protected overrides
+	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override;
 };
 
 #endif
\ No newline at end of file
@@ -26,6 +26,7 @@ public:
 	 */
 	void Update(const Eigen::VectorXd& x) override;
 	void Update(const Eigen::VectorXd& x, int32_t update_modifiers) override;
+	bool GetVariablesFootprint(std::vector<RDS::SparseVariableIndex>& variables_footprint) const override;
 
 	/**
 	 * Getters
@@ -33,6 +34,12 @@ public:
 	const RDS::Face& GetFace() const;
 	const Eigen::VectorXd& GetBarycenter() const;
 
+protected:
+	/**
+	 * Protected overrides
+	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override;
+
 private:
 	RDS::Face face_;
 	Eigen::VectorXd barycenter_;
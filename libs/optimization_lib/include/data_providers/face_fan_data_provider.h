@@ -26,6 +26,7 @@ public:
 	 */
 	void Update(const Eigen::VectorXd& x) override;
 	void Update(const Eigen::VectorXd& x, int32_t update_modifiers) override;
+	bool GetVariablesFootprint(std::vector<RDS::SparseVariableIndex>& variables_footprint) const override;
 
 	/**
 	 * Getters
@@ -34,6 +35,12 @@ public:
 	const RDS::FaceFan& GetFaceFan() const;
 	RDS::VertexIndex GetDomainVertexIndex() const;
 
+protected:
+	/**
+	 * Protected overrides
+	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override;
+
 private:
 	RDS::FaceFan face_fan_;
 	double angle_;
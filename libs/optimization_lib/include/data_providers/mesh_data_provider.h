@@ -2,12 +2,16 @@
 #ifndef OPTIMIZATION_LIB_MESH_DATA_PROVIDER_H
 #define OPTIMIZATION_LIB_MESH_DATA_PROVIDER_H
 
+// STL includes
+#include <memory>
+
 // Eigen Includes
 #include <Eigen/Core>
 #include <Eigen/Sparse>
 
 // Optimization lib includes
 #include "../core/core.h"
+#include "../solvers/mass_matrix_operator.h"
 
 class MeshDataProvider
 {
@@ -34,10 +38,12 @@ public:
 	virtual RDS::EdgeIndices GetImageAdjacentEdgeIndicesByVertex(RDS::VertexIndex vertex_index) const = 0;
 	virtual const Eigen::SparseMatrix<double>& GetLaplacian() const = 0;
 	virtual const Eigen::SparseMatrix<double>& GetMassMatrix() const = 0;
+	virtual std::shared_ptr<MassMatrixOperator> GetMassMatrixOperator() const = 0;
 	virtual double GetArea() const = 0;
 	virtual Eigen::VectorXd GetRandomVerticesGaussian(int64_t vertex_index) = 0;
 	
 	// Relevant for objective functions that operate on triangle soups
+	virtual const std::vector<std::pair<int64_t, int64_t>>& GetCorrespondingVertexPairs() const = 0;
 	virtual const Eigen::SparseMatrix<double>& GetCorrespondingVertexPairsCoefficients() const = 0;
 	virtual const Eigen::VectorXd& GetCorrespondingVertexPairsEdgeLength() const = 0;
 };
@@ -11,6 +11,8 @@
 #include <algorithm>
 #include <functional>
 #include <string>
+#include <memory>
+#include <mutex>
 
 // Boost includes
 #include <boost/signals2/signal.hpp>
@@ -23,6 +25,7 @@
 // Optimization lib includes
 #include "../core/core.h"
 #include "./mesh_data_provider.h"
+#include "../solvers/heat_geodesics.h"
 
 class MeshWrapper : public MeshDataProvider
 {
@@ -87,6 +90,7 @@ public:
 	const Eigen::MatrixX2i& GetDomainEdges() const override;
 	const Eigen::MatrixX3d& GetD1() const override;
 	const Eigen::MatrixX3d& GetD2() const override;
+	const std::vector<std::pair<int64_t, int64_t>>& GetCorrespondingVertexPairs() const override;
 	const Eigen::SparseMatrix<double>& GetCorrespondingVertexPairsCoefficients() const override;
 	const Eigen::VectorXd& GetCorrespondingVertexPairsEdgeLength() const override;
 	int64_t GetImageVerticesCount() const override;
@@ -106,8 +110,13 @@ public:
 	RDS::EdgeIndices GetImageAdjacentEdgeIndicesByVertex(RDS::VertexIndex vertex_index) const override;
 	const Eigen::SparseMatrix<double>& GetLaplacian() const override;
 	const Eigen::SparseMatrix<double>& GetMassMatrix() const override;
+	std::shared_ptr<MassMatrixOperator> GetMassMatrixOperator() const override;
 	double GetArea() const override;
 	Eigen::VectorXd GetRandomVerticesGaussian(int64_t vertex_index) override;
+
+	// Approximate geodesic distances on the (normalized) domain, by the heat method
+	Eigen::VectorXd GetGeodesicDistances(RDS::VertexIndex source);
+	Eigen::VectorXd GetGeodesicDistances(const std::vector<RDS::VertexIndex>& sources);
 	
 	/**
 	 * Public methods
@@ -149,6 +158,7 @@ private:
 	 */
 	void ComputeEdges(const Eigen::MatrixX3i& f, Eigen::MatrixX2i& e);
 	void NormalizeVertices(Eigen::MatrixX3d& v);
+	std::shared_ptr<HeatGeodesics> GetHeatGeodesics();
 
 	/**
 	 * Discrete operators
@@ -264,8 +274,15 @@ private:
 	Eigen::SparseMatrix<double> W_;
 	Eigen::SparseMatrix<double> A_;
 
+	// Mass matrix operator (factorized once, shared by every eigensolver that runs on this mesh)
+	std::shared_ptr<MassMatrixOperator> mass_matrix_operator_;
+
 	// Area
 	double area_;
+
+	// Heat method geodesics (prefactorized on first use)
+	std::shared_ptr<HeatGeodesics> heat_geodesics_;
+	std::mutex heat_geodesics_mutex_;
 	
 	// Boost signals
 	boost::signals2::signal<ModelLoadedCallback> model_loaded_signal_;
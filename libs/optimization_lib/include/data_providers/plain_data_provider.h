@@ -28,6 +28,12 @@ public:
 	void Update(const Eigen::VectorXd& x, int32_t update_modifiers) override;
 	const Eigen::VectorXd& GetX() const;
 
+protected:
+	/**
+	 * Protected overrides
+	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override;
+
 private:
 	/**
 	 * Private fields
@@ -0,0 +1,160 @@
+#pragma once
+#ifndef OPTIMIZATION_LIB_BATCH_LOCALIZATION_H
+#define OPTIMIZATION_LIB_BATCH_LOCALIZATION_H
+
+// STL includes
+#include <memory>
+#include <vector>
+#include <string>
+
+// Eigen includes
+#include <Eigen/Core>
+
+// TBB includes
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
+// Optimization lib includes
+#include "../data_providers/mesh_wrapper.h"
+#include "../objective_functions/region_localization_objective.h"
+#include "../solvers/laplacian_eigen_basis.h"
+#include "./multi_start_localization.h"
+
+// Localizes many partial shapes against a single full shape.
+// The full shape (its laplacian, mass matrix operator and optional reduced basis) is loaded once and shared by every localization;
+// the partial spectra are computed in parallel, and the localizations (each one a multi-start run) run concurrently.
+template <Eigen::StorageOptions StorageOrder_>
+class BatchLocalization
+{
+public:
+	/**
+	 * Public type definitions
+	 */
+	struct Result
+	{
+		std::string partial_file_path;
+		bool succeeded;
+		Eigen::VectorXd mu;
+		typename MultiStartLocalization<StorageOrder_>::Result best;
+	};
+
+	/**
+	 * Constructors and destructor
+	 */
+	BatchLocalization(const std::shared_ptr<MeshWrapper>& shape) :
+		shape_(shape),
+		runs_count_(1),
+		rounds_count_(10),
+		round_iterations_(20),
+		initial_step_size_(0.000001),
+		rng_seed_(0)
+	{
+
+	}
+
+	virtual ~BatchLocalization()
+	{
+
+	}
+
+	/**
+	 * Public setters
+	 */
+	void SetRunsCount(const int64_t runs_count)
+	{
+		runs_count_ = runs_count;
+	}
+
+	void SetRoundsCount(const int64_t rounds_count)
+	{
+		rounds_count_ = rounds_count;
+	}
+
+	void SetRoundIterations(const int64_t round_iterations)
+	{
+		round_iterations_ = round_iterations;
+	}
+
+	void SetInitialStepSize(const double initial_step_size)
+	{
+		initial_step_size_ = initial_step_size;
+	}
+
+	void SetRandomSeed(const uint32_t rng_seed)
+	{
+		rng_seed_ = rng_seed;
+	}
+
+	void EnableReducedBasis(const int64_t basis_size = RDS_REDUCED_BASIS_SIZE)
+	{
+		reduced_basis_ = std::make_shared<LaplacianEigenBasis>(shape_->GetLaplacian(), shape_->GetMassMatrixOperator(), basis_size);
+	}
+
+	/**
+	 * Public getters
+	 */
+	const std::vector<Result>& GetResults() const
+	{
+		return results_;
+	}
+
+	/**
+	 * Public methods
+	 */
+
+	// Blocks until every partial was localized; results are in the order of partial_file_paths
+	void Run(const std::vector<std::string>& partial_file_paths)
+	{
+		results_.clear();
+		results_.resize(partial_file_paths.size());
+
+		/**
+		 * Load the partials and compute their spectra
+		 */
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, partial_file_paths.size(), 1), [&](const tbb::blocked_range<std::size_t>& range) {
+			for (std::size_t i = range.begin(); i != range.end(); i++)
+			{
+				results_[i].partial_file_path = partial_file_paths[i];
+				auto partial = std::make_shared<MeshWrapper>(partial_file_paths[i]);
+				results_[i].succeeded = (partial->GetDomainVerticesCount() > 0) && RegionLocalizationObjective<StorageOrder_>::ComputeMu(partial, results_[i].mu);
+			}
+		});
+
+		/**
+		 * Localize every partial in the full shape
+		 */
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, results_.size(), 1), [&](const tbb::blocked_range<std::size_t>& range) {
+			for (std::size_t i = range.begin(); i != range.end(); i++)
+			{
+				if (!results_[i].succeeded)
+				{
+					continue;
+				}
+
+				MultiStartLocalization<StorageOrder_> multi_start_localization(shape_, results_[i].mu, runs_count_);
+				multi_start_localization.SetRoundsCount(rounds_count_);
+				multi_start_localization.SetRoundIterations(round_iterations_);
+				multi_start_localization.SetInitialStepSize(initial_step_size_);
+				multi_start_localization.SetRandomSeed(rng_seed_ + static_cast<uint32_t>(i));
+				multi_start_localization.SetReducedBasis(reduced_basis_);
+				multi_start_localization.Run();
+				results_[i].best = multi_start_localization.GetResults().front();
+			}
+		});
+	}
+
+private:
+	/**
+	 * Private fields
+	 */
+	std::shared_ptr<MeshWrapper> shape_;
+	std::shared_ptr<LaplacianEigenBasis> reduced_basis_;
+	int64_t runs_count_;
+	int64_t rounds_count_;
+	int64_t round_iterations_;
+	double initial_step_size_;
+	uint32_t rng_seed_;
+	std::vector<Result> results_;
+};
+
+#endif
@@ -10,9 +10,6 @@
 #include <Eigen/Core>
 #include <Eigen/Sparse>
 
-// LIBIGL includes
-#include <igl/flip_avoiding_line_search.h>
-
 // Optimization lib includes
 #include "../objective_functions/dense_objective_function.h"
 
@@ -27,15 +24,21 @@ public:
 		p_(Eigen::VectorXd::Zero(x0.size())),
 		thread_state_(ThreadState::Terminated),
 		max_backtracking_iterations_(10),
-		flip_avoiding_line_search_enabled_(false),
 		approximation_invalidated_(false),
 		iteration_(0),
 		line_search_iteration_(0),
 		initial_step_size_(0.000001),
+		armijo_constant_(0.0001),
+		step_size_growth_factor_(2),
+		backtracking_factor_(0.5),
+		step_size_memory_enabled_(true),
+		step_size_memory_valid_(false),
+		normalized_search_direction_(true),
 		value_(0)
 	{
 		step_size_ = initial_step_size_;
 		objective_function_->UpdateLayers(x0);
+		value_ = objective_function_->GetValue();
 	}
 
 	virtual ~IterativeMethod()
@@ -68,16 +71,22 @@ public:
 					}
 					lock.unlock();
 
-					objective_function_->UpdateLayers(x_, DenseObjectiveFunction<StorageOrder_>::UpdateOptions::Gradient | DenseObjectiveFunction<StorageOrder_>::UpdateOptions::Hessian);
-					ComputeDescentDirection(p_);
-					LineSearch(p_);
-					iteration_++;
+					Step();
 				}
 				});
 			break;
 		}
 	}
 
+	// Runs a single iteration on the calling thread (must not be mixed with Start/Resume)
+	void Step()
+	{
+		objective_function_->UpdateLayers(x_, DenseObjectiveFunction<StorageOrder_>::UpdateOptions::Gradient | DenseObjectiveFunction<StorageOrder_>::UpdateOptions::Hessian);
+		ComputeDescentDirection(p_);
+		LineSearch(p_);
+		iteration_++;
+	}
+
 	void Pause()
 	{ 
 		std::lock_guard<std::mutex> lock(thread_state_mutex_);
@@ -115,6 +124,12 @@ public:
 			lock.unlock();
 			thread_.join();
 			break;
+		case ThreadState::Paused:
+			thread_state_ = ThreadState::Terminating;
+			cv_.notify_one();
+			lock.unlock();
+			thread_.join();
+			break;
 		}
 	}
 
@@ -135,17 +150,6 @@ public:
 		return x_;
 	}
 
-	void EnableFlipAvoidingLineSearch(const Eigen::MatrixX3i& F)
-	{
-		F_ = F;
-		flip_avoiding_line_search_enabled_ = true;
-	}
-
-	void DisableFlipAvoidingLineSearch()
-	{
-		flip_avoiding_line_search_enabled_ = false;
-	}
-
 	int64_t GetIteration() const
 	{
 		return iteration_;
@@ -166,9 +170,36 @@ public:
 		return value_;
 	}
 
+	// The length of the first trial step along the normalized search direction (see SetNormalizedSearchDirection)
+	// Also resets the step size memory, so the next line search starts from the given step size
 	void SetInitialStepSize(double initial_step_size)
 	{
 		initial_step_size_ = initial_step_size;
+		step_size_memory_valid_ = false;
+	}
+
+	void SetArmijoConstant(double armijo_constant)
+	{
+		armijo_constant_ = armijo_constant;
+	}
+
+	void SetStepSizeGrowthFactor(double step_size_growth_factor)
+	{
+		step_size_growth_factor_ = step_size_growth_factor;
+	}
+
+	// When disabled, every line search starts from the initial step size (e.g. quasi-newton methods, whose natural step is 1)
+	void SetStepSizeMemoryEnabled(bool step_size_memory_enabled)
+	{
+		step_size_memory_enabled_ = step_size_memory_enabled;
+		step_size_memory_valid_ = false;
+	}
+
+	// When disabled, steps are taken along the search direction as is (e.g. quasi-newton methods, whose search direction is already scaled)
+	void SetNormalizedSearchDirection(bool normalized_search_direction)
+	{
+		normalized_search_direction_ = normalized_search_direction;
+		step_size_memory_valid_ = false;
 	}
 
 private:
@@ -187,42 +218,61 @@ private:
 	 */
 	virtual void ComputeDescentDirection(Eigen::VectorXd& p) = 0;
 
-	void LineSearch(const Eigen::VectorXd& p)
+	// Maps a trial point back onto the feasible set (bound constrained methods); the identity by default
+	virtual void Project(Eigen::VectorXd& x)
 	{
-		/**
-		 * Calculate maximal flip avoiding step-size
-		 * https://github.com/libigl/libigl/blob/master/include/igl/flip_avoiding_line_search.cpp
-		 */
-		step_size_ = initial_step_size_;
 
+	}
+
+	void LineSearch(const Eigen::VectorXd& p)
+	{
 		/**
-		 * Perform backtracking (armijo rule)
+		 * Perform backtracking (armijo rule) along p (normalized by default), starting from the last accepted step size scaled up by the growth factor
 		 * https://en.wikipedia.org/wiki/Backtracking_line_search
 		 */
-		value_ = objective_function_->GetValue();
 		const double current_value = value_;
+		const Eigen::VectorXd& g = objective_function_->GetGradient();
+		const double directional_derivative = g.dot(p);
 		line_search_iteration_ = 0;
-		Eigen::MatrixXd current_x;
-		//while (line_search_iteration_ < max_backtracking_iterations_)
-		//{
-			Eigen::VectorXd normalized_p = p.normalized();
-			current_x = x_ + initial_step_size_ * normalized_p;
-			objective_function_->UpdateLayers(current_x, DenseObjectiveFunction<StorageOrder_>::UpdateOptions::Value);
 
-			value_ = objective_function_->GetValue();
-			//if (value_ >= current_value)
-			//{
-			//	step_size_ /= 10;
-			//}
-			//else
-			//{
-			//	break;
-			//}
+		if (directional_derivative >= 0)
+		{
+			// Not a descent direction; stay put and restart the step size memory
+			step_size_memory_valid_ = false;
+			return;
+		}
 
+		double step_size = (step_size_memory_enabled_ && step_size_memory_valid_) ? step_size_ * step_size_growth_factor_ : initial_step_size_;
+		const double direction_scale = normalized_search_direction_ ? 1 / p.norm() : 1;
+		Eigen::VectorXd current_x;
+		bool accepted = false;
+		while (line_search_iteration_ < max_backtracking_iterations_)
+		{
+			// Trial points only need the value (the gradient at x_ stays intact)
+			current_x = x_ + (step_size * direction_scale) * p;
+			Project(current_x);
+			objective_function_->UpdateLayers(current_x, DenseObjectiveFunction<StorageOrder_>::UpdateOptions::Value);
 			line_search_iteration_++;
-		//}
 
-		//objective_function_->UpdateLayers(current_x, DenseObjectiveFunction<StorageOrder_>::UpdateOptions::ValuePerVertex | DenseObjectiveFunction<StorageOrder_>::UpdateOptions::ValuePerEdge);
+			// For a projected trial point, the expected decrease is measured along the actual step
+			const double trial_value = objective_function_->GetValue();
+			const double expected_decrease = g.dot(current_x - x_);
+			if (expected_decrease < 0 && trial_value <= current_value + armijo_constant_ * expected_decrease)
+			{
+				value_ = trial_value;
+				accepted = true;
+				break;
+			}
+
+			step_size *= backtracking_factor_;
+		}
+
+		step_size_ = step_size;
+		step_size_memory_valid_ = true;
+		if (!accepted)
+		{
+			return;
+		}
 
 		std::lock_guard<std::mutex> x_lock(x_mutex_);
 		x_ = std::move(current_x);
@@ -247,21 +297,23 @@ private:
 
 	// Flags and states
 	ThreadState thread_state_;
-	bool flip_avoiding_line_search_enabled_;
 	bool approximation_invalidated_;
 
 	// Current approximation and descent direction
 	Eigen::VectorXd x_;
 	Eigen::VectorXd p_;
 
-	// Faces
-	Eigen::MatrixX3i F_;
-
 	// Iteration status
 	int64_t iteration_;
 	int64_t line_search_iteration_;
 	double step_size_;
 	double initial_step_size_;
+	double armijo_constant_;
+	double step_size_growth_factor_;
+	double backtracking_factor_;
+	bool step_size_memory_enabled_;
+	bool step_size_memory_valid_;
+	bool normalized_search_direction_;
 	double value_;
 };
 
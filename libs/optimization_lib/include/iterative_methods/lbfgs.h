@@ -0,0 +1,157 @@
+#pragma once
+#ifndef OPTIMIZATION_LIB_LBFGS_H
+#define OPTIMIZATION_LIB_LBFGS_H
+
+// STL includes
+#include <memory>
+#include <algorithm>
+
+// Eigen includes
+#include <Eigen/Core>
+
+// Optimization lib includes
+#include "./iterative_method.h"
+
+// https://en.wikipedia.org/wiki/Limited-memory_BFGS
+// The (s, y) history is kept in ring buffers that are allocated once, so an iteration does not allocate.
+template <Eigen::StorageOptions StorageOrder_>
+class LBFGS : public IterativeMethod<StorageOrder_>
+{
+public:
+	LBFGS(std::shared_ptr<ObjectiveFunction<StorageOrder_, Eigen::VectorXd>> objective_function, const Eigen::VectorXd& x0, const int64_t history_size = 10) :
+		IterativeMethod(objective_function, x0),
+		history_size_(history_size),
+		history_count_(0),
+		history_head_(0),
+		has_previous_(false)
+	{
+		const auto variables_count = x0.size();
+		S_.resize(variables_count, history_size_);
+		Y_.resize(variables_count, history_size_);
+		rho_.resize(history_size_);
+		alpha_.resize(history_size_);
+		x_previous_.resize(variables_count);
+		g_previous_.resize(variables_count);
+		q_.resize(variables_count);
+
+		// The quasi-newton step has a natural length of 1 (relative to the search direction as is)
+		this->SetNormalizedSearchDirection(false);
+		this->SetInitialStepSize(1);
+		this->SetStepSizeMemoryEnabled(false);
+	}
+
+	virtual ~LBFGS()
+	{
+
+	}
+
+	void ResetHistory()
+	{
+		history_count_ = 0;
+		history_head_ = 0;
+		has_previous_ = false;
+	}
+
+protected:
+	// Zeroes the entries of v that belong to variables held fixed in this iteration (the active set of bound constrained variants)
+	virtual void ApplyActiveSet(const Eigen::VectorXd& x, const Eigen::VectorXd& g, Eigen::VectorXd& v) const
+	{
+
+	}
+
+private:
+	void ComputeDescentDirection(Eigen::VectorXd& p) override
+	{
+		const Eigen::VectorXd& x = this->GetX();
+		const Eigen::VectorXd& g = this->GetObjectiveFunction()->GetGradient();
+
+		UpdateHistory(x, g);
+
+		/**
+		 * Two-loop recursion: p = -H * g
+		 */
+		q_ = g;
+		ApplyActiveSet(x, g, q_);
+
+		for (int64_t k = 0; k < history_count_; k++)
+		{
+			const int64_t i = (history_head_ - 1 - k + history_size_) % history_size_;
+			alpha_.coeffRef(i) = rho_.coeff(i) * S_.col(i).dot(q_);
+			q_ -= alpha_.coeff(i) * Y_.col(i);
+		}
+
+		if (history_count_ > 0)
+		{
+			// Initial hessian approximation gamma * I, scaled by the newest pair
+			const int64_t newest = (history_head_ - 1 + history_size_) % history_size_;
+			q_ *= S_.col(newest).dot(Y_.col(newest)) / Y_.col(newest).squaredNorm();
+		}
+		else
+		{
+			// No curvature information yet; take a unit length steepest descent step
+			const double norm = q_.norm();
+			if (norm > 0)
+			{
+				q_ /= norm;
+			}
+		}
+
+		for (int64_t k = history_count_ - 1; k >= 0; k--)
+		{
+			const int64_t i = (history_head_ - 1 - k + history_size_) % history_size_;
+			const double beta = rho_.coeff(i) * Y_.col(i).dot(q_);
+			q_ += (alpha_.coeff(i) - beta) * S_.col(i);
+		}
+
+		p = -q_;
+		ApplyActiveSet(x, g, p);
+	}
+
+	void UpdateHistory(const Eigen::VectorXd& x, const Eigen::VectorXd& g)
+	{
+		if (has_previous_)
+		{
+			S_.col(history_head_) = x - x_previous_;
+			Y_.col(history_head_) = g - g_previous_;
+
+			const double sy = S_.col(history_head_).dot(Y_.col(history_head_));
+			if (sy > 1e-10 * Y_.col(history_head_).squaredNorm())
+			{
+				rho_.coeffRef(history_head_) = 1 / sy;
+				history_head_ = (history_head_ + 1) % history_size_;
+				history_count_ = std::min(history_count_ + 1, history_size_);
+			}
+			else if (S_.col(history_head_).squaredNorm() == 0)
+			{
+				// The previous line search failed; restart from steepest descent
+				history_count_ = 0;
+				history_head_ = 0;
+			}
+		}
+
+		x_previous_ = x;
+		g_previous_ = g;
+		has_previous_ = true;
+	}
+
+	/**
+	 * Fields
+	 */
+	const int64_t history_size_;
+	int64_t history_count_;
+	int64_t history_head_;
+	bool has_previous_;
+
+	// Ring buffers (one column/entry per (s, y) pair)
+	Eigen::MatrixXd S_;
+	Eigen::MatrixXd Y_;
+	Eigen::VectorXd rho_;
+	Eigen::VectorXd alpha_;
+
+	// Workspace
+	Eigen::VectorXd x_previous_;
+	Eigen::VectorXd g_previous_;
+	Eigen::VectorXd q_;
+};
+
+#endif
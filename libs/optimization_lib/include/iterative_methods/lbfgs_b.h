@@ -0,0 +1,74 @@
+#pragma once
+#ifndef OPTIMIZATION_LIB_LBFGS_B_H
+#define OPTIMIZATION_LIB_LBFGS_B_H
+
+// STL includes
+#include <memory>
+#include <limits>
+
+// Eigen includes
+#include <Eigen/Core>
+
+// Optimization lib includes
+#include "./lbfgs.h"
+
+// Bound constrained L-BFGS (in the spirit of L-BFGS-B, with a projected line search instead of the generalized cauchy point):
+// variables sitting on a bound with the gradient pushing outwards are held fixed, the quasi-newton direction is computed on the free variables,
+// and every trial point is projected onto the box [lower, upper].
+template <Eigen::StorageOptions StorageOrder_>
+class LBFGSB : public LBFGS<StorageOrder_>
+{
+public:
+	LBFGSB(std::shared_ptr<ObjectiveFunction<StorageOrder_, Eigen::VectorXd>> objective_function, const Eigen::VectorXd& x0, const Eigen::VectorXd& lower, const Eigen::VectorXd& upper, const int64_t history_size = 10) :
+		LBFGS(objective_function, x0, history_size),
+		lower_(lower),
+		upper_(upper)
+	{
+
+	}
+
+	// Non-negativity constraints (e.g. the localization potential v)
+	LBFGSB(std::shared_ptr<ObjectiveFunction<StorageOrder_, Eigen::VectorXd>> objective_function, const Eigen::VectorXd& x0, const int64_t history_size = 10) :
+		LBFGSB(objective_function, x0, Eigen::VectorXd::Zero(x0.size()), Eigen::VectorXd::Constant(x0.size(), std::numeric_limits<double>::infinity()), history_size)
+	{
+
+	}
+
+	virtual ~LBFGSB()
+	{
+
+	}
+
+	void SetBounds(const Eigen::VectorXd& lower, const Eigen::VectorXd& upper)
+	{
+		lower_ = lower;
+		upper_ = upper;
+		this->ResetHistory();
+	}
+
+protected:
+	void ApplyActiveSet(const Eigen::VectorXd& x, const Eigen::VectorXd& g, Eigen::VectorXd& v) const override
+	{
+		for (int64_t i = 0; i < v.size(); i++)
+		{
+			if ((x.coeff(i) <= lower_.coeff(i) && g.coeff(i) > 0) || (x.coeff(i) >= upper_.coeff(i) && g.coeff(i) < 0))
+			{
+				v.coeffRef(i) = 0;
+			}
+		}
+	}
+
+private:
+	void Project(Eigen::VectorXd& x) override
+	{
+		x = x.cwiseMax(lower_).cwiseMin(upper_);
+	}
+
+	/**
+	 * Fields
+	 */
+	Eigen::VectorXd lower_;
+	Eigen::VectorXd upper_;
+};
+
+#endif
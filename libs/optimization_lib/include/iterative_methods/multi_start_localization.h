@@ -0,0 +1,239 @@
+#pragma once
+#ifndef OPTIMIZATION_LIB_MULTI_START_LOCALIZATION_H
+#define OPTIMIZATION_LIB_MULTI_START_LOCALIZATION_H
+
+// STL includes
+#include <memory>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <limits>
+
+// Eigen includes
+#include <Eigen/Core>
+
+// TBB includes
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
+// Optimization lib includes
+#include "../data_providers/empty_data_provider.h"
+#include "../objective_functions/region_localization_objective.h"
+#include "../solvers/laplacian_eigen_basis.h"
+#include "./projected_gradient_descent.h"
+
+// Runs several independent region localizations (each seeded by a gaussian around a different random vertex) concurrently.
+// Every run owns its objective and solver, while the mesh (and with it W, A and the mass matrix operator) is shared read-only.
+// The runs advance in rounds; after each round, runs whose value is worse than prune_factor times the best value are dropped.
+template <Eigen::StorageOptions StorageOrder_>
+class MultiStartLocalization
+{
+public:
+	/**
+	 * Public type definitions
+	 */
+	struct Result
+	{
+		RDS::VertexIndex seed_vertex_index;
+		Eigen::VectorXd x;
+		double value;
+		int64_t iterations;
+		bool pruned;
+	};
+
+	/**
+	 * Constructors and destructor
+	 */
+	MultiStartLocalization(const std::shared_ptr<MeshDataProvider>& mesh_data_provider, const Eigen::VectorXd& mu, const int64_t runs_count) :
+		mesh_data_provider_(mesh_data_provider),
+		empty_data_provider_(std::make_shared<EmptyDataProvider>(mesh_data_provider)),
+		mu_(mu),
+		runs_count_(runs_count),
+		rounds_count_(10),
+		round_iterations_(20),
+		prune_factor_(4),
+		initial_step_size_(0.000001),
+		rng_seed_(std::random_device()())
+	{
+
+	}
+
+	virtual ~MultiStartLocalization()
+	{
+
+	}
+
+	/**
+	 * Public setters
+	 */
+	void SetRoundsCount(const int64_t rounds_count)
+	{
+		rounds_count_ = rounds_count;
+	}
+
+	void SetRoundIterations(const int64_t round_iterations)
+	{
+		round_iterations_ = round_iterations;
+	}
+
+	void SetPruneFactor(const double prune_factor)
+	{
+		prune_factor_ = prune_factor;
+	}
+
+	void SetInitialStepSize(const double initial_step_size)
+	{
+		initial_step_size_ = initial_step_size;
+	}
+
+	void SetRandomSeed(const uint32_t rng_seed)
+	{
+		rng_seed_ = rng_seed;
+	}
+
+	void SetReducedBasis(const std::shared_ptr<LaplacianEigenBasis>& reduced_basis)
+	{
+		reduced_basis_ = reduced_basis;
+	}
+
+	/**
+	 * Public getters
+	 */
+
+	// Sorted by value (best first)
+	const std::vector<Result>& GetResults() const
+	{
+		return results_;
+	}
+
+	/**
+	 * Public methods
+	 */
+
+	// Blocks until all runs were either completed or pruned
+	void Run()
+	{
+		std::mt19937 rng(rng_seed_);
+		std::uniform_int_distribution<RDS::VertexIndex> dist(0, mesh_data_provider_->GetDomainVerticesCount() - 1);
+
+		std::vector<LocalizationRun> runs(runs_count_);
+		for (auto& run : runs)
+		{
+			run.seed_vertex_index = dist(rng);
+			run.active = true;
+		}
+
+		// Setup (including the first eigensolve of every run) is as expensive as an iteration, so it runs in parallel as well
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, runs.size(), 1), [&](const tbb::blocked_range<std::size_t>& range) {
+			for (std::size_t i = range.begin(); i != range.end(); i++)
+			{
+				InitializeRun(runs[i]);
+			}
+		});
+
+		for (int64_t round = 0; round < rounds_count_; round++)
+		{
+			std::vector<LocalizationRun*> active_runs;
+			for (auto& run : runs)
+			{
+				if (run.active)
+				{
+					active_runs.push_back(&run);
+				}
+			}
+
+			if (active_runs.empty())
+			{
+				break;
+			}
+
+			tbb::parallel_for(tbb::blocked_range<std::size_t>(0, active_runs.size(), 1), [&](const tbb::blocked_range<std::size_t>& range) {
+				for (std::size_t i = range.begin(); i != range.end(); i++)
+				{
+					for (int64_t iteration = 0; iteration < round_iterations_; iteration++)
+					{
+						active_runs[i]->method->Step();
+					}
+				}
+			});
+
+			Prune(active_runs);
+		}
+
+		results_.clear();
+		results_.reserve(runs.size());
+		for (auto& run : runs)
+		{
+			Result result;
+			result.seed_vertex_index = run.seed_vertex_index;
+			result.x = run.method->GetX();
+			result.value = run.method->GetValue();
+			result.iterations = run.method->GetIteration();
+			result.pruned = !run.active;
+			results_.push_back(std::move(result));
+		}
+
+		std::sort(results_.begin(), results_.end(), [](const Result& lhs, const Result& rhs) {
+			return lhs.value < rhs.value;
+		});
+	}
+
+private:
+	/**
+	 * Private type definitions
+	 */
+	struct LocalizationRun
+	{
+		RDS::VertexIndex seed_vertex_index;
+		std::shared_ptr<RegionLocalizationObjective<StorageOrder_>> objective;
+		std::unique_ptr<ProjectedGradientDescent<StorageOrder_>> method;
+		bool active;
+	};
+
+	/**
+	 * Private methods
+	 */
+	void InitializeRun(LocalizationRun& run)
+	{
+		run.objective = std::make_shared<RegionLocalizationObjective<StorageOrder_>>(mesh_data_provider_, mu_, empty_data_provider_);
+		if (reduced_basis_)
+		{
+			run.objective->EnableReducedBasis(reduced_basis_);
+		}
+
+		const Eigen::VectorXd v0 = mesh_data_provider_->GetRandomVerticesGaussian(run.seed_vertex_index);
+		run.method = std::make_unique<ProjectedGradientDescent<StorageOrder_>>(run.objective, v0);
+		run.method->SetInitialStepSize(initial_step_size_);
+	}
+
+	void Prune(const std::vector<LocalizationRun*>& active_runs)
+	{
+		double best_value = std::numeric_limits<double>::infinity();
+		for (auto run : active_runs)
+		{
+			best_value = std::min(best_value, run->method->GetValue());
+		}
+
+		for (auto run : active_runs)
+		{
+			run->active = run->method->GetValue() <= prune_factor_ * best_value;
+		}
+	}
+
+	/**
+	 * Private fields
+	 */
+	std::shared_ptr<MeshDataProvider> mesh_data_provider_;
+	std::shared_ptr<EmptyDataProvider> empty_data_provider_;
+	std::shared_ptr<LaplacianEigenBasis> reduced_basis_;
+	Eigen::VectorXd mu_;
+	int64_t runs_count_;
+	int64_t rounds_count_;
+	int64_t round_iterations_;
+	double prune_factor_;
+	double initial_step_size_;
+	uint32_t rng_seed_;
+	std::vector<Result> results_;
+};
+
+#endif
@@ -0,0 +1,214 @@
+#pragma once
+#ifndef OPTIMIZATION_LIB_AUTO_DIFF_OBJECTIVE_H
+#define OPTIMIZATION_LIB_AUTO_DIFF_OBJECTIVE_H
+
+// STL includes
+#include <array>
+#include <vector>
+#include <algorithm>
+
+// Optimization lib includes
+#include "../core/core.h"
+#include "../core/dual.h"
+#include "../core/hyper_dual.h"
+#include "./sparse_objective_function.h"
+
+// Element objective whose gradient and hessian are derived automatically from its value expression (forward-mode, see Dual and HyperDual).
+// Derived_ supplies (and declares AutoDiffObjective as a friend, so the following may be private):
+//   void InitializeLocalVariableIndices(std::vector<RDS::SparseVariableIndex>& local_variable_indices)
+//     - the (distinct) sparse indices of the ObjectiveVariablesCount_ local variables, in the order CalculateLocalValue expects them
+//   template<typename Scalar_> Scalar_ CalculateLocalValue(const LocalVariables<Scalar_>& x) const
+//     - the value expression; it is evaluated with Scalar_ = double for values, with Scalar_ = Dual<ObjectiveVariablesCount_> when only the gradient
+//       is requested, and with Scalar_ = HyperDual<ObjectiveVariablesCount_> when the hessian is requested
+template<typename Derived_, Eigen::StorageOptions StorageOrder_, int ObjectiveVariablesCount_>
+class AutoDiffObjective : public SparseObjectiveFunction<StorageOrder_>
+{
+public:
+	/**
+	 * Public type definitions
+	 */
+	using FirstOrderDual = Dual<ObjectiveVariablesCount_>;
+	using SecondOrderDual = HyperDual<ObjectiveVariablesCount_>;
+
+	template<typename Scalar_>
+	using LocalVariables = std::array<Scalar_, ObjectiveVariablesCount_>;
+
+	/**
+	 * Constructors and destructor
+	 */
+	AutoDiffObjective(const std::shared_ptr<MeshDataProvider>& mesh_data_provider, const std::shared_ptr<DataProvider>& data_provider, const std::string& name, const bool enforce_psd) :
+		SparseObjectiveFunction(mesh_data_provider, data_provider, name, ObjectiveVariablesCount_ / 2, ObjectiveVariablesCount_, enforce_psd)
+	{
+
+	}
+
+	virtual ~AutoDiffObjective()
+	{
+
+	}
+
+	/**
+	 * Public overrides
+	 */
+	using SparseObjectiveFunction<StorageOrder_>::Update;
+
+	// When derivatives are requested as well, the value is taken from their evaluation rather than evaluated separately;
+	// the derivatives are evaluated to the highest order requested (first order when the hessian is not requested)
+	void Update(const Eigen::VectorXd& x, const int32_t update_modifiers) override
+	{
+		const auto update_options = static_cast<ObjectiveFunctionBase::UpdateOptions>(update_modifiers);
+		if ((update_options & ObjectiveFunctionBase::UpdateOptions::Hessian) != ObjectiveFunctionBase::UpdateOptions::None)
+		{
+			requested_order_ = 2;
+		}
+		else if ((update_options & ObjectiveFunctionBase::UpdateOptions::Gradient) != ObjectiveFunctionBase::UpdateOptions::None)
+		{
+			requested_order_ = 1;
+		}
+		else
+		{
+			requested_order_ = 0;
+		}
+
+		SparseObjectiveFunction<StorageOrder_>::Update(x, update_modifiers);
+	}
+
+protected:
+	/**
+	 * Protected overrides
+	 */
+	void PreUpdate(const Eigen::VectorXd& x) override
+	{
+		for (int i = 0; i < ObjectiveVariablesCount_; i++)
+		{
+			x_[i] = x.coeff(local_variable_indices_[i]);
+		}
+
+		derivatives_order_ = 0;
+	}
+
+	void PostInitialize() override
+	{
+		SparseObjectiveFunction<StorageOrder_>::PostInitialize();
+
+		std::array<int, ObjectiveVariablesCount_> dense_variable_index_to_local_variable_index;
+		for (int i = 0; i < ObjectiveVariablesCount_; i++)
+		{
+			dense_variable_index_to_local_variable_index[this->GetDenseVariableIndex(local_variable_indices_[i])] = i;
+			first_order_dual_x_[i] = FirstOrderDual::Variable(0, i);
+			second_order_dual_x_[i] = SecondOrderDual::Variable(0, i);
+		}
+
+		// The local hessian triplets are ordered by dense variable indices, and the packed hessian by local variable indices
+		const auto& hessian_triplet_index_to_hessian_entry_array = this->GetHessianTripletIndexToHessianEntryArray();
+		for (std::size_t i = 0; i < triplet_index_to_packed_hessian_index_.size(); i++)
+		{
+			const int local_variable_index1 = dense_variable_index_to_local_variable_index[hessian_triplet_index_to_hessian_entry_array[i].first];
+			const int local_variable_index2 = dense_variable_index_to_local_variable_index[hessian_triplet_index_to_hessian_entry_array[i].second];
+			const int row = std::min(local_variable_index1, local_variable_index2);
+			const int column = std::max(local_variable_index1, local_variable_index2);
+			triplet_index_to_packed_hessian_index_[i] = ((column * (column + 1)) / 2) + row;
+		}
+
+		derivatives_order_ = 0;
+	}
+
+private:
+	/**
+	 * Private overrides
+	 */
+	void InitializeSparseVariableIndices(std::vector<RDS::SparseVariableIndex>& sparse_variable_indices) override
+	{
+		local_variable_indices_.clear();
+		static_cast<Derived_*>(this)->InitializeLocalVariableIndices(local_variable_indices_);
+		sparse_variable_indices.insert(sparse_variable_indices.end(), local_variable_indices_.begin(), local_variable_indices_.end());
+	}
+
+	void CalculateValue(double& f) override
+	{
+		if (requested_order_ > 0)
+		{
+			UpdateDerivatives(requested_order_);
+		}
+
+		f = derivatives_order_ > 0 ? value_ : static_cast<const Derived_*>(this)->template CalculateLocalValue<double>(x_);
+	}
+
+	void CalculateGradient(Eigen::SparseVector<double>& g) override
+	{
+		UpdateDerivatives(std::max(requested_order_, 1));
+		for (int i = 0; i < ObjectiveVariablesCount_; i++)
+		{
+			g.coeffRef(local_variable_indices_[i]) = gradient_.coeff(i);
+		}
+	}
+
+	void CalculateRawTriplets(const TripletsView& triplets) override
+	{
+		UpdateDerivatives(2);
+		for (std::size_t i = 0; i < triplet_index_to_packed_hessian_index_.size(); i++)
+		{
+			const_cast<double&>(triplets[i].value()) = packed_hessian_.coeff(triplet_index_to_packed_hessian_index_[i]);
+		}
+	}
+
+	/**
+	 * Private methods
+	 */
+
+	// Evaluates the value expression on the seeded local variables, up to the given order of derivatives (once per x, shared by the value, the gradient and the hessian)
+	void UpdateDerivatives(const int order)
+	{
+		if (derivatives_order_ >= order)
+		{
+			return;
+		}
+
+		if (order == 1)
+		{
+			for (int i = 0; i < ObjectiveVariablesCount_; i++)
+			{
+				first_order_dual_x_[i].SetValue(x_[i]);
+			}
+
+			const FirstOrderDual dual = static_cast<const Derived_*>(this)->template CalculateLocalValue<FirstOrderDual>(first_order_dual_x_);
+			value_ = dual.GetValue();
+			gradient_ = dual.GetGradient();
+		}
+		else
+		{
+			for (int i = 0; i < ObjectiveVariablesCount_; i++)
+			{
+				second_order_dual_x_[i].SetValue(x_[i]);
+			}
+
+			const SecondOrderDual dual = static_cast<const Derived_*>(this)->template CalculateLocalValue<SecondOrderDual>(second_order_dual_x_);
+			value_ = dual.GetValue();
+			gradient_ = dual.GetGradient();
+			packed_hessian_ = dual.GetPackedHessian();
+		}
+
+		derivatives_order_ = order;
+	}
+
+	/**
+	 * Private fields
+	 */
+
+	// Sparse variable index of each local variable, and the packed (local) hessian entry of each local hessian triplet
+	std::vector<RDS::SparseVariableIndex> local_variable_indices_;
+	std::array<int, SecondOrderDual::PackedHessianSize> triplet_index_to_packed_hessian_index_;
+
+	// Local variables of the current x (the seeded variables are kept, only their values change), and the value expression and its derivatives at x
+	// (up to derivatives_order_; 0 when they were not evaluated at x yet)
+	LocalVariables<double> x_;
+	LocalVariables<FirstOrderDual> first_order_dual_x_;
+	LocalVariables<SecondOrderDual> second_order_dual_x_;
+	double value_;
+	typename SecondOrderDual::GradientType gradient_;
+	typename SecondOrderDual::PackedHessianType packed_hessian_;
+	int derivatives_order_ = 0;
+	int requested_order_ = 2;
+};
+
+#endif
@@ -51,6 +51,12 @@ protected:
 		CalculateDerivativesOuter(inner_objective_->GetValue(), outer_value_, outer_first_derivative_, outer_second_derivative_);
 	}
 
+	void RemapDependencies(const UpdatableObject::CloneMap& clones) override
+	{
+		SparseObjectiveFunction::RemapDependencies(clones);
+		inner_objective_ = UpdatableObject::Remap(inner_objective_, clones);
+	}
+
 	/**
 	 * Value, first derivative and second derivative calculation for outer function (f: R -> R)
 	 */
@@ -75,7 +81,7 @@ private:
 		g = outer_first_derivative_ * inner_objective_->GetGradient();
 	}
 
-	void CalculateRawTriplets(std::vector<Eigen::Triplet<double>>& triplets) override
+	void CalculateRawTriplets(const TripletsView& triplets) override
 	{
 		const auto triplets_count = triplets.size();
 		auto& g_inner = inner_objective_->GetGradient();
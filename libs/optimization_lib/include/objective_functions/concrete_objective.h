@@ -9,6 +9,8 @@
 #include <mutex>
 #include <any>
 #include <limits>
+#include <vector>
+#include <algorithm>
 
 // Eigen Includes
 #include <Eigen/Core>
@@ -18,6 +20,7 @@
 // Optimization Lib Includes
 #include "./objective_function.h"
 #include "../core/core.h"
+#include "../core/psd_projection.h"
 #include "../data_providers/data_provider.h"
 
 template<Eigen::StorageOptions StorageOrder_, typename VectorType_>
@@ -37,7 +40,25 @@ public:
 		ObjectiveFunction(mesh_data_provider, data_provider, name),
 		objective_vertices_count_(objective_vertices_count),
 		objective_variables_count_(objective_variables_count),
-		enforce_psd_(enforce_psd)
+		enforce_psd_(enforce_psd),
+		defer_psd_projection_(false)
+	{
+
+	}
+
+	// Copies everything but the mutex
+	ConcreteObjective(const ConcreteObjective& other) :
+		ObjectiveFunction(other),
+		objective_vertices_count_(other.objective_vertices_count_),
+		objective_variables_count_(other.objective_variables_count_),
+		parallelism_enabled_(other.parallelism_enabled_),
+		enforce_psd_(other.enforce_psd_),
+		defer_psd_projection_(other.defer_psd_projection_),
+		sparse_variable_indices_(other.sparse_variable_indices_),
+		hessian_entry_to_triplet_index_array_(other.hessian_entry_to_triplet_index_array_),
+		hessian_triplet_index_to_hessian_entry_array_(other.hessian_triplet_index_to_hessian_entry_array_),
+		dense_variable_index_to_sparse_variable_index_array_(other.dense_variable_index_to_sparse_variable_index_array_),
+		dense_variable_index_to_vertex_index_array_(other.dense_variable_index_to_vertex_index_array_)
 	{
 
 	}
@@ -71,19 +92,53 @@ public:
 		return sparse_variable_indices_;
 	}
 
-	const RDS::HessianEntryToTripletIndexMap& GetHessianEntryToTripletIndexMap() const
+	const RDS::DenseVariableIndexToSparseVariableIndexArray& GetDenseVariableIndexToSparseVariableIndexArray() const
+	{
+		return dense_variable_index_to_sparse_variable_index_array_;
+	}
+
+	const RDS::HessianTripletIndexToHessianEntryArray& GetHessianTripletIndexToHessianEntryArray() const
+	{
+		return hessian_triplet_index_to_hessian_entry_array_;
+	}
+
+	RDS::SparseVariableIndex GetSparseVariableIndex(const RDS::DenseVariableIndex dense_variable_index) const
+	{
+		return dense_variable_index_to_sparse_variable_index_array_[dense_variable_index];
+	}
+
+	// Binary search over the (sorted) sparse variable indices; meant for initialization code, evaluation code should use dense indices directly
+	RDS::DenseVariableIndex GetDenseVariableIndex(const RDS::SparseVariableIndex sparse_variable_index) const
 	{
-		return hessian_entry_to_triplet_index_map_;
+		const auto it = std::lower_bound(dense_variable_index_to_sparse_variable_index_array_.begin(), dense_variable_index_to_sparse_variable_index_array_.end(), sparse_variable_index);
+		return std::distance(dense_variable_index_to_sparse_variable_index_array_.begin(), it);
 	}
 
-	const RDS::SparseVariableIndexToDenseVariableIndexMap& GetSparseVariableIndexToDenseVariableIndexMap() const
+	RDS::HessianTripletIndex GetHessianTripletIndex(const RDS::DenseVariableIndex row, const RDS::DenseVariableIndex column) const
 	{
-		return sparse_variable_index_to_dense_variable_index_map_;
+		return hessian_entry_to_triplet_index_array_[row * objective_variables_count_ + column];
 	}
 
-	const RDS::DenseVariableIndexToSparseVariableIndexMap& GetDenseVariableIndexToSparseVariableIndexMap() const
+	int64_t GetPsdProjectionSize() const override
 	{
-		return dense_variable_index_to_sparse_variable_index_map_;
+		return (enforce_psd_ && !hessian_triplet_index_to_hessian_entry_array_.empty()) ? objective_variables_count_ : 0;
+	}
+
+	bool GetDeferPsdProjection() const override
+	{
+		return defer_psd_projection_;
+	}
+
+	// The variables the objective is differentiated by are the variables it reads
+	bool GetVariablesFootprint(std::vector<RDS::SparseVariableIndex>& variables_footprint) const override
+	{
+		if (sparse_variable_indices_.empty())
+		{
+			return false;
+		}
+
+		variables_footprint.insert(variables_footprint.end(), sparse_variable_indices_.begin(), sparse_variable_indices_.end());
+		return true;
 	}
 
 	/**
@@ -91,7 +146,20 @@ public:
 	 */
 	void SetEnforcePsd(const bool enforce_psd)
 	{
-		enforce_psd_ = enforce_psd;
+		if (enforce_psd_ != enforce_psd)
+		{
+			enforce_psd_ = enforce_psd;
+			this->Invalidate();
+		}
+	}
+
+	void SetDeferPsdProjection(const bool defer_psd_projection) override
+	{
+		if (defer_psd_projection_ != defer_psd_projection)
+		{
+			defer_psd_projection_ = defer_psd_projection;
+			this->Invalidate();
+		}
 	}
 
 protected:
@@ -119,17 +187,17 @@ private:
 		// Empty implementation
 	}
 
+	// Dense variable indices are the positions of the sorted sparse variable indices
 	virtual void InitializeMappings(
-		RDS::SparseVariableIndexToDenseVariableIndexMap& sparse_variable_index_to_dense_variable_index_map,
-		RDS::DenseVariableIndexToSparseVariableIndexMap& dense_variable_index_to_sparse_variable_index_map,
-		RDS::SparseVariableIndexToVertexIndexMap& sparse_variable_index_to_vertex_index_map)
+		RDS::DenseVariableIndexToSparseVariableIndexArray& dense_variable_index_to_sparse_variable_index_array,
+		RDS::DenseVariableIndexToVertexIndexArray& dense_variable_index_to_vertex_index_array)
 	{
 		std::sort(sparse_variable_indices_.begin(), sparse_variable_indices_.end());
+		dense_variable_index_to_sparse_variable_index_array = sparse_variable_indices_;
+		dense_variable_index_to_vertex_index_array.resize(sparse_variable_indices_.size());
 		for (std::size_t i = 0; i < sparse_variable_indices_.size(); i++)
 		{
-			dense_variable_index_to_sparse_variable_index_map.insert({ i, sparse_variable_indices_[i] });
-			sparse_variable_index_to_dense_variable_index_map.insert({ sparse_variable_indices_[i], i });
-			sparse_variable_index_to_vertex_index_map.insert({ sparse_variable_indices_[i], mesh_data_provider_->GetVertexIndex(sparse_variable_indices_[i])});
+			dense_variable_index_to_vertex_index_array[i] = mesh_data_provider_->GetVertexIndex(sparse_variable_indices_[i]);
 		}
 	}
 
@@ -137,29 +205,33 @@ private:
 	{
 		const auto objective_variables_count_squared = objective_variables_count_ * objective_variables_count_;
 		triplets.resize(((objective_variables_count_squared - objective_variables_count_) / 2) + objective_variables_count_);
+		hessian_triplet_index_to_hessian_entry_array_.resize(triplets.size());
+		hessian_entry_to_triplet_index_array_.resize(objective_variables_count_squared);
 		auto triplet_index = 0;
 		for (auto column = 0; column < objective_variables_count_; column++)
 		{
 			for (auto row = 0; row <= column; row++)
 			{
 				triplets[triplet_index] = Eigen::Triplet<double>(
-					dense_variable_index_to_sparse_variable_index_map_[row],
-					dense_variable_index_to_sparse_variable_index_map_[column],
+					dense_variable_index_to_sparse_variable_index_array_[row],
+					dense_variable_index_to_sparse_variable_index_array_[column],
 					0);
 
-				hessian_entry_to_triplet_index_map_[{ row, column }] = triplet_index;
+				hessian_triplet_index_to_hessian_entry_array_[triplet_index] = { row, column };
+				hessian_entry_to_triplet_index_array_[row * objective_variables_count_ + column] = triplet_index;
 				triplet_index++;
 			}
 		}
 	}
 
+	// Objectives may be initialized more than once (a summation objective re-initializes its children), so the indices are collected from scratch
 	virtual void InitializeTriplets(std::vector<Eigen::Triplet<double>>& triplets)
 	{
+		sparse_variable_indices_.clear();
 		InitializeSparseVariableIndices(sparse_variable_indices_);
 		InitializeMappings(
-			sparse_variable_index_to_dense_variable_index_map_,
-			dense_variable_index_to_sparse_variable_index_map_,
-			sparse_variable_index_to_vertex_index_map_);
+			dense_variable_index_to_sparse_variable_index_array_,
+			dense_variable_index_to_vertex_index_array_);
 		CreateTriplets(triplets);
 	}
 
@@ -171,7 +243,7 @@ private:
 		const auto sparse_variables_indices_count = sparse_variable_indices_.size();
 		for (std::size_t i = 0; i < sparse_variables_indices_count; i++)
 		{
-			f_per_vertex.coeffRef(sparse_variable_index_to_vertex_index_map_[sparse_variable_indices_[i]]) += value;
+			f_per_vertex.coeffRef(dense_variable_index_to_vertex_index_array_[i]) += value;
 		}
 	}
 
@@ -180,32 +252,64 @@ private:
 		// Empty implementation
 	}
 
+	// In a summation, the values are written straight into the range of this objective in the triplets of the summation (see ObjectiveFunction::SetTripletsTarget)
 	void CalculateTriplets(std::vector<Eigen::Triplet<double>>& triplets)
 	{
-		CalculateRawTriplets(triplets);
-		CalculateConvexTriplets(triplets);
+		const TripletsView triplets_view = this->GetTripletsView(triplets);
+		CalculateRawTriplets(triplets_view);
+		CalculateConvexTriplets(triplets_view);
+		this->CommitTripletsView(triplets_view);
+	}
+
+	bool IsTripletsTargetSupported() const override
+	{
+		return true;
 	}
 
-	virtual void CalculateRawTriplets(std::vector<Eigen::Triplet<double>>& triplets) = 0;
+	virtual void CalculateRawTriplets(const TripletsView& triplets) = 0;
 	
-	void CalculateConvexTriplets(std::vector<Eigen::Triplet<double>>& triplets)
+	// Objectives that lay out their own triplets (no local hessian entries mapping) project their hessians themselves
+	void CalculateConvexTriplets(const TripletsView& triplets)
 	{
-		if (enforce_psd_)
+		if (enforce_psd_ && !defer_psd_projection_ && !hessian_triplet_index_to_hessian_entry_array_.empty())
 		{
-			Eigen::MatrixXd H;
-			H.resize(objective_variables_count_, objective_variables_count_);
-			H.setZero();
-
-			auto triplets_count = triplets.size();
-			for (std::size_t i = 0; i < triplets_count; i++)
+			switch (objective_variables_count_)
 			{
-				auto row = sparse_variable_index_to_dense_variable_index_map_[triplets[i].row()];
-				auto col = sparse_variable_index_to_dense_variable_index_map_[triplets[i].col()];
-				auto value = triplets[i].value();
-				H.coeffRef(row, col) = value;
-				H.coeffRef(col, row) = value;
+			case 4:
+				CalculateConvexTriplets<4>(triplets);
+				break;
+			case 6:
+				CalculateConvexTriplets<6>(triplets);
+				break;
+			case 8:
+				CalculateConvexTriplets<8>(triplets);
+				break;
+			default:
+				CalculateConvexTriplets<Eigen::Dynamic>(triplets);
+				break;
 			}
+		}
+	}
+
+	template<int N>
+	void CalculateConvexTriplets(const TripletsView& triplets)
+	{
+		Eigen::Matrix<double, N, N> H;
+		H.resize(objective_variables_count_, objective_variables_count_);
 
+		auto triplets_count = triplets.size();
+		for (std::size_t i = 0; i < triplets_count; i++)
+		{
+			const auto& hessian_entry = hessian_triplet_index_to_hessian_entry_array_[i];
+			auto row = hessian_entry.first;
+			auto col = hessian_entry.second;
+			auto value = triplets[i].value();
+			H.coeffRef(row, col) = value;
+			H.coeffRef(col, row) = value;
+		}
+
+		if constexpr (N == Eigen::Dynamic)
+		{
 			Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(H);
 			Eigen::MatrixXd D = solver.eigenvalues().asDiagonal();
 			Eigen::MatrixXd V = solver.eigenvectors();
@@ -219,15 +323,16 @@ private:
 			}
 
 			H = V * D * V.transpose();
+		}
+		else
+		{
+			PsdProjection<N>::Project(H);
+		}
 
-			for (auto column = 0; column < objective_variables_count_; column++)
-			{
-				for (auto row = 0; row <= column; row++)
-				{
-					const auto triplet_index = hessian_entry_to_triplet_index_map_[{row, column}];
-					const_cast<double&>(triplets[triplet_index].value()) = H.coeffRef(row, column);
-				}
-			}
+		for (std::size_t i = 0; i < triplets_count; i++)
+		{
+			const auto& hessian_entry = hessian_triplet_index_to_hessian_entry_array_[i];
+			const_cast<double&>(triplets[i].value()) = H.coeff(hessian_entry.first, hessian_entry.second);
 		}
 	}
 
@@ -237,15 +342,16 @@ private:
 
 	// Enforce PSD
 	bool enforce_psd_;
+	bool defer_psd_projection_;
 
 	// Sparse variable indices
 	std::vector<RDS::SparseVariableIndex> sparse_variable_indices_;
 
-	// Mappings
-	RDS::HessianEntryToTripletIndexMap hessian_entry_to_triplet_index_map_;
-	RDS::SparseVariableIndexToDenseVariableIndexMap sparse_variable_index_to_dense_variable_index_map_;
-	RDS::DenseVariableIndexToSparseVariableIndexMap dense_variable_index_to_sparse_variable_index_map_;
-	RDS::SparseVariableIndexToVertexIndexMap sparse_variable_index_to_vertex_index_map_;
+	// Mappings (flat arrays, built once at initialization)
+	RDS::HessianEntryToTripletIndexArray hessian_entry_to_triplet_index_array_;
+	RDS::HessianTripletIndexToHessianEntryArray hessian_triplet_index_to_hessian_entry_array_;
+	RDS::DenseVariableIndexToSparseVariableIndexArray dense_variable_index_to_sparse_variable_index_array_;
+	RDS::DenseVariableIndexToVertexIndexArray dense_variable_index_to_vertex_index_array_;
 };
 
 #endif
\ No newline at end of file
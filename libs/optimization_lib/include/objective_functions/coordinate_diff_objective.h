@@ -38,7 +38,7 @@ protected:
 		g.coeffRef(coordinate_diff_data_provider_->GetSparseVariable2Index()) = -1;
 	}
 
-	void CalculateRawTriplets(std::vector<Eigen::Triplet<double>>& triplets) override
+	void CalculateRawTriplets(const TripletsView& triplets) override
 	{
 		// Empty implementation
 	}
@@ -47,6 +47,17 @@ private:
 	/**
 	 * Private overrides
 	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override
+	{
+		return std::make_shared<CoordinateDiffObjective>(*this);
+	}
+
+	void RemapDependencies(const UpdatableObject::CloneMap& clones) override
+	{
+		SparseObjectiveFunction::RemapDependencies(clones);
+		coordinate_diff_data_provider_ = UpdatableObject::Remap(coordinate_diff_data_provider_, clones);
+	}
+
 	void InitializeSparseVariableIndices(std::vector<RDS::SparseVariableIndex>& sparse_variable_indices) override
 	{
 		sparse_variable_indices.push_back(coordinate_diff_data_provider_->GetSparseVariable1Index());
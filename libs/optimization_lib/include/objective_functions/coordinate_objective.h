@@ -37,7 +37,7 @@ protected:
 		g.coeffRef(coordinate_data_provider_->GetSparseVariableIndex()) = 1;
 	}
 
-	void CalculateRawTriplets(std::vector<Eigen::Triplet<double>>& triplets) override
+	void CalculateRawTriplets(const TripletsView& triplets) override
 	{
 		const auto sparse_variable_index = coordinate_data_provider_->GetSparseVariableIndex();
 		triplets[0] = Eigen::Triplet<double>(sparse_variable_index, sparse_variable_index, 0);
@@ -47,6 +47,17 @@ private:
 	/**
 	 * Private overrides
 	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override
+	{
+		return std::make_shared<CoordinateObjective>(*this);
+	}
+
+	void RemapDependencies(const UpdatableObject::CloneMap& clones) override
+	{
+		SparseObjectiveFunction::RemapDependencies(clones);
+		coordinate_data_provider_ = UpdatableObject::Remap(coordinate_data_provider_, clones);
+	}
+
 	void InitializeSparseVariableIndices(std::vector<RDS::SparseVariableIndex>& sparse_variable_indices) override
 	{
 		sparse_variable_indices.push_back(coordinate_data_provider_->GetSparseVariableIndex());
@@ -43,7 +43,7 @@ protected:
 		g.coeffRef(cross_coordinate_diff_data_provider_->GetEdge2Variable2Index()) = coordinate_diff_value_doubled;
 	}
 
-	void CalculateRawTriplets(std::vector<Eigen::Triplet<double>>& triplets) override
+	void CalculateRawTriplets(const TripletsView& triplets) override
 	{
 		// Empty implementation
 	}
@@ -52,6 +52,17 @@ private:
 	/**
 	 * Private overrides
 	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override
+	{
+		return std::make_shared<CrossCoordinateDiffObjective>(*this);
+	}
+
+	void RemapDependencies(const UpdatableObject::CloneMap& clones) override
+	{
+		SparseObjectiveFunction::RemapDependencies(clones);
+		cross_coordinate_diff_data_provider_ = UpdatableObject::Remap(cross_coordinate_diff_data_provider_, clones);
+	}
+
 	void InitializeSparseVariableIndices(std::vector<RDS::SparseVariableIndex>& sparse_variable_indices) override
 	{
 		sparse_variable_indices.push_back(cross_coordinate_diff_data_provider_->GetEdge1Variable1Index());
@@ -0,0 +1,68 @@
+#pragma once
+#ifndef OPTIMIZATION_LIB_EDGE_PAIR_ANGLE_AUTO_DIFF_OBJECTIVE_H
+#define OPTIMIZATION_LIB_EDGE_PAIR_ANGLE_AUTO_DIFF_OBJECTIVE_H
+
+// C includes
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+// Optimization lib includes
+#include "../../data_providers/edge_pair_data_provider.h"
+#include "../auto_diff_objective.h"
+
+// Same energy as EdgePairAngleObjective, where the derivatives are derived from the value expression by AutoDiffObjective
+template<Eigen::StorageOptions StorageOrder_>
+class EdgePairAngleAutoDiffObjective : public AutoDiffObjective<EdgePairAngleAutoDiffObjective<StorageOrder_>, StorageOrder_, 8>
+{
+public:
+	/**
+	 * Constructors and destructor
+	 */
+	EdgePairAngleAutoDiffObjective(const std::shared_ptr<MeshDataProvider>& mesh_data_provider, const std::shared_ptr<EdgePairDataProvider>& edge_pair_data_provider, const bool enforce_psd = false) :
+		AutoDiffObjective(mesh_data_provider, edge_pair_data_provider, "Edge Pair Angle Auto Diff Objective", enforce_psd)
+	{
+		this->Initialize();
+	}
+
+	virtual ~EdgePairAngleAutoDiffObjective()
+	{
+
+	}
+
+private:
+	friend class AutoDiffObjective<EdgePairAngleAutoDiffObjective<StorageOrder_>, StorageOrder_, 8>;
+
+	/**
+	 * Private overrides
+	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override
+	{
+		return std::make_shared<EdgePairAngleAutoDiffObjective>(*this);
+	}
+
+	/**
+	 * Private methods
+	 */
+	void InitializeLocalVariableIndices(std::vector<RDS::SparseVariableIndex>& local_variable_indices)
+	{
+		const auto& edge_pair_data_provider = *std::dynamic_pointer_cast<EdgePairDataProvider>(this->data_provider_);
+		local_variable_indices.push_back(edge_pair_data_provider.GetEdge1Vertex1XIndex());
+		local_variable_indices.push_back(edge_pair_data_provider.GetEdge1Vertex1YIndex());
+		local_variable_indices.push_back(edge_pair_data_provider.GetEdge1Vertex2XIndex());
+		local_variable_indices.push_back(edge_pair_data_provider.GetEdge1Vertex2YIndex());
+		local_variable_indices.push_back(edge_pair_data_provider.GetEdge2Vertex1XIndex());
+		local_variable_indices.push_back(edge_pair_data_provider.GetEdge2Vertex1YIndex());
+		local_variable_indices.push_back(edge_pair_data_provider.GetEdge2Vertex2XIndex());
+		local_variable_indices.push_back(edge_pair_data_provider.GetEdge2Vertex2YIndex());
+	}
+
+	// The angle between the two edges (each edge points from its first vertex to its second vertex)
+	template<typename Scalar_>
+	Scalar_ CalculateLocalValue(const std::array<Scalar_, 8>& x) const
+	{
+		using std::atan2;
+		return atan2(x[3] - x[1], x[2] - x[0]) - atan2(x[7] - x[5], x[6] - x[4]) + M_PI;
+	}
+};
+
+#endif
@@ -10,8 +10,8 @@
 #include "../../data_providers/edge_pair_data_provider.h"
 #include "./edge_pair_objective.h"
 
-template<Eigen::StorageOptions StorageOrder_>
-class EdgePairAngleObjective : public EdgePairObjective<StorageOrder_>
+template<Eigen::StorageOptions StorageOrder_, int ObjectiveVariablesCount_ = 8>
+class EdgePairAngleObjective : public EdgePairObjective<StorageOrder_, ObjectiveVariablesCount_>
 {
 public:
 	/**
@@ -72,52 +72,57 @@ protected:
 		/**
 		 * Second partial derivatives
 		 */
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_x_dense_index_][this->e1_v1_x_dense_index_] = e1_diff_prod_to_quad_norm;
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_x_dense_index_][this->e1_v1_y_dense_index_] = -e1_squares_diff_prod_to_quad_norm;
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_x_dense_index_][this->e1_v2_x_dense_index_] = -e1_diff_prod_to_quad_norm;
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_x_dense_index_][this->e1_v2_y_dense_index_] = e1_squares_diff_prod_to_quad_norm;
-
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_x_dense_index_][this->e1_v1_x_dense_index_] = e1_diff_prod_to_quad_norm;
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_x_dense_index_][this->e1_v1_y_dense_index_] = -e1_squares_diff_prod_to_quad_norm;
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_x_dense_index_][this->e1_v2_x_dense_index_] = -e1_diff_prod_to_quad_norm;
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_x_dense_index_][this->e1_v2_y_dense_index_] = e1_squares_diff_prod_to_quad_norm;
-
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_y_dense_index_][this->e1_v1_x_dense_index_] = e1_squares_diff_prod_to_quad_norm;
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_y_dense_index_][this->e1_v1_y_dense_index_] = e1_diff_prod_to_quad_norm;
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_y_dense_index_][this->e1_v2_x_dense_index_] = -e1_squares_diff_prod_to_quad_norm;
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_y_dense_index_][this->e1_v2_y_dense_index_] = -e1_diff_prod_to_quad_norm;
-
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_y_dense_index_][this->e1_v1_x_dense_index_] = e1_squares_diff_prod_to_quad_norm;
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_y_dense_index_][this->e1_v1_y_dense_index_] = e1_diff_prod_to_quad_norm;
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_y_dense_index_][this->e1_v2_x_dense_index_] = -e1_squares_diff_prod_to_quad_norm;
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_y_dense_index_][this->e1_v2_y_dense_index_] = -e1_diff_prod_to_quad_norm;
-
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_x_dense_index_][this->e2_v1_x_dense_index_] = e2_diff_prod_to_quad_norm;
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_x_dense_index_][this->e2_v1_y_dense_index_] = -e2_squares_diff_prod_to_quad_norm;
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_x_dense_index_][this->e2_v2_x_dense_index_] = -e2_diff_prod_to_quad_norm;
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_x_dense_index_][this->e2_v2_y_dense_index_] = e2_squares_diff_prod_to_quad_norm;
-
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_x_dense_index_][this->e2_v1_x_dense_index_] = e2_diff_prod_to_quad_norm;
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_x_dense_index_][this->e2_v1_y_dense_index_] = -e2_squares_diff_prod_to_quad_norm;
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_x_dense_index_][this->e2_v2_x_dense_index_] = -e2_diff_prod_to_quad_norm;
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_x_dense_index_][this->e2_v2_y_dense_index_] = e2_squares_diff_prod_to_quad_norm;
-
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_y_dense_index_][this->e2_v1_x_dense_index_] = e2_squares_diff_prod_to_quad_norm;
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_y_dense_index_][this->e2_v1_y_dense_index_] = e2_diff_prod_to_quad_norm;
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_y_dense_index_][this->e2_v2_x_dense_index_] = -e2_squares_diff_prod_to_quad_norm;
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_y_dense_index_][this->e2_v2_y_dense_index_] = -e2_diff_prod_to_quad_norm;
-
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_y_dense_index_][this->e2_v1_x_dense_index_] = e2_squares_diff_prod_to_quad_norm;
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_y_dense_index_][this->e2_v1_y_dense_index_] = e2_diff_prod_to_quad_norm;
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_y_dense_index_][this->e2_v2_x_dense_index_] = -e2_squares_diff_prod_to_quad_norm;
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_y_dense_index_][this->e2_v2_y_dense_index_] = -e2_diff_prod_to_quad_norm;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_x_dense_index_, this->e1_v1_x_dense_index_) = e1_diff_prod_to_quad_norm;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_x_dense_index_, this->e1_v1_y_dense_index_) = -e1_squares_diff_prod_to_quad_norm;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_x_dense_index_, this->e1_v2_x_dense_index_) = -e1_diff_prod_to_quad_norm;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_x_dense_index_, this->e1_v2_y_dense_index_) = e1_squares_diff_prod_to_quad_norm;
+
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_x_dense_index_, this->e1_v1_x_dense_index_) = e1_diff_prod_to_quad_norm;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_x_dense_index_, this->e1_v1_y_dense_index_) = -e1_squares_diff_prod_to_quad_norm;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_x_dense_index_, this->e1_v2_x_dense_index_) = -e1_diff_prod_to_quad_norm;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_x_dense_index_, this->e1_v2_y_dense_index_) = e1_squares_diff_prod_to_quad_norm;
+
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_y_dense_index_, this->e1_v1_x_dense_index_) = e1_squares_diff_prod_to_quad_norm;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_y_dense_index_, this->e1_v1_y_dense_index_) = e1_diff_prod_to_quad_norm;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_y_dense_index_, this->e1_v2_x_dense_index_) = -e1_squares_diff_prod_to_quad_norm;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_y_dense_index_, this->e1_v2_y_dense_index_) = -e1_diff_prod_to_quad_norm;
+
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_y_dense_index_, this->e1_v1_x_dense_index_) = e1_squares_diff_prod_to_quad_norm;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_y_dense_index_, this->e1_v1_y_dense_index_) = e1_diff_prod_to_quad_norm;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_y_dense_index_, this->e1_v2_x_dense_index_) = -e1_squares_diff_prod_to_quad_norm;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_y_dense_index_, this->e1_v2_y_dense_index_) = -e1_diff_prod_to_quad_norm;
+
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_x_dense_index_, this->e2_v1_x_dense_index_) = e2_diff_prod_to_quad_norm;
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_x_dense_index_, this->e2_v1_y_dense_index_) = -e2_squares_diff_prod_to_quad_norm;
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_x_dense_index_, this->e2_v2_x_dense_index_) = -e2_diff_prod_to_quad_norm;
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_x_dense_index_, this->e2_v2_y_dense_index_) = e2_squares_diff_prod_to_quad_norm;
+
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_x_dense_index_, this->e2_v1_x_dense_index_) = e2_diff_prod_to_quad_norm;
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_x_dense_index_, this->e2_v1_y_dense_index_) = -e2_squares_diff_prod_to_quad_norm;
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_x_dense_index_, this->e2_v2_x_dense_index_) = -e2_diff_prod_to_quad_norm;
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_x_dense_index_, this->e2_v2_y_dense_index_) = e2_squares_diff_prod_to_quad_norm;
+
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_y_dense_index_, this->e2_v1_x_dense_index_) = e2_squares_diff_prod_to_quad_norm;
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_y_dense_index_, this->e2_v1_y_dense_index_) = e2_diff_prod_to_quad_norm;
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_y_dense_index_, this->e2_v2_x_dense_index_) = -e2_squares_diff_prod_to_quad_norm;
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_y_dense_index_, this->e2_v2_y_dense_index_) = -e2_diff_prod_to_quad_norm;
+
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_y_dense_index_, this->e2_v1_x_dense_index_) = e2_squares_diff_prod_to_quad_norm;
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_y_dense_index_, this->e2_v1_y_dense_index_) = e2_diff_prod_to_quad_norm;
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_y_dense_index_, this->e2_v2_x_dense_index_) = -e2_squares_diff_prod_to_quad_norm;
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_y_dense_index_, this->e2_v2_y_dense_index_) = -e2_diff_prod_to_quad_norm;
 	}
 
 private:
 	/**
 	 * Private overrides
 	 */
-	void InitializeDenseIndexToFirstDerivativeSignMap(std::vector<double>& dense_index_to_first_derivative_sign_map) override
+	std::shared_ptr<UpdatableObject> CloneObject() const override
+	{
+		return std::make_shared<EdgePairAngleObjective>(*this);
+	}
+
+	void InitializeDenseIndexToFirstDerivativeSignMap(typename EdgePairObjective<StorageOrder_, ObjectiveVariablesCount_>::LocalVector& dense_index_to_first_derivative_sign_map) override
 	{
 		dense_index_to_first_derivative_sign_map[this->e1_v1_x_dense_index_] =  1;
 		dense_index_to_first_derivative_sign_map[this->e1_v1_y_dense_index_] = -1;
@@ -0,0 +1,683 @@
+#pragma once
+#ifndef OPTIMIZATION_LIB_EDGE_PAIR_FIELD_OBJECTIVE_H
+#define OPTIMIZATION_LIB_EDGE_PAIR_FIELD_OBJECTIVE_H
+
+// C includes
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+// STL includes
+#include <array>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+// Eigen includes
+#include <Eigen/Core>
+
+// Optimization lib includes
+#include "../../core/core.h"
+#include "../../core/psd_projection.h"
+#include "../../data_providers/empty_data_provider.h"
+#include "../dense_objective_function.h"
+#include "../periodic_objective.h"
+
+// All the seamless terms (periodic angle, length, translation and integer translation) of all the corresponding edge pairs, evaluated as a single objective.
+// The pairs are kept in structure-of-arrays form (one array per local variable / per quantity), so the per-pair quantities are computed by array expressions
+// and the local hessians are filled in one parallel loop, instead of going through a tree of per-pair objectives and data providers.
+//
+// The local variables of a pair are ordered as: e1_v1_x, e1_v1_y, e1_v2_x, e1_v2_y, e2_v1_x, e2_v1_y, e2_v2_x, e2_v2_y.
+//
+// The weights follow SeamlessObjective: the edge angle weight is the weight of the inner angle objective, which the periodic angle term reads unweighted,
+// so it is only kept (and reported); the edge length weight replaces the length weight of its pair; the values per edge are unweighted.
+template<Eigen::StorageOptions StorageOrder_>
+class EdgePairFieldObjective : public DenseObjectiveFunction<StorageOrder_>
+{
+public:
+	/**
+	 * Public type definitions
+	 */
+	static constexpr int ObjectiveVariablesCount = 8;
+	static constexpr int LocalTripletsCount = (ObjectiveVariablesCount * (ObjectiveVariablesCount + 1)) / 2;
+
+	using LocalVector = Eigen::Matrix<double, ObjectiveVariablesCount, 1>;
+	using LocalMatrix = Eigen::Matrix<double, ObjectiveVariablesCount, ObjectiveVariablesCount>;
+	using LocalGradients = Eigen::Matrix<double, Eigen::Dynamic, ObjectiveVariablesCount>;
+
+	enum class Properties : int32_t
+	{
+		AngleValuePerEdge = DenseObjectiveFunction<StorageOrder_>::Properties::Count_,
+		LengthValuePerEdge,
+		EdgeAngleWeight,
+		EdgeLengthWeight,
+		Interval
+	};
+
+	/**
+	 * Constructors and destructor
+	 */
+	EdgePairFieldObjective(const std::shared_ptr<MeshDataProvider>& mesh_data_provider, const std::shared_ptr<EmptyDataProvider>& empty_data_provider, const RDS::EdgePairDescriptors& edge_pair_descriptors, const bool enforce_psd = true) :
+		DenseObjectiveFunction(mesh_data_provider, empty_data_provider, "Edge Pair Field", 0, enforce_psd),
+		edge_pair_descriptors_(edge_pair_descriptors),
+		angle_weight_(100),
+		length_weight_(1),
+		translation_weight_(0),
+		integer_translation_weight_(1),
+		angle_period_(M_PI / 2),
+		interval_(1)
+	{
+		angle_polynomial_coeffs_ = PeriodicObjective<StorageOrder_>::CalculatePolynomialCoeffs(angle_period_);
+		interval_polynomial_coeffs_ = PeriodicObjective<StorageOrder_>::CalculatePolynomialCoeffs(interval_);
+		this->Initialize();
+	}
+
+	virtual ~EdgePairFieldObjective()
+	{
+
+	}
+
+	/**
+	 * Setters
+	 */
+	void SetAngleWeight(const double angle_weight)
+	{
+		angle_weight_ = angle_weight;
+		this->Invalidate();
+	}
+
+	void SetLengthWeight(const double length_weight)
+	{
+		length_weight_ = length_weight;
+		this->Invalidate();
+	}
+
+	void SetTranslationWeight(const double translation_weight)
+	{
+		translation_weight_ = translation_weight;
+		this->Invalidate();
+	}
+
+	void SetIntegerTranslationWeight(const double integer_translation_weight)
+	{
+		integer_translation_weight_ = integer_translation_weight;
+		this->Invalidate();
+	}
+
+	void SetInterval(const double interval)
+	{
+		interval_ = interval;
+		interval_polynomial_coeffs_ = PeriodicObjective<StorageOrder_>::CalculatePolynomialCoeffs(interval_);
+		this->Invalidate();
+	}
+
+	void SetEdgeAngleWeight(const RDS::EdgeIndex edge_index, const double weight)
+	{
+		for (std::size_t i = 0; i < domain_edge_indices_.size(); i++)
+		{
+			if (domain_edge_indices_[i] == edge_index)
+			{
+				edge_angle_weights_.coeffRef(i) = weight;
+			}
+		}
+
+		this->Invalidate();
+	}
+
+	// Weights by pair index (in the order of the edge pair descriptors)
+	void SetEdgeAngleWeights(const Eigen::ArrayXd& edge_angle_weights)
+	{
+		edge_angle_weights_ = edge_angle_weights;
+		this->Invalidate();
+	}
+
+	void SetEdgeLengthWeight(const RDS::EdgeIndex edge_index, const double weight)
+	{
+		for (std::size_t i = 0; i < domain_edge_indices_.size(); i++)
+		{
+			if (domain_edge_indices_[i] == edge_index)
+			{
+				edge_length_weights_.coeffRef(i) = weight;
+			}
+		}
+
+		this->Invalidate();
+	}
+
+	// Weights by pair index (in the order of the edge pair descriptors)
+	void SetEdgeLengthWeights(const Eigen::ArrayXd& edge_length_weights)
+	{
+		edge_length_weights_ = edge_length_weights;
+		this->Invalidate();
+	}
+
+	bool SetProperty(const int32_t property_id, const std::any property_context, const std::any property_value) override
+	{
+		if (DenseObjectiveFunction<StorageOrder_>::SetProperty(property_id, property_context, property_value))
+		{
+			return true;
+		}
+
+		const Properties properties = static_cast<Properties>(property_id);
+		switch (properties)
+		{
+		case Properties::EdgeAngleWeight:
+			SetEdgeAngleWeight(static_cast<RDS::EdgeIndex>(std::any_cast<double>(property_context)), std::any_cast<const double>(property_value));
+			return true;
+		case Properties::EdgeLengthWeight:
+			SetEdgeLengthWeight(static_cast<RDS::EdgeIndex>(std::any_cast<double>(property_context)), std::any_cast<const double>(property_value));
+			return true;
+		case Properties::Interval:
+			SetInterval(std::any_cast<const double>(property_value));
+			return true;
+		}
+
+		return false;
+	}
+
+	/**
+	 * Getters
+	 */
+	int64_t GetEdgePairsCount() const
+	{
+		return edge_pair_descriptors_.size();
+	}
+
+	double GetInterval() const
+	{
+		return interval_;
+	}
+
+	double GetEdgeAngleWeight(const RDS::EdgeIndex edge_index) const
+	{
+		for (std::size_t i = 0; i < domain_edge_indices_.size(); i++)
+		{
+			if (domain_edge_indices_[i] == edge_index)
+			{
+				return edge_angle_weights_.coeff(i);
+			}
+		}
+
+		return 0;
+	}
+
+	double GetEdgeLengthWeight(const RDS::EdgeIndex edge_index) const
+	{
+		for (std::size_t i = 0; i < domain_edge_indices_.size(); i++)
+		{
+			if (domain_edge_indices_[i] == edge_index)
+			{
+				return edge_length_weights_.coeff(i);
+			}
+		}
+
+		return 0;
+	}
+
+	const Eigen::ArrayXd& GetEdgeAngleWeights() const
+	{
+		return edge_angle_weights_;
+	}
+
+	const Eigen::ArrayXd& GetEdgeLengthWeights() const
+	{
+		return edge_length_weights_;
+	}
+
+	const Eigen::VectorXd& GetAngleValuePerEdge(const ObjectiveFunctionBase::PropertyModifiers property_modifiers) const
+	{
+		switch (property_modifiers)
+		{
+		case ObjectiveFunctionBase::PropertyModifiers::Domain:
+			return domain_angle_value_per_edge_;
+		default:
+			return image_angle_value_per_edge_;
+		}
+	}
+
+	const Eigen::VectorXd& GetLengthValuePerEdge(const ObjectiveFunctionBase::PropertyModifiers property_modifiers) const
+	{
+		switch (property_modifiers)
+		{
+		case ObjectiveFunctionBase::PropertyModifiers::Domain:
+			return domain_length_value_per_edge_;
+		default:
+			return image_length_value_per_edge_;
+		}
+	}
+
+	bool GetProperty(const int32_t property_id, const int32_t property_modifier_id, const std::any property_context, std::any& property_value) override
+	{
+		if (DenseObjectiveFunction<StorageOrder_>::GetProperty(property_id, property_modifier_id, property_context, property_value))
+		{
+			return true;
+		}
+
+		const ObjectiveFunctionBase::PropertyModifiers property_modifiers = static_cast<ObjectiveFunctionBase::PropertyModifiers>(property_modifier_id);
+		const Properties properties = static_cast<Properties>(property_id);
+		switch (properties)
+		{
+		case Properties::AngleValuePerEdge:
+			property_value = GetAngleValuePerEdge(property_modifiers);
+			return true;
+		case Properties::LengthValuePerEdge:
+			property_value = GetLengthValuePerEdge(property_modifiers);
+			return true;
+		case Properties::EdgeAngleWeight:
+			property_value = GetEdgeAngleWeight(static_cast<RDS::EdgeIndex>(std::any_cast<double>(property_context)));
+			return true;
+		case Properties::EdgeLengthWeight:
+			property_value = GetEdgeLengthWeight(static_cast<RDS::EdgeIndex>(std::any_cast<double>(property_context)));
+			return true;
+		case Properties::Interval:
+			property_value = GetInterval();
+			return true;
+		}
+
+		return false;
+	}
+
+private:
+	/**
+	 * Private overrides
+	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override
+	{
+		return std::make_shared<EdgePairFieldObjective>(*this);
+	}
+
+	void PreInitialize() override
+	{
+		const auto edge_pairs_count = edge_pair_descriptors_.size();
+		for (auto& variable_indices : variable_indices_)
+		{
+			variable_indices.resize(edge_pairs_count);
+		}
+
+		for (auto& vertex_indices : vertex_indices_)
+		{
+			vertex_indices.resize(edge_pairs_count);
+		}
+
+		domain_edge_indices_.resize(edge_pairs_count);
+		image_edge_1_indices_.resize(edge_pairs_count);
+		image_edge_2_indices_.resize(edge_pairs_count);
+
+		for (std::size_t i = 0; i < edge_pairs_count; i++)
+		{
+			const auto& edge_pair_descriptor = edge_pair_descriptors_[i];
+			vertex_indices_[0][i] = edge_pair_descriptor.first.first;
+			vertex_indices_[1][i] = edge_pair_descriptor.first.second;
+			vertex_indices_[2][i] = edge_pair_descriptor.second.first;
+			vertex_indices_[3][i] = edge_pair_descriptor.second.second;
+
+			for (int j = 0; j < 4; j++)
+			{
+				variable_indices_[2 * j][i] = this->mesh_data_provider_->GetXVariableIndex(vertex_indices_[j][i]);
+				variable_indices_[2 * j + 1][i] = this->mesh_data_provider_->GetYVariableIndex(vertex_indices_[j][i]);
+			}
+
+			domain_edge_indices_[i] = this->mesh_data_provider_->GetDomainEdgeIndex(edge_pair_descriptor.first);
+			image_edge_1_indices_[i] = this->mesh_data_provider_->GetImageEdgeIndex(edge_pair_descriptor.first);
+			image_edge_2_indices_[i] = this->mesh_data_provider_->GetImageEdgeIndex(edge_pair_descriptor.second);
+		}
+
+		// Weights that were already set survive a re-initialization
+		if (edge_angle_weights_.size() != static_cast<Eigen::Index>(edge_pairs_count))
+		{
+			edge_angle_weights_ = Eigen::ArrayXd::Ones(edge_pairs_count);
+		}
+
+		if (edge_length_weights_.size() != static_cast<Eigen::Index>(edge_pairs_count))
+		{
+			edge_length_weights_ = Eigen::ArrayXd::Ones(edge_pairs_count);
+		}
+
+		edge1_x_.resize(edge_pairs_count);
+		edge1_y_.resize(edge_pairs_count);
+		edge2_x_.resize(edge_pairs_count);
+		edge2_y_.resize(edge_pairs_count);
+		vertex_diffs_.resize(edge_pairs_count, 4);
+		angle_outer_first_derivative_.resize(edge_pairs_count);
+		angle_outer_second_derivative_.resize(edge_pairs_count);
+		integer_translation_first_derivatives_.resize(edge_pairs_count, 4);
+		integer_translation_second_derivatives_.resize(edge_pairs_count, 4);
+		angle_value_per_pair_.resize(edge_pairs_count);
+		length_value_per_pair_.resize(edge_pairs_count);
+		translation_value_per_pair_.resize(edge_pairs_count);
+		local_gradients_.resize(edge_pairs_count, ObjectiveVariablesCount);
+	}
+
+	void PostInitialize() override
+	{
+		DenseObjectiveFunction<StorageOrder_>::PostInitialize();
+		image_angle_value_per_edge_.resize(this->mesh_data_provider_->GetImageEdgesCount());
+		image_length_value_per_edge_.resize(this->mesh_data_provider_->GetImageEdgesCount());
+		domain_angle_value_per_edge_.resize(this->mesh_data_provider_->GetDomainEdgesCount());
+		domain_length_value_per_edge_.resize(this->mesh_data_provider_->GetDomainEdgesCount());
+	}
+
+	void InitializeTriplets(std::vector<Eigen::Triplet<double>>& triplets) override
+	{
+		// Each pair owns LocalTripletsCount consecutive triplets, holding the upper triangle of its 8x8 hessian, column by column.
+		// Entries are stored with row <= column in terms of the sparse indices, so a local (row, column) entry may land on its transposed position.
+		const auto edge_pairs_count = edge_pair_descriptors_.size();
+		triplets.resize(LocalTripletsCount * edge_pairs_count);
+		for (std::size_t i = 0; i < edge_pairs_count; i++)
+		{
+			auto triplet_index = LocalTripletsCount * i;
+			for (int column = 0; column < ObjectiveVariablesCount; column++)
+			{
+				for (int row = 0; row <= column; row++)
+				{
+					const auto row_variable_index = variable_indices_[row][i];
+					const auto column_variable_index = variable_indices_[column][i];
+					triplets[triplet_index++] = Eigen::Triplet<double>(std::min(row_variable_index, column_variable_index), std::max(row_variable_index, column_variable_index), 0);
+				}
+			}
+		}
+	}
+
+	void PreUpdate(const Eigen::VectorXd& x) override
+	{
+		const long edge_pairs_count = edge_pair_descriptors_.size();
+
+		#pragma omp parallel for
+		for (long i = 0; i < edge_pairs_count; i++)
+		{
+			const double e1_v1_x = x.coeff(variable_indices_[0][i]);
+			const double e1_v1_y = x.coeff(variable_indices_[1][i]);
+			const double e1_v2_x = x.coeff(variable_indices_[2][i]);
+			const double e1_v2_y = x.coeff(variable_indices_[3][i]);
+			const double e2_v1_x = x.coeff(variable_indices_[4][i]);
+			const double e2_v1_y = x.coeff(variable_indices_[5][i]);
+			const double e2_v2_x = x.coeff(variable_indices_[6][i]);
+			const double e2_v2_y = x.coeff(variable_indices_[7][i]);
+
+			edge1_x_.coeffRef(i) = e1_v2_x - e1_v1_x;
+			edge1_y_.coeffRef(i) = e1_v2_y - e1_v1_y;
+			edge2_x_.coeffRef(i) = e2_v2_x - e2_v1_x;
+			edge2_y_.coeffRef(i) = e2_v2_y - e2_v1_y;
+
+			vertex_diffs_.coeffRef(i, 0) = e1_v1_x - e2_v1_x;
+			vertex_diffs_.coeffRef(i, 1) = e1_v1_y - e2_v1_y;
+			vertex_diffs_.coeffRef(i, 2) = e1_v2_x - e2_v2_x;
+			vertex_diffs_.coeffRef(i, 3) = e1_v2_y - e2_v2_y;
+
+			double value;
+			const double angle = std::atan2(edge1_y_.coeff(i), edge1_x_.coeff(i)) - std::atan2(edge2_y_.coeff(i), edge2_x_.coeff(i)) + M_PI;
+			PeriodicObjective<StorageOrder_>::CalculatePolynomialDerivatives(angle, angle_period_, angle_polynomial_coeffs_, value, angle_outer_first_derivative_.coeffRef(i), angle_outer_second_derivative_.coeffRef(i));
+			angle_value_per_pair_.coeffRef(i) = value;
+
+			double integer_translation_value = 0;
+			for (int j = 0; j < 4; j++)
+			{
+				PeriodicObjective<StorageOrder_>::CalculatePolynomialDerivatives(vertex_diffs_.coeff(i, j), interval_, interval_polynomial_coeffs_, value, integer_translation_first_derivatives_.coeffRef(i, j), integer_translation_second_derivatives_.coeffRef(i, j));
+				integer_translation_value += value;
+			}
+
+			translation_value_per_pair_.coeffRef(i) = integer_translation_weight_ * integer_translation_value;
+		}
+
+		edge1_squared_norm_ = edge1_x_.square() + edge1_y_.square();
+		edge2_squared_norm_ = edge2_x_.square() + edge2_y_.square();
+		squared_norm_diff_ = edge1_squared_norm_ - edge2_squared_norm_;
+		translation_x_ = vertex_diffs_.col(0) - vertex_diffs_.col(2);
+		translation_y_ = vertex_diffs_.col(1) - vertex_diffs_.col(3);
+
+		// The angle and length values are kept unweighted (they are also the values per edge)
+		length_value_per_pair_ = squared_norm_diff_.square();
+		translation_value_per_pair_ += translation_weight_ * (translation_x_.square() + translation_y_.square());
+		value_per_pair_ = angle_weight_ * angle_value_per_pair_ + length_weight_ * edge_length_weights_ * length_value_per_pair_ + translation_value_per_pair_;
+	}
+
+	void CalculateValue(double& f) override
+	{
+		f = value_per_pair_.sum();
+	}
+
+	void CalculateValuePerVertex(Eigen::VectorXd& f_per_vertex) override
+	{
+		f_per_vertex.setZero();
+		const auto edge_pairs_count = edge_pair_descriptors_.size();
+		for (std::size_t i = 0; i < edge_pairs_count; i++)
+		{
+			const double value = value_per_pair_.coeff(i);
+			for (const auto& vertex_indices : vertex_indices_)
+			{
+				f_per_vertex.coeffRef(vertex_indices[i]) += value;
+			}
+		}
+	}
+
+	void CalculateValuePerEdge(Eigen::VectorXd& domain_value_per_edge, Eigen::VectorXd& image_value_per_edge) override
+	{
+		domain_angle_value_per_edge_.setZero();
+		image_angle_value_per_edge_.setZero();
+		domain_length_value_per_edge_.setZero();
+		image_length_value_per_edge_.setZero();
+
+		const auto edge_pairs_count = edge_pair_descriptors_.size();
+		for (std::size_t i = 0; i < edge_pairs_count; i++)
+		{
+			const double angle_value = angle_value_per_pair_.coeff(i);
+			domain_angle_value_per_edge_.coeffRef(domain_edge_indices_[i]) += angle_value;
+			image_angle_value_per_edge_.coeffRef(image_edge_1_indices_[i]) += angle_value;
+			image_angle_value_per_edge_.coeffRef(image_edge_2_indices_[i]) += angle_value;
+
+			const double length_value = length_value_per_pair_.coeff(i);
+			domain_length_value_per_edge_.coeffRef(domain_edge_indices_[i]) += length_value;
+			image_length_value_per_edge_.coeffRef(image_edge_1_indices_[i]) += length_value;
+			image_length_value_per_edge_.coeffRef(image_edge_2_indices_[i]) += length_value;
+		}
+
+		domain_value_per_edge = domain_angle_value_per_edge_ + domain_length_value_per_edge_;
+		image_value_per_edge = image_angle_value_per_edge_ + image_length_value_per_edge_;
+	}
+
+	void CalculateGradient(Eigen::VectorXd& g) override
+	{
+		// Local gradients, one column per local variable (see the variable order at the top of this file)
+		const Eigen::ArrayXd angle_factor = angle_weight_ * angle_outer_first_derivative_;
+		const Eigen::ArrayXd angle_factor1 = angle_factor / edge1_squared_norm_;
+		const Eigen::ArrayXd angle_factor2 = angle_factor / edge2_squared_norm_;
+		const Eigen::ArrayXd length_factor = 4 * length_weight_ * edge_length_weights_ * squared_norm_diff_;
+		const Eigen::ArrayXd translation_x_factor = 2 * translation_weight_ * translation_x_;
+		const Eigen::ArrayXd translation_y_factor = 2 * translation_weight_ * translation_y_;
+		const Eigen::ArrayXXd integer_translation_factor = integer_translation_weight_ * integer_translation_first_derivatives_;
+
+		local_gradients_.col(0) = (angle_factor1 * edge1_y_ - length_factor * edge1_x_ + translation_x_factor + integer_translation_factor.col(0)).matrix();
+		local_gradients_.col(1) = (-angle_factor1 * edge1_x_ - length_factor * edge1_y_ + translation_y_factor + integer_translation_factor.col(1)).matrix();
+		local_gradients_.col(2) = (-angle_factor1 * edge1_y_ + length_factor * edge1_x_ - translation_x_factor + integer_translation_factor.col(2)).matrix();
+		local_gradients_.col(3) = (angle_factor1 * edge1_x_ + length_factor * edge1_y_ - translation_y_factor + integer_translation_factor.col(3)).matrix();
+		local_gradients_.col(4) = (-angle_factor2 * edge2_y_ + length_factor * edge2_x_ - translation_x_factor - integer_translation_factor.col(0)).matrix();
+		local_gradients_.col(5) = (angle_factor2 * edge2_x_ + length_factor * edge2_y_ - translation_y_factor - integer_translation_factor.col(1)).matrix();
+		local_gradients_.col(6) = (angle_factor2 * edge2_y_ - length_factor * edge2_x_ + translation_x_factor - integer_translation_factor.col(2)).matrix();
+		local_gradients_.col(7) = (-angle_factor2 * edge2_x_ - length_factor * edge2_y_ + translation_y_factor - integer_translation_factor.col(3)).matrix();
+
+		// Pairs share vertices, so the scatter is kept serial
+		g.setZero();
+		const auto edge_pairs_count = edge_pair_descriptors_.size();
+		for (int j = 0; j < ObjectiveVariablesCount; j++)
+		{
+			const auto& variable_indices = variable_indices_[j];
+			for (std::size_t i = 0; i < edge_pairs_count; i++)
+			{
+				g.coeffRef(variable_indices[i]) += local_gradients_.coeff(i, j);
+			}
+		}
+	}
+
+	void CalculateRawTriplets(const TripletsView& triplets) override
+	{
+		const long edge_pairs_count = edge_pair_descriptors_.size();
+		const bool enforce_psd = this->GetEnforcePsd();
+
+		#pragma omp parallel for
+		for (long i = 0; i < edge_pairs_count; i++)
+		{
+			LocalMatrix H;
+			CalculateLocalHessian(i, enforce_psd, H);
+
+			auto triplet_index = LocalTripletsCount * i;
+			for (int column = 0; column < ObjectiveVariablesCount; column++)
+			{
+				for (int row = 0; row <= column; row++)
+				{
+					// An off-diagonal local entry that falls on the global diagonal (a vertex shared by both edges) stands for both of its symmetric halves
+					auto& triplet = triplets[triplet_index++];
+					const double value = H.coeff(row, column);
+					const_cast<double&>(triplet.value()) = (row != column && triplet.row() == triplet.col()) ? 2 * value : value;
+				}
+			}
+		}
+	}
+
+	/**
+	 * Private methods
+	 */
+	// Adds sign * D^T * M * D, where D maps the 4 local variables of an edge (v1_x, v1_y, v2_x, v2_y) onto the edge vector (v2 - v1)
+	static void AddEdgeBlock(LocalMatrix& H, const int offset, const Eigen::Matrix2d& M)
+	{
+		H.template block<2, 2>(offset, offset) += M;
+		H.template block<2, 2>(offset, offset + 2) -= M;
+		H.template block<2, 2>(offset + 2, offset) -= M;
+		H.template block<2, 2>(offset + 2, offset + 2) += M;
+	}
+
+	void CalculateLocalHessian(const long i, const bool enforce_psd, LocalMatrix& H) const
+	{
+		const double e1_x = edge1_x_.coeff(i);
+		const double e1_y = edge1_y_.coeff(i);
+		const double e2_x = edge2_x_.coeff(i);
+		const double e2_y = edge2_y_.coeff(i);
+		const double e1_squared_norm = edge1_squared_norm_.coeff(i);
+		const double e2_squared_norm = edge2_squared_norm_.coeff(i);
+
+		/**
+		 * Periodic angle term (the composite hessian is projected on its own, like the periodic objective it replaces)
+		 */
+		LocalVector angle_gradient;
+		angle_gradient << e1_y / e1_squared_norm, -e1_x / e1_squared_norm, -e1_y / e1_squared_norm, e1_x / e1_squared_norm, -e2_y / e2_squared_norm, e2_x / e2_squared_norm, e2_y / e2_squared_norm, -e2_x / e2_squared_norm;
+
+		Eigen::Matrix2d atan2_hessian1;
+		atan2_hessian1 << 2 * e1_x * e1_y, e1_y * e1_y - e1_x * e1_x, e1_y * e1_y - e1_x * e1_x, -2 * e1_x * e1_y;
+		atan2_hessian1 /= e1_squared_norm * e1_squared_norm;
+
+		Eigen::Matrix2d atan2_hessian2;
+		atan2_hessian2 << 2 * e2_x * e2_y, e2_y * e2_y - e2_x * e2_x, e2_y * e2_y - e2_x * e2_x, -2 * e2_x * e2_y;
+		atan2_hessian2 /= e2_squared_norm * e2_squared_norm;
+
+		const double angle_first_derivative = angle_outer_first_derivative_.coeff(i);
+		H.setZero();
+		AddEdgeBlock(H, 0, angle_first_derivative * atan2_hessian1);
+		AddEdgeBlock(H, 4, -angle_first_derivative * atan2_hessian2);
+		H += angle_outer_second_derivative_.coeff(i) * angle_gradient * angle_gradient.transpose();
+
+		if (enforce_psd)
+		{
+			PsdProjection<ObjectiveVariablesCount>::Project(H);
+		}
+
+		H *= angle_weight_;
+
+		/**
+		 * Length term
+		 */
+		LocalVector squared_norm_diff_gradient;
+		squared_norm_diff_gradient << -2 * e1_x, -2 * e1_y, 2 * e1_x, 2 * e1_y, 2 * e2_x, 2 * e2_y, -2 * e2_x, -2 * e2_y;
+
+		const double length_weight = length_weight_ * edge_length_weights_.coeff(i);
+		const double length_factor = 4 * length_weight * squared_norm_diff_.coeff(i);
+		H += (2 * length_weight) * squared_norm_diff_gradient * squared_norm_diff_gradient.transpose();
+		AddEdgeBlock(H, 0, length_factor * Eigen::Matrix2d::Identity());
+		AddEdgeBlock(H, 4, -length_factor * Eigen::Matrix2d::Identity());
+
+		/**
+		 * Translation and integer translation terms (each vertex diff d_j = x[j] - x[j + 4] contributes along s_j = e_j - e_(j + 4))
+		 */
+		for (int j = 0; j < 4; j++)
+		{
+			double second_derivative = integer_translation_second_derivatives_.coeff(i, j);
+			if (enforce_psd && second_derivative < 0)
+			{
+				// s_j * s_j^T has the eigenvalues 2 and 0, so the projected eigenvalue (10e-8) is spread over the factor 2
+				second_derivative = 10e-8 / 2;
+			}
+
+			const double value = integer_translation_weight_ * second_derivative;
+			H.coeffRef(j, j) += value;
+			H.coeffRef(j + 4, j + 4) += value;
+			H.coeffRef(j, j + 4) -= value;
+			H.coeffRef(j + 4, j) -= value;
+		}
+
+		// translation_x = d_0 - d_2 and translation_y = d_1 - d_3
+		const double translation_value = 2 * translation_weight_;
+		for (int j = 0; j < 2; j++)
+		{
+			LocalVector translation_gradient = LocalVector::Zero();
+			translation_gradient.coeffRef(j) = 1;
+			translation_gradient.coeffRef(j + 4) = -1;
+			translation_gradient.coeffRef(j + 2) = -1;
+			translation_gradient.coeffRef(j + 6) = 1;
+			H += translation_value * translation_gradient * translation_gradient.transpose();
+		}
+	}
+
+	/**
+	 * Fields
+	 */
+	RDS::EdgePairDescriptors edge_pair_descriptors_;
+
+	// Term weights
+	double angle_weight_;
+	double length_weight_;
+	double translation_weight_;
+	double integer_translation_weight_;
+
+	// Periods
+	double angle_period_;
+	double interval_;
+	Eigen::VectorXd angle_polynomial_coeffs_;
+	Eigen::VectorXd interval_polynomial_coeffs_;
+
+	// Per pair indices (structure of arrays)
+	std::array<std::vector<RDS::SparseVariableIndex>, ObjectiveVariablesCount> variable_indices_;
+	std::array<std::vector<RDS::VertexIndex>, 4> vertex_indices_;
+	std::vector<RDS::EdgeIndex> domain_edge_indices_;
+	std::vector<RDS::EdgeIndex> image_edge_1_indices_;
+	std::vector<RDS::EdgeIndex> image_edge_2_indices_;
+
+	// Per pair weights
+	Eigen::ArrayXd edge_angle_weights_;
+	Eigen::ArrayXd edge_length_weights_;
+
+	// Per pair quantities (structure of arrays)
+	Eigen::ArrayXd edge1_x_;
+	Eigen::ArrayXd edge1_y_;
+	Eigen::ArrayXd edge2_x_;
+	Eigen::ArrayXd edge2_y_;
+	Eigen::ArrayXd edge1_squared_norm_;
+	Eigen::ArrayXd edge2_squared_norm_;
+	Eigen::ArrayXd squared_norm_diff_;
+	Eigen::ArrayXXd vertex_diffs_;
+	Eigen::ArrayXd translation_x_;
+	Eigen::ArrayXd translation_y_;
+	Eigen::ArrayXd angle_outer_first_derivative_;
+	Eigen::ArrayXd angle_outer_second_derivative_;
+	Eigen::ArrayXXd integer_translation_first_derivatives_;
+	Eigen::ArrayXXd integer_translation_second_derivatives_;
+	Eigen::ArrayXd angle_value_per_pair_;
+	Eigen::ArrayXd length_value_per_pair_;
+	Eigen::ArrayXd translation_value_per_pair_;
+	Eigen::ArrayXd value_per_pair_;
+	LocalGradients local_gradients_;
+
+	// Values per edge
+	Eigen::VectorXd image_angle_value_per_edge_;
+	Eigen::VectorXd image_length_value_per_edge_;
+	Eigen::VectorXd domain_angle_value_per_edge_;
+	Eigen::VectorXd domain_length_value_per_edge_;
+};
+
+#endif
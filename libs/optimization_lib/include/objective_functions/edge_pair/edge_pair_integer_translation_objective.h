@@ -53,8 +53,29 @@ public:
 	/**
 	 * Public overrides
 	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override
+	{
+		return std::make_shared<EdgePairIntegerTranslationObjective>(*this);
+	}
+
+	void RemapDependencies(const UpdatableObject::CloneMap& clones) override
+	{
+		SummationObjective<PeriodicObjective<StorageOrder_>, Eigen::SparseVector<double>>::RemapDependencies(clones);
+		for (auto& periodic_objective : periodic_objectives)
+		{
+			periodic_objective = UpdatableObject::Remap(periodic_objective, clones);
+		}
+	}
+
+	// The periodic coordinate diff objectives are built once (Initialize is called again by the parents of this objective)
 	void PreInitialize() override
 	{
+		if (!periodic_objectives.empty())
+		{
+			SummationObjective<PeriodicObjective<StorageOrder_>, Eigen::SparseVector<double>>::PreInitialize();
+			return;
+		}
+
 		auto edge_pair_data_provider = std::dynamic_pointer_cast<EdgePairDataProvider>(this->data_provider_);
 		auto empty_data_provider = std::make_shared<EmptyDataProvider>(this->GetMeshDataProvider());
 
@@ -6,8 +6,8 @@
 #include "../../data_providers/edge_pair_data_provider.h"
 #include "./edge_pair_objective.h"
 
-template<Eigen::StorageOptions StorageOrder_>
-class EdgePairLengthObjective : public EdgePairObjective<StorageOrder_>
+template<Eigen::StorageOptions StorageOrder_, int ObjectiveVariablesCount_ = 8>
+class EdgePairLengthObjective : public EdgePairObjective<StorageOrder_, ObjectiveVariablesCount_>
 {
 public:
 	/**
@@ -28,6 +28,11 @@ protected:
 	/**
 	 * Protected overrides
 	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override
+	{
+		return std::make_shared<EdgePairLengthObjective>(*this);
+	}
+
 	void PreUpdate(const Eigen::VectorXd& x) override
 	{
 		auto& edge_pair_data_provider = this->GetEdgePairDataProvider();
@@ -87,84 +92,84 @@ protected:
 		/**
 		 * Second partial derivatives
 		 */
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_x_dense_index_][this->e1_v1_x_dense_index_] = d_edge1_v1_d_edge1_v1(0, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_x_dense_index_][this->e1_v1_y_dense_index_] = d_edge1_v1_d_edge1_v1(0, 1);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_x_dense_index_][this->e1_v2_x_dense_index_] = d_edge1_v1_d_edge1_v2(0, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_x_dense_index_][this->e1_v2_y_dense_index_] = d_edge1_v1_d_edge1_v2(0, 1);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_x_dense_index_][this->e2_v1_x_dense_index_] = d_edge1_v1_d_edge2_v1(0, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_x_dense_index_][this->e2_v1_y_dense_index_] = d_edge1_v1_d_edge2_v1(0, 1);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_x_dense_index_][this->e2_v2_x_dense_index_] = d_edge1_v1_d_edge2_v2(0, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_x_dense_index_][this->e2_v2_y_dense_index_] = d_edge1_v1_d_edge2_v2(0, 1);
-
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_x_dense_index_][this->e1_v1_x_dense_index_] = d_edge1_v2_d_edge1_v1(0, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_x_dense_index_][this->e1_v1_y_dense_index_] = d_edge1_v2_d_edge1_v1(0, 1);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_x_dense_index_][this->e1_v2_x_dense_index_] = d_edge1_v2_d_edge1_v2(0, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_x_dense_index_][this->e1_v2_y_dense_index_] = d_edge1_v2_d_edge1_v2(0, 1);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_x_dense_index_][this->e2_v1_x_dense_index_] = d_edge1_v2_d_edge2_v1(0, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_x_dense_index_][this->e2_v1_y_dense_index_] = d_edge1_v2_d_edge2_v1(0, 1);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_x_dense_index_][this->e2_v2_x_dense_index_] = d_edge1_v2_d_edge2_v2(0, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_x_dense_index_][this->e2_v2_y_dense_index_] = d_edge1_v2_d_edge2_v2(0, 1);
-
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_y_dense_index_][this->e1_v1_x_dense_index_] = d_edge1_v1_d_edge1_v1(1, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_y_dense_index_][this->e1_v1_y_dense_index_] = d_edge1_v1_d_edge1_v1(1, 1);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_y_dense_index_][this->e1_v2_x_dense_index_] = d_edge1_v1_d_edge1_v2(1, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_y_dense_index_][this->e1_v2_y_dense_index_] = d_edge1_v1_d_edge1_v2(1, 1);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_y_dense_index_][this->e2_v1_x_dense_index_] = d_edge1_v1_d_edge2_v1(1, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_y_dense_index_][this->e2_v1_y_dense_index_] = d_edge1_v1_d_edge2_v1(1, 1);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_y_dense_index_][this->e2_v2_x_dense_index_] = d_edge1_v1_d_edge2_v2(1, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_y_dense_index_][this->e2_v2_y_dense_index_] = d_edge1_v1_d_edge2_v2(1, 1);
-
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_y_dense_index_][this->e1_v1_x_dense_index_] = d_edge1_v2_d_edge1_v1(1, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_y_dense_index_][this->e1_v1_y_dense_index_] = d_edge1_v2_d_edge1_v1(1, 1);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_y_dense_index_][this->e1_v2_x_dense_index_] = d_edge1_v2_d_edge1_v2(1, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_y_dense_index_][this->e1_v2_y_dense_index_] = d_edge1_v2_d_edge1_v2(1, 1);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_y_dense_index_][this->e2_v1_x_dense_index_] = d_edge1_v2_d_edge2_v1(1, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_y_dense_index_][this->e2_v1_y_dense_index_] = d_edge1_v2_d_edge2_v1(1, 1);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_y_dense_index_][this->e2_v2_x_dense_index_] = d_edge1_v2_d_edge2_v2(1, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_y_dense_index_][this->e2_v2_y_dense_index_] = d_edge1_v2_d_edge2_v2(1, 1);
-
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_x_dense_index_][this->e1_v1_x_dense_index_] = d_edge2_v1_d_edge1_v1(0, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_x_dense_index_][this->e1_v1_y_dense_index_] = d_edge2_v1_d_edge1_v1(0, 1);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_x_dense_index_][this->e1_v2_x_dense_index_] = d_edge2_v1_d_edge1_v2(0, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_x_dense_index_][this->e1_v2_y_dense_index_] = d_edge2_v1_d_edge1_v2(0, 1);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_x_dense_index_][this->e2_v1_x_dense_index_] = d_edge2_v1_d_edge2_v1(0, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_x_dense_index_][this->e2_v1_y_dense_index_] = d_edge2_v1_d_edge2_v1(0, 1);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_x_dense_index_][this->e2_v2_x_dense_index_] = d_edge2_v1_d_edge2_v2(0, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_x_dense_index_][this->e2_v2_y_dense_index_] = d_edge2_v1_d_edge2_v2(0, 1);
-
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_x_dense_index_][this->e1_v1_x_dense_index_] = d_edge2_v2_d_edge1_v1(0, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_x_dense_index_][this->e1_v1_y_dense_index_] = d_edge2_v2_d_edge1_v1(0, 1);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_x_dense_index_][this->e1_v2_x_dense_index_] = d_edge2_v2_d_edge1_v2(0, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_x_dense_index_][this->e1_v2_y_dense_index_] = d_edge2_v2_d_edge1_v2(0, 1);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_x_dense_index_][this->e2_v1_x_dense_index_] = d_edge2_v2_d_edge2_v1(0, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_x_dense_index_][this->e2_v1_y_dense_index_] = d_edge2_v2_d_edge2_v1(0, 1);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_x_dense_index_][this->e2_v2_x_dense_index_] = d_edge2_v2_d_edge2_v2(0, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_x_dense_index_][this->e2_v2_y_dense_index_] = d_edge2_v2_d_edge2_v2(0, 1);
-
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_y_dense_index_][this->e1_v1_x_dense_index_] = d_edge2_v1_d_edge1_v1(1, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_y_dense_index_][this->e1_v1_y_dense_index_] = d_edge2_v1_d_edge1_v1(1, 1);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_y_dense_index_][this->e1_v2_x_dense_index_] = d_edge2_v1_d_edge1_v2(1, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_y_dense_index_][this->e1_v2_y_dense_index_] = d_edge2_v1_d_edge1_v2(1, 1);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_y_dense_index_][this->e2_v1_x_dense_index_] = d_edge2_v1_d_edge2_v1(1, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_y_dense_index_][this->e2_v1_y_dense_index_] = d_edge2_v1_d_edge2_v1(1, 1);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_y_dense_index_][this->e2_v2_x_dense_index_] = d_edge2_v1_d_edge2_v2(1, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_y_dense_index_][this->e2_v2_y_dense_index_] = d_edge2_v1_d_edge2_v2(1, 1);
-
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_y_dense_index_][this->e1_v1_x_dense_index_] = d_edge2_v2_d_edge1_v1(1, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_y_dense_index_][this->e1_v1_y_dense_index_] = d_edge2_v2_d_edge1_v1(1, 1);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_y_dense_index_][this->e1_v2_x_dense_index_] = d_edge2_v2_d_edge1_v2(1, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_y_dense_index_][this->e1_v2_y_dense_index_] = d_edge2_v2_d_edge1_v2(1, 1);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_y_dense_index_][this->e2_v1_x_dense_index_] = d_edge2_v2_d_edge2_v1(1, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_y_dense_index_][this->e2_v1_y_dense_index_] = d_edge2_v2_d_edge2_v1(1, 1);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_y_dense_index_][this->e2_v2_x_dense_index_] = d_edge2_v2_d_edge2_v2(1, 0);
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_y_dense_index_][this->e2_v2_y_dense_index_] = d_edge2_v2_d_edge2_v2(1, 1);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_x_dense_index_, this->e1_v1_x_dense_index_) = d_edge1_v1_d_edge1_v1(0, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_x_dense_index_, this->e1_v1_y_dense_index_) = d_edge1_v1_d_edge1_v1(0, 1);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_x_dense_index_, this->e1_v2_x_dense_index_) = d_edge1_v1_d_edge1_v2(0, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_x_dense_index_, this->e1_v2_y_dense_index_) = d_edge1_v1_d_edge1_v2(0, 1);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_x_dense_index_, this->e2_v1_x_dense_index_) = d_edge1_v1_d_edge2_v1(0, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_x_dense_index_, this->e2_v1_y_dense_index_) = d_edge1_v1_d_edge2_v1(0, 1);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_x_dense_index_, this->e2_v2_x_dense_index_) = d_edge1_v1_d_edge2_v2(0, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_x_dense_index_, this->e2_v2_y_dense_index_) = d_edge1_v1_d_edge2_v2(0, 1);
+
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_x_dense_index_, this->e1_v1_x_dense_index_) = d_edge1_v2_d_edge1_v1(0, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_x_dense_index_, this->e1_v1_y_dense_index_) = d_edge1_v2_d_edge1_v1(0, 1);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_x_dense_index_, this->e1_v2_x_dense_index_) = d_edge1_v2_d_edge1_v2(0, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_x_dense_index_, this->e1_v2_y_dense_index_) = d_edge1_v2_d_edge1_v2(0, 1);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_x_dense_index_, this->e2_v1_x_dense_index_) = d_edge1_v2_d_edge2_v1(0, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_x_dense_index_, this->e2_v1_y_dense_index_) = d_edge1_v2_d_edge2_v1(0, 1);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_x_dense_index_, this->e2_v2_x_dense_index_) = d_edge1_v2_d_edge2_v2(0, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_x_dense_index_, this->e2_v2_y_dense_index_) = d_edge1_v2_d_edge2_v2(0, 1);
+
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_y_dense_index_, this->e1_v1_x_dense_index_) = d_edge1_v1_d_edge1_v1(1, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_y_dense_index_, this->e1_v1_y_dense_index_) = d_edge1_v1_d_edge1_v1(1, 1);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_y_dense_index_, this->e1_v2_x_dense_index_) = d_edge1_v1_d_edge1_v2(1, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_y_dense_index_, this->e1_v2_y_dense_index_) = d_edge1_v1_d_edge1_v2(1, 1);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_y_dense_index_, this->e2_v1_x_dense_index_) = d_edge1_v1_d_edge2_v1(1, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_y_dense_index_, this->e2_v1_y_dense_index_) = d_edge1_v1_d_edge2_v1(1, 1);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_y_dense_index_, this->e2_v2_x_dense_index_) = d_edge1_v1_d_edge2_v2(1, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_y_dense_index_, this->e2_v2_y_dense_index_) = d_edge1_v1_d_edge2_v2(1, 1);
+
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_y_dense_index_, this->e1_v1_x_dense_index_) = d_edge1_v2_d_edge1_v1(1, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_y_dense_index_, this->e1_v1_y_dense_index_) = d_edge1_v2_d_edge1_v1(1, 1);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_y_dense_index_, this->e1_v2_x_dense_index_) = d_edge1_v2_d_edge1_v2(1, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_y_dense_index_, this->e1_v2_y_dense_index_) = d_edge1_v2_d_edge1_v2(1, 1);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_y_dense_index_, this->e2_v1_x_dense_index_) = d_edge1_v2_d_edge2_v1(1, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_y_dense_index_, this->e2_v1_y_dense_index_) = d_edge1_v2_d_edge2_v1(1, 1);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_y_dense_index_, this->e2_v2_x_dense_index_) = d_edge1_v2_d_edge2_v2(1, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_y_dense_index_, this->e2_v2_y_dense_index_) = d_edge1_v2_d_edge2_v2(1, 1);
+
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_x_dense_index_, this->e1_v1_x_dense_index_) = d_edge2_v1_d_edge1_v1(0, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_x_dense_index_, this->e1_v1_y_dense_index_) = d_edge2_v1_d_edge1_v1(0, 1);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_x_dense_index_, this->e1_v2_x_dense_index_) = d_edge2_v1_d_edge1_v2(0, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_x_dense_index_, this->e1_v2_y_dense_index_) = d_edge2_v1_d_edge1_v2(0, 1);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_x_dense_index_, this->e2_v1_x_dense_index_) = d_edge2_v1_d_edge2_v1(0, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_x_dense_index_, this->e2_v1_y_dense_index_) = d_edge2_v1_d_edge2_v1(0, 1);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_x_dense_index_, this->e2_v2_x_dense_index_) = d_edge2_v1_d_edge2_v2(0, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_x_dense_index_, this->e2_v2_y_dense_index_) = d_edge2_v1_d_edge2_v2(0, 1);
+
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_x_dense_index_, this->e1_v1_x_dense_index_) = d_edge2_v2_d_edge1_v1(0, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_x_dense_index_, this->e1_v1_y_dense_index_) = d_edge2_v2_d_edge1_v1(0, 1);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_x_dense_index_, this->e1_v2_x_dense_index_) = d_edge2_v2_d_edge1_v2(0, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_x_dense_index_, this->e1_v2_y_dense_index_) = d_edge2_v2_d_edge1_v2(0, 1);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_x_dense_index_, this->e2_v1_x_dense_index_) = d_edge2_v2_d_edge2_v1(0, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_x_dense_index_, this->e2_v1_y_dense_index_) = d_edge2_v2_d_edge2_v1(0, 1);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_x_dense_index_, this->e2_v2_x_dense_index_) = d_edge2_v2_d_edge2_v2(0, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_x_dense_index_, this->e2_v2_y_dense_index_) = d_edge2_v2_d_edge2_v2(0, 1);
+
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_y_dense_index_, this->e1_v1_x_dense_index_) = d_edge2_v1_d_edge1_v1(1, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_y_dense_index_, this->e1_v1_y_dense_index_) = d_edge2_v1_d_edge1_v1(1, 1);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_y_dense_index_, this->e1_v2_x_dense_index_) = d_edge2_v1_d_edge1_v2(1, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_y_dense_index_, this->e1_v2_y_dense_index_) = d_edge2_v1_d_edge1_v2(1, 1);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_y_dense_index_, this->e2_v1_x_dense_index_) = d_edge2_v1_d_edge2_v1(1, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_y_dense_index_, this->e2_v1_y_dense_index_) = d_edge2_v1_d_edge2_v1(1, 1);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_y_dense_index_, this->e2_v2_x_dense_index_) = d_edge2_v1_d_edge2_v2(1, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_y_dense_index_, this->e2_v2_y_dense_index_) = d_edge2_v1_d_edge2_v2(1, 1);
+
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_y_dense_index_, this->e1_v1_x_dense_index_) = d_edge2_v2_d_edge1_v1(1, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_y_dense_index_, this->e1_v1_y_dense_index_) = d_edge2_v2_d_edge1_v1(1, 1);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_y_dense_index_, this->e1_v2_x_dense_index_) = d_edge2_v2_d_edge1_v2(1, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_y_dense_index_, this->e1_v2_y_dense_index_) = d_edge2_v2_d_edge1_v2(1, 1);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_y_dense_index_, this->e2_v1_x_dense_index_) = d_edge2_v2_d_edge2_v1(1, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_y_dense_index_, this->e2_v1_y_dense_index_) = d_edge2_v2_d_edge2_v1(1, 1);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_y_dense_index_, this->e2_v2_x_dense_index_) = d_edge2_v2_d_edge2_v2(1, 0);
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_y_dense_index_, this->e2_v2_y_dense_index_) = d_edge2_v2_d_edge2_v2(1, 1);
 	}
 	
 private:
 	/**
 	 * Private overrides
 	 */
-	void InitializeDenseIndexToFirstDerivativeSignMap(std::vector<double>& dense_index_to_first_derivative_sign_map) override
+	void InitializeDenseIndexToFirstDerivativeSignMap(typename EdgePairObjective<StorageOrder_, ObjectiveVariablesCount_>::LocalVector& dense_index_to_first_derivative_sign_map) override
 	{
 		dense_index_to_first_derivative_sign_map[this->e1_v1_x_dense_index_] = -1;
 		dense_index_to_first_derivative_sign_map[this->e1_v1_y_dense_index_] = -1;
@@ -11,15 +11,22 @@
 #include "../../data_providers/edge_pair_data_provider.h"
 #include "../sparse_objective_function.h"
 
-template<Eigen::StorageOptions StorageOrder_>
+// ObjectiveVariablesCount_ is the (compile-time) number of local variables; the local derivatives are stored in fixed-size matrices
+template<Eigen::StorageOptions StorageOrder_, int ObjectiveVariablesCount_ = 8>
 class EdgePairObjective : public SparseObjectiveFunction<StorageOrder_>
 {
 public:
+	/**
+	 * Public type definitions
+	 */
+	using LocalVector = Eigen::Matrix<double, ObjectiveVariablesCount_, 1>;
+	using LocalMatrix = Eigen::Matrix<double, ObjectiveVariablesCount_, ObjectiveVariablesCount_>;
+
 	/**
 	 * Constructors and destructor
 	 */
 	EdgePairObjective(const std::shared_ptr<MeshDataProvider>& mesh_data_provider, const std::shared_ptr<EdgePairDataProvider>& edge_pair_data_provider, const std::string& name, const bool enforce_psd) :
-		SparseObjectiveFunction(mesh_data_provider, edge_pair_data_provider, name, 4, enforce_psd)
+		SparseObjectiveFunction(mesh_data_provider, edge_pair_data_provider, name, ObjectiveVariablesCount_ / 2, ObjectiveVariablesCount_, enforce_psd)
 	{
 
 	}
@@ -43,8 +50,6 @@ protected:
 		SparseObjectiveFunction<StorageOrder_>::PostInitialize();
 
 		auto& edge_pair_data_provider = this->GetEdgePairDataProvider();
-		auto& dense_variable_index_to_sparse_variable_index_map = this->GetDenseVariableIndexToSparseVariableIndexMap();
-		auto& sparse_variable_index_to_dense_variable_index_map = this->GetSparseVariableIndexToDenseVariableIndexMap();
 
 		e1_v1_x_sparse_index_ = edge_pair_data_provider.GetEdge1Vertex1XIndex();
 		e1_v1_y_sparse_index_ = edge_pair_data_provider.GetEdge1Vertex1YIndex();
@@ -55,36 +60,28 @@ protected:
 		e2_v2_x_sparse_index_ = edge_pair_data_provider.GetEdge2Vertex2XIndex();
 		e2_v2_y_sparse_index_ = edge_pair_data_provider.GetEdge2Vertex2YIndex();
 
-		e1_v1_x_dense_index_ = sparse_variable_index_to_dense_variable_index_map.at(e1_v1_x_sparse_index_);
-		e1_v1_y_dense_index_ = sparse_variable_index_to_dense_variable_index_map.at(e1_v1_y_sparse_index_);
-		e1_v2_x_dense_index_ = sparse_variable_index_to_dense_variable_index_map.at(e1_v2_x_sparse_index_);
-		e1_v2_y_dense_index_ = sparse_variable_index_to_dense_variable_index_map.at(e1_v2_y_sparse_index_);
-		e2_v1_x_dense_index_ = sparse_variable_index_to_dense_variable_index_map.at(e2_v1_x_sparse_index_);
-		e2_v1_y_dense_index_ = sparse_variable_index_to_dense_variable_index_map.at(e2_v1_y_sparse_index_);
-		e2_v2_x_dense_index_ = sparse_variable_index_to_dense_variable_index_map.at(e2_v2_x_sparse_index_);
-		e2_v2_y_dense_index_ = sparse_variable_index_to_dense_variable_index_map.at(e2_v2_y_sparse_index_);
+		e1_v1_x_dense_index_ = this->GetDenseVariableIndex(e1_v1_x_sparse_index_);
+		e1_v1_y_dense_index_ = this->GetDenseVariableIndex(e1_v1_y_sparse_index_);
+		e1_v2_x_dense_index_ = this->GetDenseVariableIndex(e1_v2_x_sparse_index_);
+		e1_v2_y_dense_index_ = this->GetDenseVariableIndex(e1_v2_y_sparse_index_);
+		e2_v1_x_dense_index_ = this->GetDenseVariableIndex(e2_v1_x_sparse_index_);
+		e2_v1_y_dense_index_ = this->GetDenseVariableIndex(e2_v1_y_sparse_index_);
+		e2_v2_x_dense_index_ = this->GetDenseVariableIndex(e2_v2_x_sparse_index_);
+		e2_v2_y_dense_index_ = this->GetDenseVariableIndex(e2_v2_y_sparse_index_);
 		
-		dense_index_to_first_derivative_sign_map_.resize(this->objective_variables_count_);
+		dense_index_to_first_derivative_sign_map_.setZero();
 		InitializeDenseIndexToFirstDerivativeSignMap(dense_index_to_first_derivative_sign_map_);
 
-		dense_index_to_first_derivative_value_map_.resize(this->objective_variables_count_);
-		dense_indices_to_second_derivative_value_map_.resize(this->objective_variables_count_);
-		for (RDS::DenseVariableIndex i = 0; i < this->objective_variables_count_; i++)
-		{
-			dense_indices_to_second_derivative_value_map_[i].resize(this->objective_variables_count_);
-			for (RDS::DenseVariableIndex j = 0; j < this->objective_variables_count_; j++)
-			{
-				dense_indices_to_second_derivative_value_map_[i][j] = 0;
-			}
-		}
+		dense_index_to_first_derivative_value_map_.setZero();
+		dense_indices_to_second_derivative_value_map_.setZero();
 	}
 
 	/**
 	 * Protected fields
 	 */
-	std::vector<double> dense_index_to_first_derivative_sign_map_;
-	std::vector<double> dense_index_to_first_derivative_value_map_;
-	std::vector<std::vector<double>> dense_indices_to_second_derivative_value_map_;
+	LocalVector dense_index_to_first_derivative_sign_map_;
+	LocalVector dense_index_to_first_derivative_value_map_;
+	LocalMatrix dense_indices_to_second_derivative_value_map_;
 
 	RDS::SparseVariableIndex e1_v1_x_sparse_index_;
 	RDS::SparseVariableIndex e1_v1_y_sparse_index_;
@@ -123,23 +120,22 @@ private:
 
 	void CalculateGradient(Eigen::SparseVector<double>& g) override
 	{
-		auto objective_variable_count = this->objective_variables_count_;
-		auto dense_variable_index_to_sparse_variable_index_map = this->GetDenseVariableIndexToSparseVariableIndexMap();
-		for (RDS::DenseVariableIndex dense_variable_index = 0; dense_variable_index < objective_variable_count; dense_variable_index++)
+		const auto& dense_variable_index_to_sparse_variable_index_array = this->GetDenseVariableIndexToSparseVariableIndexArray();
+		for (RDS::DenseVariableIndex dense_variable_index = 0; dense_variable_index < ObjectiveVariablesCount_; dense_variable_index++)
 		{
-			const RDS::SparseVariableIndex sparse_variable_index = dense_variable_index_to_sparse_variable_index_map.at(dense_variable_index);
+			const RDS::SparseVariableIndex sparse_variable_index = dense_variable_index_to_sparse_variable_index_array[dense_variable_index];
 			g.coeffRef(sparse_variable_index) = CalculateFirstPartialDerivative(dense_variable_index);
 		}
 	}
 
-	void CalculateRawTriplets(std::vector<Eigen::Triplet<double>>& triplets) override
+	void CalculateRawTriplets(const TripletsView& triplets) override
 	{
-		const auto triplets_count = triplets.size();
-		auto sparse_variable_index_to_dense_variable_index_map = this->GetSparseVariableIndexToDenseVariableIndexMap();
+		constexpr auto triplets_count = (ObjectiveVariablesCount_ * (ObjectiveVariablesCount_ + 1)) / 2;
+		const auto& hessian_triplet_index_to_hessian_entry_array = this->GetHessianTripletIndexToHessianEntryArray();
 		for (RDS::HessianTripletIndex i = 0; i < triplets_count; i++)
 		{
-			auto dense_variable_index1 = sparse_variable_index_to_dense_variable_index_map[triplets[i].row()];
-			auto dense_variable_index2 = sparse_variable_index_to_dense_variable_index_map[triplets[i].col()];
+			const auto dense_variable_index1 = hessian_triplet_index_to_hessian_entry_array[i].first;
+			const auto dense_variable_index2 = hessian_triplet_index_to_hessian_entry_array[i].second;
 			const_cast<double&>(triplets[i].value()) = CalculateSecondPartialDerivative(dense_variable_index1, dense_variable_index2);
 		}
 	}
@@ -147,16 +143,16 @@ private:
 	/**
 	 * Private methods
 	 */
-	virtual void InitializeDenseIndexToFirstDerivativeSignMap(std::vector<double>& dense_index_to_first_derivative_sign_map) = 0;
+	virtual void InitializeDenseIndexToFirstDerivativeSignMap(LocalVector& dense_index_to_first_derivative_sign_map) = 0;
 	
 	double CalculateFirstPartialDerivative(const RDS::SparseVariableIndex dense_variable_index)
 	{
-		return dense_index_to_first_derivative_sign_map_[dense_variable_index] * dense_index_to_first_derivative_value_map_[dense_variable_index];
+		return dense_index_to_first_derivative_sign_map_.coeff(dense_variable_index) * dense_index_to_first_derivative_value_map_.coeff(dense_variable_index);
 	}
 
 	double CalculateSecondPartialDerivative(const RDS::SparseVariableIndex dense_variable_index1, const RDS::SparseVariableIndex dense_variable_index2)
 	{
-		return dense_index_to_first_derivative_sign_map_[dense_variable_index1] * dense_indices_to_second_derivative_value_map_[dense_variable_index1][dense_variable_index2];
+		return dense_index_to_first_derivative_sign_map_.coeff(dense_variable_index1) * dense_indices_to_second_derivative_value_map_.coeff(dense_variable_index1, dense_variable_index2);
 	}
 };
 
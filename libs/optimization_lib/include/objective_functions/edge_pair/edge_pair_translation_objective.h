@@ -9,8 +9,8 @@
 #include "../summation_objective.h"
 #include "../../data_providers/edge_pair_data_provider.h"
 
-template <Eigen::StorageOptions StorageOrder_>
-class EdgePairTranslationObjective : public EdgePairObjective<StorageOrder_>
+template<Eigen::StorageOptions StorageOrder_, int ObjectiveVariablesCount_ = 8>
+class EdgePairTranslationObjective : public EdgePairObjective<StorageOrder_, ObjectiveVariablesCount_>
 {
 public:
 	/**
@@ -31,6 +31,11 @@ protected:
 	/**
 	 * Protected overrides
 	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override
+	{
+		return std::make_shared<EdgePairTranslationObjective>(*this);
+	}
+
 	void PreUpdate(const Eigen::VectorXd& x) override
 	{
 		auto& edge_pair_data_provider = this->GetEdgePairDataProvider();
@@ -57,52 +62,52 @@ protected:
 		/**
 		 * Second partial derivatives
 		 */
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_x_dense_index_][this->e1_v1_x_dense_index_] = 2;
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_x_dense_index_][this->e1_v2_x_dense_index_] = -2;
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_x_dense_index_][this->e2_v1_x_dense_index_] = -2;
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_x_dense_index_][this->e2_v2_x_dense_index_] = 2;
-
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_x_dense_index_][this->e1_v1_x_dense_index_] = 2;
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_x_dense_index_][this->e1_v2_x_dense_index_] = -2;
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_x_dense_index_][this->e2_v1_x_dense_index_] = -2;
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_x_dense_index_][this->e2_v2_x_dense_index_] = 2;
-
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_y_dense_index_][this->e1_v1_y_dense_index_] = 2;
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_y_dense_index_][this->e1_v2_y_dense_index_] = -2;
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_y_dense_index_][this->e2_v1_y_dense_index_] = -2;
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v1_y_dense_index_][this->e2_v2_y_dense_index_] = 2;
-
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_y_dense_index_][this->e1_v1_y_dense_index_] = 2;
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_y_dense_index_][this->e1_v2_y_dense_index_] = -2;
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_y_dense_index_][this->e2_v1_y_dense_index_] = -2;
-		this->dense_indices_to_second_derivative_value_map_[this->e1_v2_y_dense_index_][this->e2_v2_y_dense_index_] = 2;
-
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_x_dense_index_][this->e1_v1_x_dense_index_] = 2;
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_x_dense_index_][this->e1_v2_x_dense_index_] = -2;
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_x_dense_index_][this->e2_v1_x_dense_index_] = -2;
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_x_dense_index_][this->e2_v2_x_dense_index_] = 2;
-
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_x_dense_index_][this->e1_v1_x_dense_index_] = 2;
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_x_dense_index_][this->e1_v2_x_dense_index_] = -2;
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_x_dense_index_][this->e2_v1_x_dense_index_] = -2;
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_x_dense_index_][this->e2_v2_x_dense_index_] = 2;
-
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_y_dense_index_][this->e1_v1_y_dense_index_] = 2;
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_y_dense_index_][this->e1_v2_y_dense_index_] = -2;
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_y_dense_index_][this->e2_v1_y_dense_index_] = -2;
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v1_y_dense_index_][this->e2_v2_y_dense_index_] = 2;
-
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_y_dense_index_][this->e1_v1_y_dense_index_] = 2;
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_y_dense_index_][this->e1_v2_y_dense_index_] = -2;
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_y_dense_index_][this->e2_v1_y_dense_index_] = -2;
-		this->dense_indices_to_second_derivative_value_map_[this->e2_v2_y_dense_index_][this->e2_v2_y_dense_index_] = 2;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_x_dense_index_, this->e1_v1_x_dense_index_) = 2;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_x_dense_index_, this->e1_v2_x_dense_index_) = -2;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_x_dense_index_, this->e2_v1_x_dense_index_) = -2;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_x_dense_index_, this->e2_v2_x_dense_index_) = 2;
+
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_x_dense_index_, this->e1_v1_x_dense_index_) = 2;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_x_dense_index_, this->e1_v2_x_dense_index_) = -2;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_x_dense_index_, this->e2_v1_x_dense_index_) = -2;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_x_dense_index_, this->e2_v2_x_dense_index_) = 2;
+
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_y_dense_index_, this->e1_v1_y_dense_index_) = 2;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_y_dense_index_, this->e1_v2_y_dense_index_) = -2;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_y_dense_index_, this->e2_v1_y_dense_index_) = -2;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v1_y_dense_index_, this->e2_v2_y_dense_index_) = 2;
+
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_y_dense_index_, this->e1_v1_y_dense_index_) = 2;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_y_dense_index_, this->e1_v2_y_dense_index_) = -2;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_y_dense_index_, this->e2_v1_y_dense_index_) = -2;
+		this->dense_indices_to_second_derivative_value_map_(this->e1_v2_y_dense_index_, this->e2_v2_y_dense_index_) = 2;
+
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_x_dense_index_, this->e1_v1_x_dense_index_) = 2;
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_x_dense_index_, this->e1_v2_x_dense_index_) = -2;
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_x_dense_index_, this->e2_v1_x_dense_index_) = -2;
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_x_dense_index_, this->e2_v2_x_dense_index_) = 2;
+
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_x_dense_index_, this->e1_v1_x_dense_index_) = 2;
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_x_dense_index_, this->e1_v2_x_dense_index_) = -2;
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_x_dense_index_, this->e2_v1_x_dense_index_) = -2;
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_x_dense_index_, this->e2_v2_x_dense_index_) = 2;
+
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_y_dense_index_, this->e1_v1_y_dense_index_) = 2;
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_y_dense_index_, this->e1_v2_y_dense_index_) = -2;
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_y_dense_index_, this->e2_v1_y_dense_index_) = -2;
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v1_y_dense_index_, this->e2_v2_y_dense_index_) = 2;
+
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_y_dense_index_, this->e1_v1_y_dense_index_) = 2;
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_y_dense_index_, this->e1_v2_y_dense_index_) = -2;
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_y_dense_index_, this->e2_v1_y_dense_index_) = -2;
+		this->dense_indices_to_second_derivative_value_map_(this->e2_v2_y_dense_index_, this->e2_v2_y_dense_index_) = 2;
 	}
 
 private:
 	/**
 	 * Private overrides
 	 */
-	void InitializeDenseIndexToFirstDerivativeSignMap(std::vector<double>& dense_index_to_first_derivative_sign_map) override
+	void InitializeDenseIndexToFirstDerivativeSignMap(typename EdgePairObjective<StorageOrder_, ObjectiveVariablesCount_>::LocalVector& dense_index_to_first_derivative_sign_map) override
 	{
 		dense_index_to_first_derivative_sign_map[this->e1_v1_x_dense_index_] = 1;
 		dense_index_to_first_derivative_sign_map[this->e1_v1_y_dense_index_] = 1;
@@ -5,10 +5,14 @@
 // STL Includes
 #include <memory>
 #include <atomic>
+#include <cassert>
 #include <string>
 #include <mutex>
 #include <any>
 #include <limits>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
 
 // Eigen Includes
 #include <Eigen/Core>
@@ -17,6 +21,7 @@
 // Optimization Lib Includes
 #include "../core/core.h"
 #include "../core/updatable_object.h"
+#include "../core/triplets_view.h"
 #include "./objective_function_base.h"
 #include "../data_providers/data_provider.h"
 
@@ -38,6 +43,8 @@ public:
 	ObjectiveFunction(const std::shared_ptr<MeshDataProvider>& mesh_data_provider, const std::shared_ptr<DataProvider>& data_provider, const std::string& name) :
 		ObjectiveFunctionBase(mesh_data_provider),
 		f_(0),
+		hessian_pattern_valid_(false),
+		triplets_layout_version_(0),
 		w_(1),
 		name_(name),
 		data_provider_(data_provider)
@@ -48,6 +55,26 @@ public:
 		}
 	}
 
+	// Copies everything but the mutexes and the triplets target
+	ObjectiveFunction(const ObjectiveFunction& other) :
+		ObjectiveFunctionBase(other),
+		data_provider_(other.data_provider_),
+		f_(other.f_),
+		f_per_vertex_(other.f_per_vertex_),
+		image_value_per_edge_(other.image_value_per_edge_),
+		domain_value_per_edge_(other.domain_value_per_edge_),
+		g_(other.g_),
+		triplets_(other.triplets_),
+		H_(other.H_),
+		hessian_slots_(other.hessian_slots_),
+		hessian_pattern_valid_(other.hessian_pattern_valid_),
+		triplets_layout_version_(other.triplets_layout_version_),
+		w_(other.w_),
+		name_(other.name_)
+	{
+
+	}
+
 	virtual ~ObjectiveFunction()
 	{
 		// Empty implementation
@@ -81,9 +108,26 @@ public:
 		return g_;
 	}
 
+	// The sparsity pattern is compressed once; afterwards, the triplet values are scattered directly into their precomputed slots
+	// (every change of the triplets layout must go through InvalidateHessianPattern, which debug builds verify before scattering)
 	const Eigen::SparseMatrix<double, StorageOrder_>& GetHessian()
 	{
-		H_.setFromTriplets(triplets_.begin(), triplets_.end());
+		if (!hessian_pattern_valid_ || hessian_slots_.size() != triplets_.size())
+		{
+			BuildHessianPattern();
+			return H_;
+		}
+
+		assert(IsHessianPatternConsistent());
+
+		double* values = H_.valuePtr();
+		std::fill(values, values + H_.nonZeros(), 0);
+		const auto triplets_count = triplets_.size();
+		for (std::size_t i = 0; i < triplets_count; i++)
+		{
+			values[hessian_slots_[i]] += triplets_[i].value();
+		}
+
 		return H_;
 	}
 
@@ -92,6 +136,12 @@ public:
 		return triplets_;
 	}
 
+	// Changes whenever the layout of the triplets changes, so objectives that copy the layout of another objective can tell when to copy it again
+	uint64_t GetTripletsLayoutVersion() const
+	{
+		return triplets_layout_version_;
+	}
+
 	double GetWeight() const
 	{
 		return w_;
@@ -107,6 +157,12 @@ public:
 		return data_provider_;
 	}
 
+	// The triplets count is a fair proxy for the work of an update
+	int64_t GetUpdateCost() const override
+	{
+		return 1 + static_cast<int64_t>(triplets_.size());
+	}
+
 	// Generic property getter
 	virtual bool GetProperty(const int32_t property_id, const int32_t property_modifier_id, const std::any property_context, std::any& property_value) override
 	{
@@ -146,9 +202,11 @@ public:
 	/**
 	 * Setters
 	 */
+	// The weight is applied by the parent objective, which is re-evaluated along with this one
 	void SetWeight(const double w)
 	{
 		w_ = w;
+		this->Invalidate();
 	}
 
 	// Generic property setter
@@ -180,6 +238,10 @@ public:
 		InitializeGradient(g_);
 		InitializeHessian(H_);
 		InitializeTriplets(triplets_);
+		InvalidateHessianPattern();
+
+		// The range of a target was laid out for the previous triplets
+		triplets_target_ = TripletsTarget();
 		PostInitialize();
 		UpdatableObject::Initialize();
 	}
@@ -229,46 +291,21 @@ public:
 		UpdateLayers(x, UpdateOptions::All);
 	}
 
+	// Updates the dependency graph (see UpdatableObject::UpdateDependencies), and then this objective
 	void UpdateLayers(const Eigen::VectorXd& x, const UpdateOptions update_options)
 	{
 		std::lock_guard<std::mutex> lock(mutex_);
-		int32_t update_modifiers = static_cast<int32_t>(update_options);
-		const auto layers_count = dependency_layers_.size();
-		for(std::size_t current_layer_index = 0; current_layer_index < layers_count; current_layer_index++)
-		{
-			const auto& current_layer = dependency_layers_[current_layer_index];
-			const auto objects_count = current_layer.size();
-
-			// HACK: Remove this 'if' branch once Separation and Symmetric Dirichlet
-			// objectives are composed as sum of sub-objectives
-			if(current_layer_index == 0)
-			{
-				#pragma omp parallel for
-				for (long i = 1; i < objects_count; i++)
-				{
-					current_layer[i]->Update(x, update_modifiers);
-				}
-
-				if (objects_count > 0)
-				{
-					current_layer[0]->Update(x, update_modifiers);
-				}
-
-				//if (objects_count > 1)
-				//{
-				//	current_layer[1]->Update(x, update_modifiers);
-				//}
-			}
-			else
-			{
-				#pragma omp parallel for
-				for (long i = 0; i < objects_count; i++)
-				{
-					current_layer[i]->Update(x, update_modifiers);
-				}
-			}
-		}
+		const int32_t update_modifiers = static_cast<int32_t>(update_options);
+		this->UpdateDependencies(x, update_modifiers);
+		Update(x, update_modifiers);
+	}
 
+	// Same as above, where only changed_variables differ from the previous update; dependencies that do not read them keep their cached results
+	void UpdateLayers(const Eigen::VectorXd& x, const UpdateOptions update_options, const std::vector<RDS::SparseVariableIndex>& changed_variables)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		const int32_t update_modifiers = static_cast<int32_t>(update_options);
+		this->UpdateDependencies(x, update_modifiers, changed_variables);
 		Update(x, update_modifiers);
 	}
 
@@ -281,7 +318,18 @@ public:
 	template<typename GradientVectorType_>
 	void AddGradient(GradientVectorType_& g, const double w = 1) const
 	{
-		g = g + w * g_;
+		if constexpr (std::is_same_v<VectorType_, Eigen::SparseVector<double>> && std::is_same_v<GradientVectorType_, Eigen::VectorXd>)
+		{
+			// Touch only the non-zeros, instead of evaluating a dense temporary
+			for (typename VectorType_::InnerIterator it(g_); it; ++it)
+			{
+				g.coeffRef(it.index()) += w * it.value();
+			}
+		}
+		else
+		{
+			g = g + w * g_;
+		}
 	}
 
 	template<typename ValueVectorType_>
@@ -308,6 +356,198 @@ public:
 		}
 	}
 
+	// Overwrites the values of triplets[offset, offset + triplets_.size()) with the weighted values of triplets_, leaving their indices untouched.
+	// Assumes the range was previously filled by AddTriplets.
+	void AssignTripletValues(std::vector<Eigen::Triplet<double>>& triplets, const std::size_t offset, const double w = 1) const
+	{
+		const auto triplets_count = triplets_.size();
+		for (std::size_t i = 0; i < triplets_count; i++)
+		{
+			const_cast<double&>(triplets[offset + i].value()) = w * triplets_[i].value();
+		}
+	}
+
+	// Lets a parent (the owner) receive the hessian values of this objective directly in its range triplets[offset, offset + GetTriplets().size()),
+	// weighted by the weight of this objective if weighted is set, instead of copying them from GetTriplets() after every update.
+	// Fails if the objective does not write through a TripletsView, or already writes into the triplets of another owner.
+	// While the target is set, GetTriplets() (and GetHessian()) keep the layout, but not the values.
+	bool SetTripletsTarget(const UpdatableObject* owner, std::vector<Eigen::Triplet<double>>& triplets, const std::size_t offset, const bool weighted)
+	{
+		if (!IsTripletsTargetSupported() || (triplets_target_.owner != nullptr && triplets_target_.owner != owner))
+		{
+			return false;
+		}
+
+		triplets_target_ = { owner, &triplets, offset, weighted, false, 1 };
+		return true;
+	}
+
+	void ClearTripletsTarget(const UpdatableObject* owner)
+	{
+		if (triplets_target_.owner == owner)
+		{
+			triplets_target_ = TripletsTarget();
+		}
+	}
+
+	bool HasTripletsTarget(const UpdatableObject* owner) const
+	{
+		return triplets_target_.owner == owner;
+	}
+
+	std::size_t GetTripletsTargetOffset() const
+	{
+		return triplets_target_.offset;
+	}
+
+	// Brings the weighted values in the target to the current weight, for owners that change the weight of this objective after it was updated.
+	// Values weighted by 0 cannot be rescaled, so they are restored from the unweighted copy kept in the triplets of this objective meanwhile.
+	void ReweightTripletsTarget(const UpdatableObject* owner)
+	{
+		if (triplets_target_.owner != owner || !triplets_target_.weighted || triplets_target_.weight == w_)
+		{
+			return;
+		}
+
+		const TripletsView triplets(*triplets_target_.triplets, triplets_target_.offset, triplets_.size());
+		if (triplets_target_.weight == 0)
+		{
+			for (std::size_t i = 0; i < triplets.size(); i++)
+			{
+				const_cast<double&>(triplets[i].value()) = w_ * triplets_[i].value();
+			}
+		}
+		else
+		{
+			if (w_ == 0)
+			{
+				StoreUnweightedTriplets(triplets, triplets_target_.weight);
+			}
+
+			triplets.Scale(w_ / triplets_target_.weight);
+		}
+
+		triplets_target_.weight = w_;
+	}
+
+	// Whether the values in the target were rewritten since the last call
+	bool ConsumeTripletsTargetWritten()
+	{
+		const bool written = triplets_target_.written;
+		triplets_target_.written = false;
+		return written;
+	}
+
+	// Size N of the local hessian, if the objective projects it onto the PSD cone and stores it as the N * (N + 1) / 2 upper triangular triplets
+	// expected by PsdProjection; 0 otherwise
+	virtual int64_t GetPsdProjectionSize() const
+	{
+		return 0;
+	}
+
+	// When deferred, the objective leaves the PSD projection of its local hessian to its parent (which projects many of them in one batch)
+	virtual void SetDeferPsdProjection(const bool defer_psd_projection)
+	{
+		// Empty implementation
+	}
+
+	virtual bool GetDeferPsdProjection() const
+	{
+		return false;
+	}
+
+	// Must be called whenever the layout of the triplets (their count, order, or the (row, col) of any of them) changes
+	void InvalidateHessianPattern()
+	{
+		hessian_pattern_valid_ = false;
+		triplets_layout_version_++;
+	}
+
+	/**
+	 * Evaluation contexts
+	 */
+
+	// A private workspace for evaluating the objective: a clone of the objective tree (see UpdatableObject::Clone), that holds its own values,
+	// gradients, triplets and caches. Evaluations in different contexts may run concurrently, while the objective itself remains the default context.
+	// A context is a snapshot of the definition of the objective (weights, children, settings) at its creation, tagged with the objective it was
+	// cloned from and the state version of that objective's tree. Evaluate rejects contexts of other objectives, and replaces a stale snapshot
+	// (the objective was invalidated or initialized since) by a fresh one before evaluating.
+	class EvaluationContext
+	{
+	public:
+		EvaluationContext(const std::shared_ptr<ObjectiveFunction>& objective_function, const ObjectiveFunction* source_objective_function, const uint64_t source_state_version) :
+			objective_function_(objective_function),
+			source_objective_function_(source_objective_function),
+			source_state_version_(source_state_version)
+		{
+
+		}
+
+		double GetValue() const
+		{
+			return objective_function_->GetValue();
+		}
+
+		const VectorType_& GetGradient() const
+		{
+			return objective_function_->GetGradient();
+		}
+
+		const Eigen::SparseMatrix<double, StorageOrder_>& GetHessian()
+		{
+			return objective_function_->GetHessian();
+		}
+
+		const std::shared_ptr<ObjectiveFunction>& GetObjectiveFunction() const
+		{
+			return objective_function_;
+		}
+
+		const ObjectiveFunction* GetSourceObjectiveFunction() const
+		{
+			return source_objective_function_;
+		}
+
+		uint64_t GetSourceStateVersion() const
+		{
+			return source_state_version_;
+		}
+
+	private:
+		std::shared_ptr<ObjectiveFunction> objective_function_;
+		const ObjectiveFunction* source_objective_function_;
+		uint64_t source_state_version_;
+	};
+
+	// Clones the objective as it is after the current update (if any)
+	std::shared_ptr<EvaluationContext> CreateEvaluationContext() const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return std::make_shared<EvaluationContext>(CloneEvaluationObjective(), this, this->GetStateVersion());
+	}
+
+	// Evaluates the objective at x, into context; thread-safe as long as every thread uses its own context.
+	// A stale context is refreshed first (see EvaluationContext), so the evaluation always reflects the current definition of the objective.
+	void Evaluate(EvaluationContext& context, const Eigen::VectorXd& x, const UpdateOptions update_options = UpdateOptions::All) const
+	{
+		if (context.GetSourceObjectiveFunction() != this)
+		{
+			throw std::exception("ObjectiveFunction::Evaluate - The evaluation context was created by another objective");
+		}
+
+		// The state version is read under the lock, so the tree is not initialized (or updated) meanwhile by its owner
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			const auto state_version = this->GetStateVersion();
+			if (context.GetSourceStateVersion() != state_version)
+			{
+				context = EvaluationContext(CloneEvaluationObjective(), this, state_version);
+			}
+		}
+
+		context.GetObjectiveFunction()->UpdateLayers(x, update_options);
+	}
+
 	/**
 	 * Gradient and hessian approximation using finite differences
 	 */
@@ -399,6 +639,56 @@ protected:
 		// Empty implementation
 	}
 
+	virtual bool IsTripletsTargetSupported() const
+	{
+		return false;
+	}
+
+	// Where CalculateTriplets writes the values of the triplets: the range of the target, if set, and the triplets of this objective otherwise
+	TripletsView GetTripletsView(std::vector<Eigen::Triplet<double>>& triplets) const
+	{
+		if (triplets_target_.triplets == nullptr)
+		{
+			return TripletsView(triplets);
+		}
+
+		return TripletsView(*triplets_target_.triplets, triplets_target_.offset, triplets.size());
+	}
+
+	// Completes the values written through GetTripletsView: weights them (if the target is weighted), and marks the target as written
+	void CommitTripletsView(const TripletsView& triplets)
+	{
+		if (triplets_target_.triplets == nullptr)
+		{
+			return;
+		}
+
+		if (triplets_target_.weighted)
+		{
+			if (w_ == 0)
+			{
+				StoreUnweightedTriplets(triplets, 1);
+			}
+
+			triplets.Scale(w_);
+			triplets_target_.weight = w_;
+		}
+
+		triplets_target_.written = true;
+	}
+
+	// The triplets of this objective, for parents that let their children write into them (see SetTripletsTarget)
+	std::vector<Eigen::Triplet<double>>& GetMutableTriplets()
+	{
+		return triplets_;
+	}
+
+	void RemapDependencies(const UpdatableObject::CloneMap& clones) override
+	{
+		ObjectiveFunctionBase::RemapDependencies(clones);
+		data_provider_ = UpdatableObject::Remap(data_provider_, clones);
+	}
+
 	/**
 	 * Protected fields
 	 */
@@ -410,6 +700,22 @@ protected:
 	std::shared_ptr<DataProvider> data_provider_;
 	
 private:
+	/**
+	 * Private type definitions
+	 */
+
+	// The range of the triplets of a parent that receives the values of this objective (see SetTripletsTarget)
+	struct TripletsTarget
+	{
+		const UpdatableObject* owner = nullptr;
+		std::vector<Eigen::Triplet<double>>* triplets = nullptr;
+		std::size_t offset = 0;
+		bool weighted = false;
+		bool written = false;
+
+		// The weight the written values were scaled by
+		double weight = 1;
+	};
 
 	/**
 	 * Private getters
@@ -465,6 +771,64 @@ private:
 
 	virtual void InitializeTriplets(std::vector<Eigen::Triplet<double>>& triplets) = 0;
 
+	// Compresses the pattern of triplets_ into H_, and maps every triplet to the index of its entry in H_.valuePtr()
+	void BuildHessianPattern()
+	{
+		H_.setFromTriplets(triplets_.begin(), triplets_.end());
+		H_.makeCompressed();
+
+		const auto triplets_count = triplets_.size();
+		hessian_slots_.resize(triplets_count);
+		const auto* outer_index = H_.outerIndexPtr();
+		const auto* inner_index = H_.innerIndexPtr();
+		for (std::size_t i = 0; i < triplets_count; i++)
+		{
+			const auto outer = H_.IsRowMajor ? triplets_[i].row() : triplets_[i].col();
+			const auto inner = H_.IsRowMajor ? triplets_[i].col() : triplets_[i].row();
+			const auto* begin = inner_index + outer_index[outer];
+			const auto* end = inner_index + outer_index[outer + 1];
+			hessian_slots_[i] = static_cast<int64_t>(std::lower_bound(begin, end, inner) - inner_index);
+		}
+
+		hessian_pattern_valid_ = true;
+	}
+
+	// Whether every triplet still maps to the entry of its (row, col) in H_
+	bool IsHessianPatternConsistent() const
+	{
+		const auto* outer_index = H_.outerIndexPtr();
+		const auto* inner_index = H_.innerIndexPtr();
+		const auto triplets_count = triplets_.size();
+		for (std::size_t i = 0; i < triplets_count; i++)
+		{
+			const auto outer = H_.IsRowMajor ? triplets_[i].row() : triplets_[i].col();
+			const auto inner = H_.IsRowMajor ? triplets_[i].col() : triplets_[i].row();
+			const auto slot = hessian_slots_[i];
+			if (outer >= H_.outerSize() || slot < outer_index[outer] || slot >= outer_index[outer + 1] || inner_index[slot] != inner)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Clone of the objective tree for an evaluation context; called under the lock
+	std::shared_ptr<ObjectiveFunction> CloneEvaluationObjective() const
+	{
+		UpdatableObject::CloneMap clones;
+		return std::static_pointer_cast<ObjectiveFunction>(this->Clone(clones));
+	}
+
+	// Keeps the values written into the target (weighted by weight) in the triplets of this objective, unweighted
+	void StoreUnweightedTriplets(const TripletsView& triplets, const double weight)
+	{
+		for (std::size_t i = 0; i < triplets.size(); i++)
+		{
+			const_cast<double&>(triplets_[i].value()) = triplets[i].value() / weight;
+		}
+	}
+
 	// Value, gradient and hessian calculation functions
 	virtual void CalculateValue(double& f) = 0;
 	virtual void CalculateValuePerVertex(VectorType_& f_per_vertex) = 0;
@@ -509,6 +873,16 @@ private:
 
 	// Hessian
 	Eigen::SparseMatrix<double, StorageOrder_> H_;
+
+	// Hessian scatter map (triplet index -> index into H_.valuePtr())
+	std::vector<int64_t> hessian_slots_;
+	bool hessian_pattern_valid_;
+
+	// Triplets layout version (see InvalidateHessianPattern)
+	uint64_t triplets_layout_version_;
+
+	// Range of the triplets of a parent that receives the values (not copied by the copy constructor, since it belongs to the parent of the original)
+	TripletsTarget triplets_target_;
 	
 	// Weight
 	double w_;
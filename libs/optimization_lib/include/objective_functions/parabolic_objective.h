@@ -86,6 +86,11 @@ private:
 	/**
 	 * Private overrides
 	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override
+	{
+		return std::make_shared<ParabolicObjective>(*this);
+	}
+
 	void CalculateDerivativesOuter(const double x, double& outer_value, double& outer_first_derivative, double& outer_second_derivative) override
 	{
 		const double f = x;
@@ -54,27 +54,8 @@ public:
 		p4_ = p3_ * p_;
 		p5_ = p4_ * p_;
 
-		hp_ = period / 2;
-		hp2_ = hp_ * hp_;
-		hp3_ = hp2_ * hp_;
-		hp4_ = hp3_ * hp_;
-		hp5_ = hp4_ * hp_;
-
-		Eigen::VectorXd b(6);
-		b << 0, 0, 1, 0, 0, 0;
-
-		Eigen::MatrixXd A(6,6);
-		A <<		0,		   0,		   0,			0 ,		  0,	 1,
-					0,		   0,		   0,			0 ,		  1,	 0,
-				 hp5_,		hp4_,		hp3_,		  hp2_,		hp_,	 1,
-			 5 * hp4_,	4 * hp3_,	3 * hp2_,	  2 * hp_ ,		  1,	 0,
-				  p5_,		 p4_,		 p3_,		   p2_,		 p_,	 1,
-			 5 *  p4_,	4 *  p3_,	3 *  p2_,	  2 *  p_ ,		  1,	 0;
-
-		polynomial_coeffs_ = A.fullPivHouseholderQr().solve(b);
-		polynomial_coeffs_.coeffRef(0) = 0;
-		polynomial_coeffs_.coeffRef(4) = 0;
-		polynomial_coeffs_.coeffRef(5) = 0;
+		polynomial_coeffs_ = CalculatePolynomialCoeffs(period);
+		this->Invalidate();
 	}
 
 	bool SetProperty(const int32_t property_id, const std::any property_context, const std::any property_value) override
@@ -95,6 +76,64 @@ public:
 		return false;
 	}
 
+	/**
+	 * Public methods
+	 */
+
+	// Coefficients (highest power first) of the quintic that shapes a single period
+	static Eigen::VectorXd CalculatePolynomialCoeffs(const double period)
+	{
+		const double p = period;
+		const double p2 = p * p;
+		const double p3 = p2 * p;
+		const double p4 = p3 * p;
+		const double p5 = p4 * p;
+
+		const double hp = period / 2;
+		const double hp2 = hp * hp;
+		const double hp3 = hp2 * hp;
+		const double hp4 = hp3 * hp;
+		const double hp5 = hp4 * hp;
+
+		Eigen::VectorXd b(6);
+		b << 0, 0, 1, 0, 0, 0;
+
+		Eigen::MatrixXd A(6,6);
+		A <<		0,		   0,		   0,			0 ,		  0,	 1,
+					0,		   0,		   0,			0 ,		  1,	 0,
+				  hp5,		 hp4,		 hp3,		   hp2,		 hp,	 1,
+			  5 * hp4,	 4 * hp3,	 3 * hp2,	   2 * hp ,		  1,	 0,
+				   p5,		  p4,		  p3,			p2,		  p,	 1,
+			  5 *  p4,	 4 *  p3,	 3 *  p2,	   2 *  p ,		  1,	 0;
+
+		Eigen::VectorXd polynomial_coeffs = A.fullPivHouseholderQr().solve(b);
+		polynomial_coeffs.coeffRef(0) = 0;
+		polynomial_coeffs.coeffRef(4) = 0;
+		polynomial_coeffs.coeffRef(5) = 0;
+		return polynomial_coeffs;
+	}
+
+	// Value, first and second derivatives of the periodic function at x (the polynomial is evaluated on x wrapped into [0, period))
+	static void CalculatePolynomialDerivatives(const double x, const double period, const Eigen::VectorXd& polynomial_coeffs, double& value, double& first_derivative, double& second_derivative)
+	{
+		double f = std::fmod(x, period);
+		if (f < 0)
+		{
+			f += period;
+		}
+
+		const double c0 = polynomial_coeffs.coeff(0);
+		const double c1 = polynomial_coeffs.coeff(1);
+		const double c2 = polynomial_coeffs.coeff(2);
+		const double c3 = polynomial_coeffs.coeff(3);
+		const double c4 = polynomial_coeffs.coeff(4);
+		const double c5 = polynomial_coeffs.coeff(5);
+
+		value = ((((c0 * f + c1) * f + c2) * f + c3) * f + c4) * f + c5;
+		first_derivative = (((5 * c0 * f + 4 * c1) * f + 3 * c2) * f + 2 * c3) * f + c4;
+		second_derivative = ((20 * c0 * f + 12 * c1) * f + 6 * c2) * f + 2 * c3;
+	}
+
 	/**
 	 * Getters
 	 */
@@ -140,39 +179,19 @@ private:
 	/**
 	 * Private overrides
 	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override
+	{
+		return std::make_shared<PeriodicObjective>(*this);
+	}
+
 	void CalculateDerivativesOuter(const double x, double& outer_value, double& outer_first_derivative, double& outer_second_derivative) override
 	{
-		double f = fmod(x, p_);
-		if (f < 0)
-		{
-			f += p_;
-		}
-		
-		const double f2 = f * f;
-		const double f3 = f2 * f;
-		const double f4 = f3 * f;
-		const double f5 = f4 * f;
-		
-		Eigen::VectorXd values(6);
-
-		values << f5, f4, f3, f2, f, 1;
-		outer_value = values.dot(polynomial_coeffs_);
-
-		values << 5 * f4, 4 * f3, 3 * f2, 2 * f, 1, 0;
-		outer_first_derivative = values.dot(polynomial_coeffs_);
-
-		values << 20 * f3, 12 * f2, 6 * f, 2, 0, 0;
-		outer_second_derivative = values.dot(polynomial_coeffs_);
+		CalculatePolynomialDerivatives(x, p_, polynomial_coeffs_, outer_value, outer_first_derivative, outer_second_derivative);
 	}
 	
 	/**
 	 * Private fields
 	 */
-	double hp_;
-	double hp2_;
-	double hp3_;
-	double hp4_;
-	double hp5_;
 	double p_;
 	double p2_;
 	double p3_;
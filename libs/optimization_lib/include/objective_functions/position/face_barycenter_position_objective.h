@@ -47,6 +47,11 @@ private:
 	/**
 	 * Private overrides
 	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override
+	{
+		return std::make_shared<FaceBarycenterPositionObjective>(*this);
+	}
+
 	int64_t CalculateVariableType(const int64_t objective_variable_index)
 	{
 		return objective_variable_index / this->objective_vertices_count_;
@@ -93,7 +98,7 @@ private:
 		}
 	}
 	
-	void CalculateRawTriplets(std::vector<Eigen::Triplet<double>>& triplets) override
+	void CalculateRawTriplets(const TripletsView& triplets) override
 	{
 		for (int64_t i = 0; i < this->objective_variables_count_; i++)
 		{
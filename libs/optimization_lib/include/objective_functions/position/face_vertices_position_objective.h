@@ -80,7 +80,7 @@
 //		}
 //	}
 //
-//	void CalculateRawTriplets(std::vector<Eigen::Triplet<double>>& triplets) override
+//	void CalculateRawTriplets(const TripletsView& triplets) override
 //	{
 //		for (int64_t i = 0; i < this->objective_variables_count_; i++)
 //		{
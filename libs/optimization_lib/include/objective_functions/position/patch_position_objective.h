@@ -45,6 +45,15 @@ public:
 			face_position_objective->MoveFacePosition(offset);
 		}
 	}
+
+private:
+	/**
+	 * Private overrides
+	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override
+	{
+		return std::make_shared<PatchPositionObjective>(*this);
+	}
 };
 
 #endif
\ No newline at end of file
@@ -4,9 +4,15 @@
 
 // STL includes
 #include <vector>
+#include <memory>
+#include <limits>
+#include <algorithm>
 
 // Optimization lib includes
 #include "../data_providers/plain_data_provider.h"
+#include "../solvers/shifted_laplacian_operator.h"
+#include "../solvers/mass_matrix_operator.h"
+#include "../solvers/laplacian_eigen_basis.h"
 #include "./dense_objective_function.h"
 
 // Spectra
@@ -17,6 +23,7 @@
 #include <Spectra/SymEigsSolver.h>
 #include <Spectra/SymGEigsSolver.h>
 #include <Spectra/MatOp/SparseCholesky.h>
+#include <Spectra/MatOp/SparseRegularInverse.h>
 
 template<Eigen::StorageOptions StorageOrder_>
 class RegionLocalizationObjective : public DenseObjectiveFunction<StorageOrder_>
@@ -37,24 +44,150 @@ public:
 	RegionLocalizationObjective(const std::shared_ptr<MeshDataProvider>& mesh_data_provider, const Eigen::VectorXd& mu, const std::shared_ptr<EmptyDataProvider>& empty_data_provider) :
 		DenseObjectiveFunction(mesh_data_provider, empty_data_provider, "Region Localization", 0, false),
 		mu_(mu),
-		tau_(10 * mu.coeff(0))
+		reduced_basis_tolerance_(1e-2),
+		reduced_basis_residual_(0),
+		reduced_basis_fallbacks_count_(0),
+		tau_(10 * mu.coeff(0)),
+		warm_start_enabled_(true),
+		eigen_solver_iterations_(0)
 	{
 		half_tau_ = tau_ / 2;
+		mass_matrix_op_ = mesh_data_provider->GetMassMatrixOperator();
+		if (mass_matrix_op_->IsDiagonal())
+		{
+			// Standard problem (A^-1/2 * W * A^-1/2 + diag(v)) * y = lambda * y
+			const auto& inverse_sqrt_diagonal = mass_matrix_op_->GetInverseSqrtDiagonal();
+			Eigen::SparseMatrix<double> W_scaled = inverse_sqrt_diagonal.asDiagonal() * mesh_data_provider->GetLaplacian() * inverse_sqrt_diagonal.asDiagonal();
+			Eigen::SparseMatrix<double> I(W_scaled.rows(), W_scaled.cols());
+			I.setIdentity();
+			lhs_op_ = std::make_unique<ShiftedLaplacianOperator>(W_scaled, I);
+		}
+		else
+		{
+			// Generalized problem (W + A * diag(v)) * x = lambda * A * x
+			lhs_op_ = std::make_unique<ShiftedLaplacianOperator>(mesh_data_provider->GetLaplacian(), mesh_data_provider->GetMassMatrix());
+		}
 		this->Initialize();
 	}
 
+	// The shifted operator is rewritten by each update, so the copy owns its own; the mass matrix operator and the reduced basis are read-only,
+	// and shared. The copy starts without a warm start basis, so its first solve does not depend on the updates of the original.
+	RegionLocalizationObjective(const RegionLocalizationObjective& other) :
+		DenseObjectiveFunction(other),
+		v_tanh_(other.v_tanh_),
+		v_(other.v_),
+		mu_(other.mu_),
+		lambda_(other.lambda_),
+		phi_(other.phi_),
+		lhs_op_(std::make_unique<ShiftedLaplacianOperator>(*other.lhs_op_)),
+		mass_matrix_op_(other.mass_matrix_op_),
+		reduced_basis_(other.reduced_basis_),
+		reduced_basis_tolerance_(other.reduced_basis_tolerance_),
+		reduced_basis_residual_(other.reduced_basis_residual_),
+		reduced_basis_fallbacks_count_(other.reduced_basis_fallbacks_count_),
+		sigma_(other.sigma_),
+		tau_(other.tau_),
+		half_tau_(other.half_tau_),
+		warm_start_enabled_(other.warm_start_enabled_),
+		eigen_solver_iterations_(other.eigen_solver_iterations_),
+		bla(other.bla)
+	{
+
+	}
+
 	virtual ~RegionLocalizationObjective()
 	{
 
 	}
 
+	/**
+	 * Computes the spectrum of a partial shape (the target spectrum mu of the localization), in the layout expected by the constructor
+	 */
+	static bool ComputeMu(const std::shared_ptr<MeshDataProvider>& partial_mesh_data_provider, Eigen::VectorXd& mu)
+	{
+		Spectra::SparseSymMatProd<double> lhs_op(partial_mesh_data_provider->GetLaplacian());
+		auto rhs_op = partial_mesh_data_provider->GetMassMatrixOperator();
+		Spectra::SymGEigsSolver<double, Spectra::SMALLEST_MAGN, Spectra::SparseSymMatProd<double>, MassMatrixOperator, Spectra::GEIGS_REGULAR_INVERSE> geigs(&lhs_op, rhs_op.get(), RDS_NEV, RDS_NCV);
+		geigs.init();
+		geigs.compute();
+		if (geigs.info() != Spectra::SUCCESSFUL)
+		{
+			return false;
+		}
+
+		mu = geigs.eigenvalues();
+		mu.conservativeResize(mu.rows() - 1);
+		return true;
+	}
+
 	/**
 	 * Setters
 	 */
+	void SetWarmStartEnabled(const bool warm_start_enabled)
+	{
+		warm_start_enabled_ = warm_start_enabled;
+	}
+
+	// Rayleigh-Ritz mode: each update solves the k x k problem projected onto the given basis of the full shape,
+	// and falls back to the sparse solve when the relative residual of the Ritz pairs exceeds the tolerance
+	void EnableReducedBasis(const std::shared_ptr<LaplacianEigenBasis>& reduced_basis)
+	{
+		if (!mass_matrix_op_->IsDiagonal())
+		{
+			throw std::exception("Reduced basis mode requires a lumped mass matrix");
+		}
+
+		if (reduced_basis->GetBasis().rows() != this->GetMeshDataProvider()->GetDomainVerticesCount() || reduced_basis->GetSize() < RDS_NEV)
+		{
+			throw std::exception("Reduced basis does not match the shape");
+		}
+
+		reduced_basis_ = reduced_basis;
+	}
+
+	void DisableReducedBasis()
+	{
+		reduced_basis_.reset();
+	}
+
+	void SetReducedBasisTolerance(const double reduced_basis_tolerance)
+	{
+		reduced_basis_tolerance_ = reduced_basis_tolerance;
+	}
 
 	/**
 	 * Getters
 	 */
+	bool GetReducedBasisEnabled() const
+	{
+		return reduced_basis_ != nullptr;
+	}
+
+	double GetReducedBasisTolerance() const
+	{
+		return reduced_basis_tolerance_;
+	}
+
+	double GetReducedBasisResidual() const
+	{
+		return reduced_basis_residual_;
+	}
+
+	int64_t GetReducedBasisFallbacksCount() const
+	{
+		return reduced_basis_fallbacks_count_;
+	}
+
+	bool GetWarmStartEnabled() const
+	{
+		return warm_start_enabled_;
+	}
+
+	int64_t GetEigenSolverIterations() const
+	{
+		return eigen_solver_iterations_;
+	}
+
 	double GetTau() const
 	{
 		return tau_;
@@ -75,6 +208,15 @@ public:
 		return lambda_;
 	}
 
+protected:
+	/**
+	 * Protected overrides
+	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override
+	{
+		return std::make_shared<RegionLocalizationObjective>(*this);
+	}
+
 private:
 
 	/**
@@ -140,27 +282,26 @@ private:
 		v_ = v;
 		v_tanh_ = v_.array().tanh();
 		sigma_ = half_tau_ * (v_tanh_ + Eigen::VectorXd::Ones(v_.rows()));
-		Eigen::SparseMatrix<double> diag_v = v_.asDiagonal().toDenseMatrix().sparseView();
-		Eigen::SparseMatrix<double> W = this->GetMeshDataProvider()->GetLaplacian();
-		Eigen::SparseMatrix<double> A = this->GetMeshDataProvider()->GetMassMatrix();
-		Eigen::SparseMatrix<double> lhs = W + A * diag_v;
-		Eigen::SparseMatrix<double> rhs = A;
-		Spectra::SparseSymMatProd<double> lhs_op(lhs);
-		Spectra::SparseCholesky<double> rhs_op(rhs);
-		Spectra::SymGEigsSolver<double, Spectra::SMALLEST_MAGN, Spectra::SparseSymMatProd<double>, Spectra::SparseCholesky<double>, Spectra::GEIGS_CHOLESKY> geigs(&lhs_op, &rhs_op, RDS_NEV, RDS_NCV);
-		
-		geigs.init();
-		int nconv = geigs.compute();
-		if (geigs.info() == Spectra::SUCCESSFUL)
+		lhs_op_->SetPotential(v_);
+
+		bool converged = false;
+		if (reduced_basis_)
 		{
-			lambda_ = geigs.eigenvalues();
-			lambda_.conservativeResize(lambda_.rows() - 1);
-			phi_ = geigs.eigenvectors();
-			phi_.conservativeResize(phi_.rows(), phi_.cols() - 1);
+			converged = ComputeReducedEigenPairs();
+			if (!converged)
+			{
+				reduced_basis_fallbacks_count_++;
+			}
 		}
-		else
+
+		if (!converged)
 		{
-			bla = geigs.info();
+			converged = ComputeSparseEigenPairs();
+		}
+
+		if (!converged)
+		{
+			warm_start_basis_.resize(0, 0);
 		}
 
 		//lambda_ = geigs.eigenvalues();
@@ -179,11 +320,145 @@ private:
 
 	}
 	
-	void CalculateRawTriplets(std::vector<Eigen::Triplet<double>>& triplets) override
+	void CalculateRawTriplets(const TripletsView& triplets) override
 	{
 
 	}
 	
+	/**
+	 * Private methods
+	 */
+	bool ComputeSparseEigenPairs()
+	{
+		const bool warm_start = warm_start_enabled_ && (warm_start_basis_.rows() == v_.rows()) && (warm_start_basis_.cols() == RDS_NEV);
+
+		// Seed Lanczos with the sum of the previous eigenvectors, so the first Krylov subspace already spans (almost) the whole requested eigenspace
+		Eigen::VectorXd init_resid;
+		if (warm_start)
+		{
+			init_resid = warm_start_basis_.rowwise().sum();
+		}
+
+		bool converged;
+		if (mass_matrix_op_->IsDiagonal())
+		{
+			// The eigenvectors are computed in y = A^1/2 * x coordinates, so the seed is mapped forward and the result is mapped back
+			Spectra::SymEigsSolver<double, Spectra::SMALLEST_MAGN, ShiftedLaplacianOperator> eigs(lhs_op_.get(), RDS_NEV, RDS_NCV);
+			if (warm_start)
+			{
+				init_resid = mass_matrix_op_->GetSqrtDiagonal().cwiseProduct(init_resid);
+			}
+
+			converged = ComputeEigenPairs(eigs, warm_start ? init_resid.data() : nullptr);
+			if (converged)
+			{
+				UpdateEigenPairs(eigs.eigenvalues(), mass_matrix_op_->GetInverseSqrtDiagonal().asDiagonal() * eigs.eigenvectors());
+			}
+			else
+			{
+				bla = eigs.info();
+			}
+		}
+		else
+		{
+			/**
+			 * The regular inverse mode runs Lanczos on B^-1 * A in the original coordinates (the Cholesky mode works on L^-1 * A * L^-T),
+			 * so the eigenvectors of the previous iteration can be fed back as an initial residual without any change of basis
+			 */
+			Spectra::SymGEigsSolver<double, Spectra::SMALLEST_MAGN, ShiftedLaplacianOperator, MassMatrixOperator, Spectra::GEIGS_REGULAR_INVERSE> geigs(lhs_op_.get(), mass_matrix_op_.get(), RDS_NEV, RDS_NCV);
+			converged = ComputeEigenPairs(geigs, warm_start ? init_resid.data() : nullptr);
+			if (converged)
+			{
+				UpdateEigenPairs(geigs.eigenvalues(), geigs.eigenvectors());
+			}
+			else
+			{
+				bla = geigs.info();
+			}
+		}
+
+		return converged;
+	}
+
+	bool ComputeReducedEigenPairs()
+	{
+		const auto& basis = reduced_basis_->GetBasis();
+		const auto& basis_eigenvalues = reduced_basis_->GetEigenvalues();
+
+		// In the standardized coordinates the shifted operator is Lambda + diag(v) on the span of the basis,
+		// so the projected matrix is Lambda + Psi^T * diag(v) * Psi
+		Eigen::MatrixXd projected = basis.transpose() * (v_.asDiagonal() * basis);
+		projected.diagonal() += basis_eigenvalues;
+
+		Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(projected);
+		if (solver.info() != Eigen::Success)
+		{
+			return false;
+		}
+
+		// Smallest RDS_NEV Ritz pairs, in the (descending) order the sparse solvers return them
+		const Eigen::VectorXd ritz_values = solver.eigenvalues().head(RDS_NEV).reverse();
+		const Eigen::MatrixXd ritz_vectors = basis * solver.eigenvectors().leftCols(RDS_NEV).rowwise().reverse();
+
+		// Residuals in the standardized coordinates are exactly the A^-1 norm of the generalized residuals
+		const double scale = std::max(ritz_values.cwiseAbs().maxCoeff(), std::numeric_limits<double>::min());
+		Eigen::VectorXd relative_residuals(RDS_NEV);
+
+		#pragma omp parallel for
+		for (int64_t i = 0; i < RDS_NEV; i++)
+		{
+			Eigen::VectorXd residual(ritz_vectors.rows());
+			lhs_op_->perform_op(ritz_vectors.col(i).data(), residual.data());
+			residual -= ritz_values.coeff(i) * ritz_vectors.col(i);
+			relative_residuals.coeffRef(i) = residual.norm() / scale;
+		}
+
+		reduced_basis_residual_ = relative_residuals.maxCoeff();
+		eigen_solver_iterations_ = 0;
+
+		// Either accept the Ritz pairs, or keep them as the seed of the sparse solve
+		const Eigen::MatrixXd eigenvectors = mass_matrix_op_->GetInverseSqrtDiagonal().asDiagonal() * ritz_vectors;
+		if (reduced_basis_residual_ > reduced_basis_tolerance_)
+		{
+			warm_start_basis_ = eigenvectors;
+			return false;
+		}
+
+		UpdateEigenPairs(ritz_values, eigenvectors);
+		return true;
+	}
+
+	template<typename EigenSolverType>
+	bool ComputeEigenPairs(EigenSolverType& eigen_solver, const double* init_resid)
+	{
+		bool converged = false;
+		if (init_resid != nullptr)
+		{
+			eigen_solver.init(init_resid);
+			eigen_solver.compute();
+			converged = eigen_solver.info() == Spectra::SUCCESSFUL;
+		}
+
+		if (!converged)
+		{
+			eigen_solver.init();
+			eigen_solver.compute();
+			converged = eigen_solver.info() == Spectra::SUCCESSFUL;
+		}
+
+		eigen_solver_iterations_ = eigen_solver.num_iterations();
+		return converged;
+	}
+
+	void UpdateEigenPairs(const Eigen::VectorXd& eigenvalues, const Eigen::MatrixXd& eigenvectors)
+	{
+		warm_start_basis_ = eigenvectors;
+		lambda_ = eigenvalues;
+		lambda_.conservativeResize(lambda_.rows() - 1);
+		phi_ = warm_start_basis_;
+		phi_.conservativeResize(phi_.rows(), phi_.cols() - 1);
+	}
+
 	/**
 	 * Fields
 	 */
@@ -192,9 +467,18 @@ private:
 	Eigen::VectorXd mu_;
 	Eigen::VectorXd lambda_;
 	Eigen::MatrixXd phi_;
+	Eigen::MatrixXd warm_start_basis_;
+	std::unique_ptr<ShiftedLaplacianOperator> lhs_op_;
+	std::shared_ptr<MassMatrixOperator> mass_matrix_op_;
+	std::shared_ptr<LaplacianEigenBasis> reduced_basis_;
+	double reduced_basis_tolerance_;
+	double reduced_basis_residual_;
+	int64_t reduced_basis_fallbacks_count_;
 	Eigen::VectorXd sigma_;
 	double tau_;
 	double half_tau_;
+	bool warm_start_enabled_;
+	int64_t eigen_solver_iterations_;
 	int bla;
 };
 
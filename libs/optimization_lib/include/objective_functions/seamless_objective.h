@@ -23,6 +23,7 @@
 #include "./edge_pair/edge_pair_length_objective.h"
 #include "./edge_pair/edge_pair_integer_translation_objective.h"
 #include "./edge_pair/edge_pair_translation_objective.h"
+#include "./edge_pair/edge_pair_field_objective.h"
 #include "../objective_functions/periodic_objective.h"
 
 template <Eigen::StorageOptions StorageOrder_>
@@ -39,7 +40,8 @@ public:
 		LengthValuePerEdge,
 		EdgeAngleWeight,
 		EdgeLengthWeight,
-		Interval
+		Interval,
+		BatchedEdgePairs
 	};
 	
 	/**
@@ -47,7 +49,11 @@ public:
 	 */
 	SeamlessObjective(const std::shared_ptr<MeshDataProvider>& mesh_data_provider, const std::shared_ptr<EmptyDataProvider>& empty_data_provider, const std::string& name, const bool enforce_children_psd = true) :
 		SummationObjective(mesh_data_provider, empty_data_provider, name, enforce_children_psd),
-		zeta_(1)
+		zeta_(1),
+		interval_(1),
+		batched_edge_pairs_(false),
+		edge_pair_field_triplets_valid_(false),
+		edge_pair_field_triplets_layout_version_(0)
 	{
 
 	}
@@ -73,8 +79,21 @@ public:
 			edge_pair_translation_objective->SetInterval(interval);
 		}
 
+		if (edge_pair_field_objective_)
+		{
+			edge_pair_field_objective_->SetInterval(interval);
+		}
+
 		interval_ = interval;
 	}
+
+	// When enabled, all the edge pairs are evaluated by a single EdgePairFieldObjective, instead of a tree of per-pair objectives.
+	// Takes effect on the next Initialize(); the edge weights and the interval are carried over.
+	void SetBatchedEdgePairs(const bool batched_edge_pairs)
+	{
+		batched_edge_pairs_ = batched_edge_pairs;
+		this->Invalidate();
+	}
 	
 	void SetZeta(const double zeta)
 	{
@@ -93,6 +112,13 @@ public:
 
 	void SetEdgeAngleWeight(const RDS::EdgeIndex edge_index, const double weight)
 	{
+		SyncEdgePairObjectives();
+		if (edge_pair_field_objective_)
+		{
+			edge_pair_field_objective_->SetEdgeAngleWeight(edge_index, weight);
+			return;
+		}
+
 		for (auto& periodic_edge_pair_angle_objective : periodic_edge_pair_angle_objectives)
 		{
 			auto edge_pair_angle_objective = std::dynamic_pointer_cast<EdgePairAngleObjective<StorageOrder_>>(periodic_edge_pair_angle_objective->GetInnerObjective());
@@ -105,6 +131,13 @@ public:
 
 	void SetEdgeLengthWeight(const RDS::EdgeIndex edge_index, const double weight)
 	{
+		SyncEdgePairObjectives();
+		if (edge_pair_field_objective_)
+		{
+			edge_pair_field_objective_->SetEdgeLengthWeight(edge_index, weight);
+			return;
+		}
+
 		for (auto& edge_pair_length_objective : edge_pair_length_objectives)
 		{
 			if (edge_pair_length_objective->GetEdgePairDataProvider().GetDomainEdgeIndex() == edge_index)
@@ -136,6 +169,9 @@ public:
 		case Properties::Interval:
 			SetInterval(std::any_cast<const double>(property_value));
 			return true;
+		case Properties::BatchedEdgePairs:
+			SetBatchedEdgePairs(std::any_cast<const bool>(property_value));
+			return true;
 		}
 
 		return false;
@@ -149,6 +185,16 @@ public:
 		return zeta_;
 	}
 
+	double GetInterval() const
+	{
+		return interval_;
+	}
+
+	bool GetBatchedEdgePairs() const
+	{
+		return batched_edge_pairs_;
+	}
+
 	const Eigen::VectorXd& SeamlessObjective::GetAngleValuePerEdge(const ObjectiveFunctionBase::PropertyModifiers property_modifiers) const
 	{
 		switch (property_modifiers)
@@ -193,6 +239,12 @@ public:
 
 	double GetEdgeAngleWeight(const RDS::EdgeIndex edge_index)
 	{
+		SyncEdgePairObjectives();
+		if (edge_pair_field_objective_)
+		{
+			return edge_pair_field_objective_->GetEdgeAngleWeight(edge_index);
+		}
+
 		for (auto& periodic_edge_pair_angle_objective : periodic_edge_pair_angle_objectives)
 		{
 			auto edge_pair_angle_objective = std::dynamic_pointer_cast<EdgePairAngleObjective<StorageOrder_>>(periodic_edge_pair_angle_objective->GetInnerObjective());
@@ -207,6 +259,12 @@ public:
 
 	double GetEdgeLengthWeight(const RDS::EdgeIndex edge_index)
 	{
+		SyncEdgePairObjectives();
+		if (edge_pair_field_objective_)
+		{
+			return edge_pair_field_objective_->GetEdgeLengthWeight(edge_index);
+		}
+
 		for (auto& edge_pair_length_objective : edge_pair_length_objectives)
 		{
 			if (edge_pair_length_objective->GetEdgePairDataProvider().GetDomainEdgeIndex() == edge_index)
@@ -244,6 +302,12 @@ public:
 		case Properties::EdgeLengthWeight:
 			property_value = GetEdgeLengthWeight(static_cast<RDS::EdgeIndex>(std::any_cast<double>(property_context)));
 			return true;
+		case Properties::Interval:
+			property_value = GetInterval();
+			return true;
+		case Properties::BatchedEdgePairs:
+			property_value = GetBatchedEdgePairs();
+			return true;
 		}
 
 		return false;
@@ -252,38 +316,43 @@ public:
 	/**
 	 * Public methods
 	 */	
+	// In batched mode, the edge pairs field objective is (re)built once all the edge pairs were added (see SyncEdgePairObjectives)
 	void AddEdgePairObjectives(const std::shared_ptr<EdgePairDataProvider>& edge_pair_data_provider)
-	{	
-		auto edge_pair_angle_objective = std::make_shared<EdgePairAngleObjective<StorageOrder_>>(this->GetMeshDataProvider(), edge_pair_data_provider, false);
-		auto edge_pair_length_objective = std::make_shared<EdgePairLengthObjective<StorageOrder_>>(this->GetMeshDataProvider(), edge_pair_data_provider, false);
-		auto edge_pair_translation_objective = std::make_shared<EdgePairTranslationObjective<StorageOrder_>>(this->GetMeshDataProvider(), edge_pair_data_provider, this->GetEnforceChildrenPsd());
-		auto edge_pair_integer_translation_objective = std::make_shared<EdgePairIntegerTranslationObjective<StorageOrder_>>(this->GetMeshDataProvider(), edge_pair_data_provider, this->GetEnforceChildrenPsd());
-
-		double period = M_PI / 2;
-		auto empty_data_provider = std::make_shared<EmptyDataProvider>(this->GetMeshDataProvider());
-		std::shared_ptr<PeriodicObjective<StorageOrder_>> periodic_edge_pair_angle_objective = std::make_shared<PeriodicObjective<StorageOrder_>>(this->GetMeshDataProvider(), empty_data_provider, edge_pair_angle_objective, period, this->GetEnforceChildrenPsd());
-
-		periodic_edge_pair_angle_objective->SetWeight(100);
-		edge_pair_length_objective->SetWeight(1);
-		edge_pair_translation_objective->SetWeight(1);
-		edge_pair_integer_translation_objective->SetWeight(1);
-		
-		this->AddObjectiveFunction(periodic_edge_pair_angle_objective);
-		this->AddObjectiveFunction(edge_pair_length_objective);
-		//this->AddObjectiveFunction(edge_pair_translation_objective);
-		this->AddObjectiveFunction(edge_pair_integer_translation_objective);
-		
-		periodic_edge_pair_angle_objectives.push_back(periodic_edge_pair_angle_objective);
-		edge_pair_length_objectives.push_back(edge_pair_length_objective);
-		edge_pair_angle_objectives.push_back(edge_pair_angle_objective);
-		edge_pair_integer_translation_objectives.push_back(edge_pair_integer_translation_objective);
-		edge_pair_translation_objectives.push_back(edge_pair_translation_objective);
+	{
+		edge_pair_data_providers_.push_back(edge_pair_data_provider);
+		if (!batched_edge_pairs_)
+		{
+			SyncEdgePairObjectives();
+		}
 	}
 
 protected:
 	/**
 	 * Protected overrides
 	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override
+	{
+		return std::make_shared<SeamlessObjective>(*this);
+	}
+
+	void RemapDependencies(const UpdatableObject::CloneMap& clones) override
+	{
+		SummationObjective<ObjectiveFunction<StorageOrder_, Eigen::SparseVector<double>>, Eigen::VectorXd>::RemapDependencies(clones);
+		RemapObjectives(edge_pair_length_objectives, clones);
+		RemapObjectives(edge_pair_angle_objectives, clones);
+		RemapObjectives(periodic_edge_pair_angle_objectives, clones);
+		RemapObjectives(edge_pair_integer_translation_objectives, clones);
+		RemapObjectives(edge_pair_translation_objectives, clones);
+		RemapObjectives(edge_pair_data_providers_, clones);
+		edge_pair_field_objective_ = UpdatableObject::Remap(edge_pair_field_objective_, clones);
+	}
+
+	void PreInitialize() override
+	{
+		SyncEdgePairObjectives();
+		SummationObjective<ObjectiveFunction<StorageOrder_, Eigen::SparseVector<double>>, Eigen::VectorXd>::PreInitialize();
+	}
+
 	void PostInitialize() override
 	{
 		SummationObjective<ObjectiveFunction<StorageOrder_, Eigen::SparseVector<double>>, Eigen::VectorXd>::PostInitialize();
@@ -298,17 +367,236 @@ private:
 	/**
 	 * Private overrides
 	 */
+	void CalculateValue(double& f) override
+	{
+		if (edge_pair_field_objective_)
+		{
+			f = edge_pair_field_objective_->GetValue();
+			return;
+		}
+
+		SummationObjective<ObjectiveFunction<StorageOrder_, Eigen::SparseVector<double>>, Eigen::VectorXd>::CalculateValue(f);
+	}
+
+	void CalculateValuePerVertex(Eigen::VectorXd& f_per_vertex) override
+	{
+		if (edge_pair_field_objective_)
+		{
+			f_per_vertex = edge_pair_field_objective_->GetValuePerVertex();
+			return;
+		}
+
+		SummationObjective<ObjectiveFunction<StorageOrder_, Eigen::SparseVector<double>>, Eigen::VectorXd>::CalculateValuePerVertex(f_per_vertex);
+	}
+
 	void CalculateValuePerEdge(Eigen::VectorXd& domain_value_per_edge, Eigen::VectorXd& image_value_per_edge) override
 	{
-		CalculateAngleValuePerEdge(domain_angle_value_per_edge_, image_angle_value_per_edge_);
-		CalculateLengthValuePerEdge(domain_length_value_per_edge_, image_length_value_per_edge_);
- 		domain_value_per_edge = domain_angle_value_per_edge_ + domain_length_value_per_edge_;
+		if (edge_pair_field_objective_)
+		{
+			domain_angle_value_per_edge_ = edge_pair_field_objective_->GetAngleValuePerEdge(ObjectiveFunctionBase::PropertyModifiers::Domain);
+			image_angle_value_per_edge_ = edge_pair_field_objective_->GetAngleValuePerEdge(ObjectiveFunctionBase::PropertyModifiers::Image);
+			domain_length_value_per_edge_ = edge_pair_field_objective_->GetLengthValuePerEdge(ObjectiveFunctionBase::PropertyModifiers::Domain);
+			image_length_value_per_edge_ = edge_pair_field_objective_->GetLengthValuePerEdge(ObjectiveFunctionBase::PropertyModifiers::Image);
+		}
+		else
+		{
+			CalculateAngleValuePerEdge(domain_angle_value_per_edge_, image_angle_value_per_edge_);
+			CalculateLengthValuePerEdge(domain_length_value_per_edge_, image_length_value_per_edge_);
+		}
+
+		domain_value_per_edge = domain_angle_value_per_edge_ + domain_length_value_per_edge_;
 		image_value_per_edge = image_angle_value_per_edge_ + image_length_value_per_edge_;
 	}
-	
+
+	void CalculateGradient(Eigen::VectorXd& g) override
+	{
+		if (edge_pair_field_objective_)
+		{
+			g = edge_pair_field_objective_->GetGradient();
+			return;
+		}
+
+		SummationObjective<ObjectiveFunction<StorageOrder_, Eigen::SparseVector<double>>, Eigen::VectorXd>::CalculateGradient(g);
+	}
+
+	// The field objective keeps its triplets layout, so after the first copy only the values are copied
+	void CalculateTriplets(std::vector<Eigen::Triplet<double>>& triplets) override
+	{
+		if (!edge_pair_field_objective_)
+		{
+			SummationObjective<ObjectiveFunction<StorageOrder_, Eigen::SparseVector<double>>, Eigen::VectorXd>::CalculateTriplets(triplets);
+			return;
+		}
+
+		const auto& edge_pair_field_triplets = edge_pair_field_objective_->GetTriplets();
+		if (!edge_pair_field_triplets_valid_ || edge_pair_field_triplets_layout_version_ != edge_pair_field_objective_->GetTripletsLayoutVersion())
+		{
+			triplets = edge_pair_field_triplets;
+			edge_pair_field_triplets_valid_ = true;
+			edge_pair_field_triplets_layout_version_ = edge_pair_field_objective_->GetTripletsLayoutVersion();
+			this->InvalidateHessianPattern();
+			return;
+		}
+
+		const int64_t triplets_count = triplets.size();
+		#pragma omp parallel for
+		for (int64_t i = 0; i < triplets_count; i++)
+		{
+			const_cast<double&>(triplets[i].value()) = edge_pair_field_triplets[i].value();
+		}
+	}
+
 	/**
 	 * Private methods
 	 */
+	// Brings the evaluated objectives in line with the edge pairs and the batched mode: builds the tree objectives of edge pairs that were added
+	// since, or (in batched mode) rebuilds the field objective when the edge pairs changed. The edge weights are carried over by edge pair index.
+	void SyncEdgePairObjectives()
+	{
+		const std::size_t edge_pairs_count = edge_pair_data_providers_.size();
+		Eigen::ArrayXd edge_angle_weights = Eigen::ArrayXd::Ones(edge_pairs_count);
+		Eigen::ArrayXd edge_length_weights = Eigen::ArrayXd::Ones(edge_pairs_count);
+		if (batched_edge_pairs_)
+		{
+			const bool field_valid = edge_pairs_count == 0 || (edge_pair_field_objective_ && edge_pair_field_objective_->GetEdgePairsCount() == static_cast<int64_t>(edge_pairs_count));
+			if (field_valid && edge_pair_length_objectives.empty())
+			{
+				return;
+			}
+
+			GetEdgeWeights(edge_angle_weights, edge_length_weights);
+			RemoveEdgePairTreeObjectives();
+			RemoveEdgePairFieldObjective();
+			if (edge_pairs_count > 0)
+			{
+				RDS::EdgePairDescriptors edge_pair_descriptors;
+				edge_pair_descriptors.reserve(edge_pairs_count);
+				for (const auto& edge_pair_data_provider : edge_pair_data_providers_)
+				{
+					edge_pair_descriptors.push_back(edge_pair_data_provider->GetEdgePairDescriptor());
+				}
+
+				auto empty_data_provider = std::make_shared<EmptyDataProvider>(this->GetMeshDataProvider());
+				edge_pair_field_objective_ = std::make_shared<EdgePairFieldObjective<StorageOrder_>>(this->GetMeshDataProvider(), empty_data_provider, edge_pair_descriptors, this->GetEnforceChildrenPsd());
+				edge_pair_field_objective_->SetInterval(interval_);
+				edge_pair_field_objective_->SetEdgeAngleWeights(edge_angle_weights);
+				edge_pair_field_objective_->SetEdgeLengthWeights(edge_length_weights);
+				this->dependencies_.push_back(edge_pair_field_objective_);
+			}
+		}
+		else
+		{
+			if (!edge_pair_field_objective_ && edge_pair_length_objectives.size() == edge_pairs_count)
+			{
+				return;
+			}
+
+			GetEdgeWeights(edge_angle_weights, edge_length_weights);
+			RemoveEdgePairFieldObjective();
+			for (std::size_t i = edge_pair_length_objectives.size(); i < edge_pairs_count; i++)
+			{
+				AddEdgePairTreeObjectives(edge_pair_data_providers_[i], edge_angle_weights.coeff(i), edge_length_weights.coeff(i));
+			}
+		}
+
+		edge_pair_field_triplets_valid_ = false;
+		this->InvalidateHessianPattern();
+		this->Invalidate();
+	}
+
+	// The edge weights of the objectives that are currently evaluated (by edge pair index; pairs without an objective keep their weights)
+	void GetEdgeWeights(Eigen::ArrayXd& edge_angle_weights, Eigen::ArrayXd& edge_length_weights) const
+	{
+		if (edge_pair_field_objective_)
+		{
+			const auto edge_pairs_count = std::min(edge_angle_weights.size(), edge_pair_field_objective_->GetEdgeAngleWeights().size());
+			edge_angle_weights.head(edge_pairs_count) = edge_pair_field_objective_->GetEdgeAngleWeights().head(edge_pairs_count);
+			edge_length_weights.head(edge_pairs_count) = edge_pair_field_objective_->GetEdgeLengthWeights().head(edge_pairs_count);
+			return;
+		}
+
+		const auto edge_pairs_count = std::min(static_cast<std::size_t>(edge_angle_weights.size()), edge_pair_length_objectives.size());
+		for (std::size_t i = 0; i < edge_pairs_count; i++)
+		{
+			edge_angle_weights.coeffRef(i) = edge_pair_angle_objectives[i]->GetWeight();
+			edge_length_weights.coeffRef(i) = edge_pair_length_objectives[i]->GetWeight();
+		}
+	}
+
+	void AddEdgePairTreeObjectives(const std::shared_ptr<EdgePairDataProvider>& edge_pair_data_provider, const double angle_weight, const double length_weight)
+	{
+		auto edge_pair_angle_objective = std::make_shared<EdgePairAngleObjective<StorageOrder_>>(this->GetMeshDataProvider(), edge_pair_data_provider, false);
+		auto edge_pair_length_objective = std::make_shared<EdgePairLengthObjective<StorageOrder_>>(this->GetMeshDataProvider(), edge_pair_data_provider, false);
+		auto edge_pair_translation_objective = std::make_shared<EdgePairTranslationObjective<StorageOrder_>>(this->GetMeshDataProvider(), edge_pair_data_provider, this->GetEnforceChildrenPsd());
+		auto edge_pair_integer_translation_objective = std::make_shared<EdgePairIntegerTranslationObjective<StorageOrder_>>(this->GetMeshDataProvider(), edge_pair_data_provider, this->GetEnforceChildrenPsd());
+
+		double period = M_PI / 2;
+		auto empty_data_provider = std::make_shared<EmptyDataProvider>(this->GetMeshDataProvider());
+		std::shared_ptr<PeriodicObjective<StorageOrder_>> periodic_edge_pair_angle_objective = std::make_shared<PeriodicObjective<StorageOrder_>>(this->GetMeshDataProvider(), empty_data_provider, edge_pair_angle_objective, period, this->GetEnforceChildrenPsd());
+
+		periodic_edge_pair_angle_objective->SetWeight(100);
+		edge_pair_angle_objective->SetWeight(angle_weight);
+		edge_pair_length_objective->SetWeight(length_weight);
+		edge_pair_translation_objective->SetWeight(1);
+		edge_pair_integer_translation_objective->SetWeight(1);
+		edge_pair_integer_translation_objective->SetInterval(interval_);
+
+		this->AddObjectiveFunction(periodic_edge_pair_angle_objective);
+		this->AddObjectiveFunction(edge_pair_length_objective);
+		//this->AddObjectiveFunction(edge_pair_translation_objective);
+		this->AddObjectiveFunction(edge_pair_integer_translation_objective);
+
+		periodic_edge_pair_angle_objectives.push_back(periodic_edge_pair_angle_objective);
+		edge_pair_length_objectives.push_back(edge_pair_length_objective);
+		edge_pair_angle_objectives.push_back(edge_pair_angle_objective);
+		edge_pair_integer_translation_objectives.push_back(edge_pair_integer_translation_objective);
+		edge_pair_translation_objectives.push_back(edge_pair_translation_objective);
+	}
+
+	void RemoveEdgePairTreeObjectives()
+	{
+		std::vector<std::shared_ptr<ObjectiveFunction<StorageOrder_, Eigen::SparseVector<double>>>> objective_functions;
+		objective_functions.insert(objective_functions.end(), periodic_edge_pair_angle_objectives.begin(), periodic_edge_pair_angle_objectives.end());
+		objective_functions.insert(objective_functions.end(), edge_pair_length_objectives.begin(), edge_pair_length_objectives.end());
+		objective_functions.insert(objective_functions.end(), edge_pair_integer_translation_objectives.begin(), edge_pair_integer_translation_objectives.end());
+		this->RemoveObjectiveFunctions(objective_functions);
+
+		edge_pair_length_objectives.clear();
+		edge_pair_angle_objectives.clear();
+		periodic_edge_pair_angle_objectives.clear();
+		edge_pair_integer_translation_objectives.clear();
+		edge_pair_translation_objectives.clear();
+	}
+
+	void RemoveEdgePairFieldObjective()
+	{
+		if (!edge_pair_field_objective_)
+		{
+			return;
+		}
+
+		tbb::concurrent_vector<std::shared_ptr<UpdatableObject>> dependencies;
+		for (const auto& dependency : this->dependencies_)
+		{
+			if (dependency != edge_pair_field_objective_)
+			{
+				dependencies.push_back(dependency);
+			}
+		}
+
+		this->dependencies_ = dependencies;
+		edge_pair_field_objective_ = nullptr;
+	}
+
+	template<typename ObjectiveFunctionType_>
+	static void RemapObjectives(tbb::concurrent_vector<std::shared_ptr<ObjectiveFunctionType_>>& objective_functions, const UpdatableObject::CloneMap& clones)
+	{
+		for (auto& objective_function : objective_functions)
+		{
+			objective_function = UpdatableObject::Remap(objective_function, clones);
+		}
+	}
+
 	void CalculateAngleValuePerEdge(Eigen::VectorXd& domain_angle_value_per_edge, Eigen::VectorXd& image_angle_value_per_edge)
 	{
 		domain_angle_value_per_edge.setZero();
@@ -349,11 +637,18 @@ private:
 	 */
 	double zeta_;
 	double interval_;
+	bool batched_edge_pairs_;
+	tbb::concurrent_vector<std::shared_ptr<EdgePairDataProvider>> edge_pair_data_providers_;
 	tbb::concurrent_vector<std::shared_ptr<EdgePairLengthObjective<StorageOrder_>>> edge_pair_length_objectives;
 	tbb::concurrent_vector<std::shared_ptr<EdgePairAngleObjective<StorageOrder_>>> edge_pair_angle_objectives;
 	tbb::concurrent_vector<std::shared_ptr<PeriodicObjective<StorageOrder_>>> periodic_edge_pair_angle_objectives;
 	tbb::concurrent_vector<std::shared_ptr<EdgePairIntegerTranslationObjective<StorageOrder_>>> edge_pair_integer_translation_objectives;
 	tbb::concurrent_vector<std::shared_ptr<EdgePairTranslationObjective<StorageOrder_>>> edge_pair_translation_objectives;
+
+	// Batched mode
+	std::shared_ptr<EdgePairFieldObjective<StorageOrder_>> edge_pair_field_objective_;
+	bool edge_pair_field_triplets_valid_;
+	uint64_t edge_pair_field_triplets_layout_version_;
 	
 	Eigen::VectorXd image_angle_value_per_edge_;
 	Eigen::VectorXd image_length_value_per_edge_;
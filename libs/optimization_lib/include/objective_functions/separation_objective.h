@@ -19,7 +19,8 @@ public:
 	enum class Properties : int32_t
 	{
 		Delta = DenseObjectiveFunction<StorageOrder_>::Properties::Count_,
-		ValuePerEdge
+		ValuePerEdge,
+		FusedKernel
 	};
 	
 	/**
@@ -42,6 +43,16 @@ public:
 	void SetDelta(const double delta)
 	{
 		delta_ = delta;
+		pairs_version = 0;
+		this->Invalidate();
+	}
+
+	// When disabled, the energy is evaluated through the sparse products of the corresponding vertex pairs coefficients matrix (kept for verification)
+	void SetFusedKernel(const bool fused_kernel)
+	{
+		fused_kernel_ = fused_kernel;
+		pairs_version = 0;
+		this->Invalidate();
 	}
 
 	bool SetProperty(const int32_t property_id, const std::any property_context, const std::any property_value) override
@@ -57,6 +68,9 @@ public:
 		case Properties::Delta:
 			SetDelta(std::any_cast<const double>(property_value));
 			return true;
+		case Properties::FusedKernel:
+			SetFusedKernel(std::any_cast<const bool>(property_value));
+			return true;
 		}
 
 		return false;
@@ -70,6 +84,11 @@ public:
 		return delta_;
 	}
 
+	bool GetFusedKernel() const
+	{
+		return fused_kernel_;
+	}
+
 	bool GetProperty(const int32_t property_id, const int32_t property_modifier_id, const std::any property_context, std::any& property_value) override
 	{
 		if (DenseObjectiveFunction<StorageOrder_>::GetProperty(property_id, property_modifier_id, property_context, property_value))
@@ -83,6 +102,9 @@ public:
 		case Properties::Delta:
 			property_value = GetDelta();
 			return true;
+		case Properties::FusedKernel:
+			property_value = GetFusedKernel();
+			return true;
 		}
 
 		return false;
@@ -93,48 +115,44 @@ private:
 	/**
 	 * Overrides
 	 */
-	void CalculateValue(double& f) override
+	std::shared_ptr<UpdatableObject> CloneObject() const override
 	{
-		EsepP = Esep * X;
+		return std::make_shared<Separation>(*this);
+	}
 
-		EsepP_squared.resize(EsepP.rows(), 2);
-		
-		int rows = EsepP.rows();
-		
-		#pragma omp parallel for
-		for(int i = 0; i < rows; i++)
+	void CalculateValue(double& f) override
+	{
+		if (!fused_kernel_)
 		{
-			EsepP_squared.coeffRef(i, 0) = EsepP.coeffRef(i, 0) * EsepP.coeffRef(i, 0);
-			EsepP_squared.coeffRef(i, 1) = EsepP.coeffRef(i, 1) * EsepP.coeffRef(i, 1);
+			CalculateValueSparseProducts(f);
+			return;
 		}
-		
-		EsepP_squared_rowwise_sum = EsepP_squared.rowwise().sum();
-		EsepP_squared_rowwise_sum_plus_delta = EsepP_squared_rowwise_sum.array() + delta_;
-		f_per_pair = EsepP_squared_rowwise_sum.cwiseQuotient(EsepP_squared_rowwise_sum_plus_delta);
-
-		// add edge length factor
-		f_per_pair = f_per_pair.cwiseProduct(edge_lenghts_per_pair);
 
-		// sum everything up
+		UpdatePairs();
 		f = f_per_pair.sum();
 	}
 
 	void CalculateValuePerVertex(Eigen::VectorXd& f_per_vertex) override
 	{
-		f_per_vertex.setZero();
-		int64_t vertex1_index;
-		int64_t vertex2_index;
-		
+		if (!fused_kernel_)
+		{
+			CalculateValuePerVertexSparseProducts(f_per_vertex);
+			return;
+		}
+
+		UpdatePairs();
+		const int64_t vertices_count = static_cast<int64_t>(vertex_pairs_offsets.size()) - 1;
+
 		#pragma omp parallel for
-		for (int i = 0; i < Esept.outerSize(); ++i)
+		for (int64_t i = 0; i < vertices_count; i++)
 		{
-			// no inner loop because there are only 2 nnz values per col
-			Eigen::SparseMatrix<double>::InnerIterator it(Esept, i);
-			int64_t vertex1_index = it.row();
-			int64_t vertex2_index = (++it).row();
+			double value = 0;
+			for (int64_t j = vertex_pairs_offsets[i]; j < vertex_pairs_offsets[i + 1]; j++)
+			{
+				value += pair_squared_lengths(vertex_pairs[j] >> 1);
+			}
 
-			f_per_vertex.coeffRef(vertex1_index) += EsepP_squared_rowwise_sum[i];
-			f_per_vertex.coeffRef(vertex2_index) += EsepP_squared_rowwise_sum[i];
+			f_per_vertex.coeffRef(i) = value;
 		}
 	}
 
@@ -145,17 +163,44 @@ private:
 	
 	void CalculateGradient(Eigen::VectorXd& g) override
 	{
-		Eigen::MatrixX2d ge;
-		Eigen::VectorXd d_vec = Eigen::VectorXd::Constant(EsepP_squared_rowwise_sum.rows(), delta_);
-		Eigen::VectorXd x_plus_d = EsepP_squared_rowwise_sum + d_vec;
-		Eigen::VectorXd d = d_vec.cwiseQuotient(x_plus_d.cwiseAbs2());
-		ge = 2.0 * Esept * d.cwiseProduct(edge_lenghts_per_pair).asDiagonal() * EsepP;
-		g = Eigen::Map<Eigen::VectorXd>(ge.data(), 2.0 * ge.rows(), 1);
+		if (!fused_kernel_)
+		{
+			CalculateGradientSparseProducts(g);
+			return;
+		}
+
+		UpdatePairs();
+		const int64_t vertices_count = static_cast<int64_t>(vertex_pairs_offsets.size()) - 1;
+		g.resize(2 * vertices_count);
+
+		// Each vertex gathers the gradients of its pairs (negated where it is the second vertex of the pair), so the vertices are summed up in parallel without conflicts
+		#pragma omp parallel for
+		for (int64_t i = 0; i < vertices_count; i++)
+		{
+			double gx = 0;
+			double gy = 0;
+			for (int64_t j = vertex_pairs_offsets[i]; j < vertex_pairs_offsets[i + 1]; j++)
+			{
+				const int64_t pair_index = vertex_pairs[j] >> 1;
+				const double sign = (vertex_pairs[j] & 1) ? -1 : 1;
+				gx += sign * pair_gradients(pair_index, 0);
+				gy += sign * pair_gradients(pair_index, 1);
+			}
+
+			g.coeffRef(i) = gx;
+			g.coeffRef(i + vertices_count) = gy;
+		}
 	}
 	
+	// The per pair intermediates are kept as long as x does not change (e.g. a value update followed by a full update at the same x)
 	void PreUpdate(const Eigen::VectorXd& x) override
 	{
-		X = Eigen::Map<const Eigen::MatrixX2d>(x.data(), x.rows() >> 1, 2);
+		const Eigen::Map<const Eigen::MatrixX2d> X_new(x.data(), x.rows() >> 1, 2);
+		if (X.rows() != X_new.rows() || X != X_new)
+		{
+			X = X_new;
+			x_version++;
+		}
 	}
 	
 	void PreInitialize() override
@@ -168,6 +213,9 @@ private:
 		Esep = this->mesh_data_provider_->GetCorrespondingVertexPairsCoefficients();
 		Esept = Esep.transpose();
 		edge_lenghts_per_pair = this->mesh_data_provider_->GetCorrespondingVertexPairsEdgeLength();
+
+		InitializePairs();
+		x_version++;
 	}
 	
 	void InitializeTriplets(std::vector<Eigen::Triplet<double>>& triplets) override
@@ -206,7 +254,169 @@ private:
 		}
 	}
 	
-	void CalculateRawTriplets(std::vector<Eigen::Triplet<double>>& triplets) override
+	void CalculateRawTriplets(const TripletsView& triplets) override
+	{
+		if (!fused_kernel_)
+		{
+			CalculateRawTripletsSparseProducts(triplets);
+			return;
+		}
+
+		UpdatePairs();
+		const int64_t pairs_count = pair_hessian_scales.rows();
+
+		// Each 4x4 hessian is (scale * Esep4), whose upper triangle (in column order, see InitializeTriplets) holds zeros and +/- scale
+		#pragma omp parallel for simd
+		for (int64_t i = 0; i < pairs_count; i++)
+		{
+			const double scale = pair_hessian_scales(i);
+			const_cast<double&>(triplets[10 * i + 0].value()) = scale;
+			const_cast<double&>(triplets[10 * i + 1].value()) = 0;
+			const_cast<double&>(triplets[10 * i + 2].value()) = scale;
+			const_cast<double&>(triplets[10 * i + 3].value()) = -scale;
+			const_cast<double&>(triplets[10 * i + 4].value()) = 0;
+			const_cast<double&>(triplets[10 * i + 5].value()) = scale;
+			const_cast<double&>(triplets[10 * i + 6].value()) = 0;
+			const_cast<double&>(triplets[10 * i + 7].value()) = -scale;
+			const_cast<double&>(triplets[10 * i + 8].value()) = 0;
+			const_cast<double&>(triplets[10 * i + 9].value()) = scale;
+		}
+	}
+	
+	/**
+	 * Private methods
+	 */
+
+	// Vertex -> the pairs it belongs to (in CSR layout), where each entry is (2 * pair index), plus one if the vertex is the second vertex of the pair
+	void InitializePairs()
+	{
+		const auto& cv_pairs = this->mesh_data_provider_->GetCorrespondingVertexPairs();
+		const int64_t pairs_count = cv_pairs.size();
+		const int64_t vertices_count = this->mesh_data_provider_->GetImageVerticesCount();
+
+		pair_vertices.resize(pairs_count, 2);
+		vertex_pairs_offsets.assign(vertices_count + 1, 0);
+		for (int64_t i = 0; i < pairs_count; i++)
+		{
+			pair_vertices(i, 0) = cv_pairs[i].first;
+			pair_vertices(i, 1) = cv_pairs[i].second;
+			vertex_pairs_offsets[cv_pairs[i].first + 1]++;
+			vertex_pairs_offsets[cv_pairs[i].second + 1]++;
+		}
+
+		for (int64_t i = 0; i < vertices_count; i++)
+		{
+			vertex_pairs_offsets[i + 1] += vertex_pairs_offsets[i];
+		}
+
+		std::vector<int64_t> vertex_pairs_counts(vertices_count, 0);
+		vertex_pairs.resize(2 * pairs_count);
+		for (int64_t i = 0; i < pairs_count; i++)
+		{
+			for (int64_t j = 0; j < 2; j++)
+			{
+				const int64_t vertex_index = pair_vertices(i, j);
+				vertex_pairs[vertex_pairs_offsets[vertex_index] + vertex_pairs_counts[vertex_index]++] = (2 * i) + j;
+			}
+		}
+
+		f_per_pair.resize(pairs_count);
+		pair_squared_lengths.resize(pairs_count);
+		pair_gradients.resize(pairs_count, 2);
+		pair_hessian_scales.resize(pairs_count);
+		pairs_version = 0;
+	}
+
+	// Value, gradient (w.r.t. the first vertex) and hessian scale of each pair, evaluated directly from the pair's vertices in a single pass:
+	// for d = xi - xj and t = ||d||^2, the value is l * t / (t + delta), the gradient is 2 * l * delta / (t + delta)^2 * d,
+	// and the hessian is l * delta / (t / 2 + delta)^2 * Esep4 (see FindSingleHessian)
+	void UpdatePairs()
+	{
+		if (pairs_version == x_version)
+		{
+			return;
+		}
+
+		const int64_t pairs_count = pair_vertices.rows();
+		const double delta = delta_;
+
+		#pragma omp parallel for simd
+		for (int64_t i = 0; i < pairs_count; i++)
+		{
+			const double dx = X(pair_vertices(i, 0), 0) - X(pair_vertices(i, 1), 0);
+			const double dy = X(pair_vertices(i, 0), 1) - X(pair_vertices(i, 1), 1);
+			const double t = (dx * dx) + (dy * dy);
+			const double t_plus_delta = t + delta;
+			const double half_t_plus_delta = (0.5 * t) + delta;
+			const double edge_length = edge_lenghts_per_pair(i);
+			const double gradient_scale = 2.0 * (delta / (t_plus_delta * t_plus_delta)) * edge_length;
+
+			pair_squared_lengths(i) = t;
+			f_per_pair(i) = (t / t_plus_delta) * edge_length;
+			pair_gradients(i, 0) = gradient_scale * dx;
+			pair_gradients(i, 1) = gradient_scale * dy;
+			pair_hessian_scales(i) = (delta / (half_t_plus_delta * half_t_plus_delta)) * edge_length;
+		}
+
+		pairs_version = x_version;
+	}
+
+	void CalculateValueSparseProducts(double& f)
+	{
+		EsepP = Esep * X;
+
+		EsepP_squared.resize(EsepP.rows(), 2);
+		
+		int rows = EsepP.rows();
+		
+		#pragma omp parallel for
+		for(int i = 0; i < rows; i++)
+		{
+			EsepP_squared.coeffRef(i, 0) = EsepP.coeffRef(i, 0) * EsepP.coeffRef(i, 0);
+			EsepP_squared.coeffRef(i, 1) = EsepP.coeffRef(i, 1) * EsepP.coeffRef(i, 1);
+		}
+		
+		EsepP_squared_rowwise_sum = EsepP_squared.rowwise().sum();
+		EsepP_squared_rowwise_sum_plus_delta = EsepP_squared_rowwise_sum.array() + delta_;
+		f_per_pair = EsepP_squared_rowwise_sum.cwiseQuotient(EsepP_squared_rowwise_sum_plus_delta);
+
+		// add edge length factor
+		f_per_pair = f_per_pair.cwiseProduct(edge_lenghts_per_pair);
+
+		// sum everything up
+		f = f_per_pair.sum();
+	}
+
+	void CalculateValuePerVertexSparseProducts(Eigen::VectorXd& f_per_vertex)
+	{
+		f_per_vertex.setZero();
+		int64_t vertex1_index;
+		int64_t vertex2_index;
+		
+		#pragma omp parallel for
+		for (int i = 0; i < Esept.outerSize(); ++i)
+		{
+			// no inner loop because there are only 2 nnz values per col
+			Eigen::SparseMatrix<double>::InnerIterator it(Esept, i);
+			int64_t vertex1_index = it.row();
+			int64_t vertex2_index = (++it).row();
+
+			f_per_vertex.coeffRef(vertex1_index) += EsepP_squared_rowwise_sum[i];
+			f_per_vertex.coeffRef(vertex2_index) += EsepP_squared_rowwise_sum[i];
+		}
+	}
+
+	void CalculateGradientSparseProducts(Eigen::VectorXd& g)
+	{
+		Eigen::MatrixX2d ge;
+		Eigen::VectorXd d_vec = Eigen::VectorXd::Constant(EsepP_squared_rowwise_sum.rows(), delta_);
+		Eigen::VectorXd x_plus_d = EsepP_squared_rowwise_sum + d_vec;
+		Eigen::VectorXd d = d_vec.cwiseQuotient(x_plus_d.cwiseAbs2());
+		ge = 2.0 * Esept * d.cwiseProduct(edge_lenghts_per_pair).asDiagonal() * EsepP;
+		g = Eigen::Map<Eigen::VectorXd>(ge.data(), 2.0 * ge.rows(), 1);
+	}
+
+	void CalculateRawTripletsSparseProducts(const TripletsView& triplets)
 	{
 		// no inner loop because there are only 2 nnz values per col
 		#pragma omp parallel for
@@ -240,10 +450,7 @@ private:
 			}
 		}
 	}
-	
-	/**
-	 * Private methods
-	 */
+
 	void FindSingleHessian(const Eigen::Vector2d& xi, const Eigen::Vector2d& xj, Eigen::Matrix4d& H)
 	{
 		bool speedup = true;
@@ -280,6 +487,19 @@ private:
 	Eigen::VectorXd edge_lenghts_per_pair;
 	Eigen::VectorXd EsepP_squared_rowwise_sum;
 	Eigen::VectorXd EsepP_squared_rowwise_sum_plus_delta;
+
+	// Fused kernel
+	bool fused_kernel_ = true;
+	Eigen::Matrix<int64_t, Eigen::Dynamic, 2> pair_vertices;
+	std::vector<int64_t> vertex_pairs_offsets;
+	std::vector<int64_t> vertex_pairs;
+	Eigen::VectorXd pair_squared_lengths;
+	Eigen::MatrixX2d pair_gradients;
+	Eigen::VectorXd pair_hessian_scales;
+
+	// Version of X, and the version the per pair intermediates were computed for
+	uint64_t x_version = 0;
+	uint64_t pairs_version = 0;
 };
 
 #endif
\ No newline at end of file
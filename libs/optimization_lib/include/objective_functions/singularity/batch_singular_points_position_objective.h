@@ -0,0 +1,469 @@
+#pragma once
+#ifndef OPTIMIZATION_LIB_BATCH_SINGULAR_POINTS_POSITION_OBJECTIVE_H
+#define OPTIMIZATION_LIB_BATCH_SINGULAR_POINTS_POSITION_OBJECTIVE_H
+
+// C includes
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+// STL includes
+#include <array>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+// Eigen includes
+#include <Eigen/Core>
+
+// Optimization lib includes
+#include "../../core/core.h"
+#include "../../data_providers/empty_data_provider.h"
+#include "../dense_objective_function.h"
+#include "../periodic_objective.h"
+
+// The singular points position objective of all the face fans, evaluated in a single data-parallel pass.
+// Each fan contributes |angular defect| * sum(periodic(x) + periodic(y)) over the image vertices at its slices, with the fan weight held constant
+// (as SingularPointsPositionObjective does, through the weights of its children).
+//
+// The fans are stored in CSR form: the slices of fan i are [fan_offsets_[i], fan_offsets_[i + 1]), and each slice keeps the variable indices
+// of its corner vertex and of the two neighbouring vertices.
+template <Eigen::StorageOptions StorageOrder_>
+class BatchSingularPointsPositionObjective : public DenseObjectiveFunction<StorageOrder_>
+{
+public:
+	/**
+	 * Public type definitions
+	 */
+	enum class Properties : int32_t
+	{
+		Interval = DenseObjectiveFunction<StorageOrder_>::Properties::Count_,
+		SingularityWeightPerVertex,
+		PositiveAngularDefectSingularitiesIndices,
+		NegativeAngularDefectSingularitiesIndices
+	};
+
+	/**
+	 * Constructors and destructor
+	 */
+	BatchSingularPointsPositionObjective(const std::shared_ptr<MeshDataProvider>& mesh_data_provider, const std::shared_ptr<EmptyDataProvider>& empty_data_provider, const RDS::FaceFans& face_fans, const std::string& name, const double interval, const bool enforce_psd = true) :
+		DenseObjectiveFunction(mesh_data_provider, empty_data_provider, name, 0, enforce_psd),
+		face_fans_(face_fans),
+		interval_(interval)
+	{
+		polynomial_coeffs_ = PeriodicObjective<StorageOrder_>::CalculatePolynomialCoeffs(interval_);
+		this->Initialize();
+	}
+
+	BatchSingularPointsPositionObjective(const std::shared_ptr<MeshDataProvider>& mesh_data_provider, const std::shared_ptr<EmptyDataProvider>& empty_data_provider, const RDS::FaceFans& face_fans, const double interval, const bool enforce_psd = true) :
+		BatchSingularPointsPositionObjective(mesh_data_provider, empty_data_provider, face_fans, "Batch Singular Points Position", interval, enforce_psd)
+	{
+
+	}
+
+	virtual ~BatchSingularPointsPositionObjective()
+	{
+
+	}
+
+	/**
+	 * Setters
+	 */
+	void SetInterval(const double interval)
+	{
+		interval_ = interval;
+		polynomial_coeffs_ = PeriodicObjective<StorageOrder_>::CalculatePolynomialCoeffs(interval_);
+		this->Invalidate();
+	}
+
+	bool SetProperty(const int32_t property_id, const std::any property_context, const std::any property_value) override
+	{
+		if (DenseObjectiveFunction<StorageOrder_>::SetProperty(property_id, property_context, property_value))
+		{
+			return true;
+		}
+
+		const Properties properties = static_cast<Properties>(property_id);
+		switch (properties)
+		{
+		case Properties::Interval:
+			SetInterval(std::any_cast<const double>(property_value));
+			return true;
+		}
+
+		return false;
+	}
+
+	/**
+	 * Getters
+	 */
+	[[nodiscard]] double GetInterval() const
+	{
+		return interval_;
+	}
+
+	[[nodiscard]] int64_t GetFaceFansCount() const
+	{
+		return face_fans_.size();
+	}
+
+	[[nodiscard]] double GetAngularDefect(const int64_t face_fan_index) const
+	{
+		return angular_defects_.coeff(face_fan_index);
+	}
+
+	[[nodiscard]] const Eigen::VectorXd& GetSingularityWeightPerVertex() const
+	{
+		return singularity_weight_per_vertex_;
+	}
+
+	[[nodiscard]] const std::vector<RDS::VertexIndex>& GetPositiveAngularDefectSingularityIndices() const
+	{
+		return positive_angular_defect_singularity_indices_;
+	}
+
+	[[nodiscard]] const std::vector<RDS::VertexIndex>& GetNegativeAngularDefectSingularityIndices() const
+	{
+		return negative_angular_defect_singularity_indices_;
+	}
+
+	bool GetProperty(const int32_t property_id, const int32_t property_modifier_id, const std::any property_context, std::any& property_value) override
+	{
+		if (DenseObjectiveFunction<StorageOrder_>::GetProperty(property_id, property_modifier_id, property_context, property_value))
+		{
+			return true;
+		}
+
+		const Properties properties = static_cast<Properties>(property_id);
+		switch (properties)
+		{
+		case Properties::Interval:
+			property_value = GetInterval();
+			return true;
+		case Properties::SingularityWeightPerVertex:
+			property_value = GetSingularityWeightPerVertex();
+			return true;
+		case Properties::PositiveAngularDefectSingularitiesIndices:
+			property_value = GetPositiveAngularDefectSingularityIndices();
+			return true;
+		case Properties::NegativeAngularDefectSingularitiesIndices:
+			property_value = GetNegativeAngularDefectSingularityIndices();
+			return true;
+		}
+
+		return false;
+	}
+
+protected:
+	/**
+	 * Protected overrides
+	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override
+	{
+		return std::make_shared<BatchSingularPointsPositionObjective>(*this);
+	}
+
+
+	// Fans whose classification did not change since the last update are skipped, and the (sorted) index vectors are patched in place
+	void PostUpdate(const Eigen::VectorXd& x) override
+	{
+		const auto face_fans_count = face_fans_.size();
+		for (std::size_t i = 0; i < face_fans_count; i++)
+		{
+			const AngularDefectSign angular_defect_sign = GetAngularDefectSign(angular_defects_.coeff(i));
+			if (angular_defect_sign == angular_defect_signs_[i])
+			{
+				continue;
+			}
+
+			const RDS::VertexIndex domain_vertex_index = domain_vertex_indices_[i];
+			EraseSingularityIndex(angular_defect_signs_[i], domain_vertex_index);
+			InsertSingularityIndex(angular_defect_sign, domain_vertex_index);
+			angular_defect_signs_[i] = angular_defect_sign;
+		}
+	}
+
+private:
+	/**
+	 * Private type definitions
+	 */
+	enum class AngularDefectSign : int8_t
+	{
+		Negative = -1,
+		None = 0,
+		Positive = 1
+	};
+
+	/**
+	 * Private overrides
+	 */
+	void PreInitialize() override
+	{
+		const auto face_fans_count = face_fans_.size();
+		fan_offsets_.resize(face_fans_count + 1);
+		domain_vertex_indices_.resize(face_fans_count);
+
+		fan_offsets_[0] = 0;
+		for (std::size_t i = 0; i < face_fans_count; i++)
+		{
+			fan_offsets_[i + 1] = fan_offsets_[i] + face_fans_[i].size();
+			domain_vertex_indices_[i] = this->mesh_data_provider_->GetDomainVertexIndex(face_fans_[i][0].first);
+		}
+
+		const auto slices_count = fan_offsets_[face_fans_count];
+		for (int j = 0; j < 3; j++)
+		{
+			slice_x_indices_[j].resize(slices_count);
+			slice_y_indices_[j].resize(slices_count);
+		}
+
+		slice_vertex_indices_.resize(slices_count);
+		for (std::size_t i = 0; i < face_fans_count; i++)
+		{
+			auto slice_index = fan_offsets_[i];
+			for (const auto& face_fan_slice : face_fans_[i])
+			{
+				const RDS::VertexIndex vertex_indices[3] = { face_fan_slice.first, face_fan_slice.second.first, face_fan_slice.second.second };
+				for (int j = 0; j < 3; j++)
+				{
+					slice_x_indices_[j][slice_index] = this->mesh_data_provider_->GetXVariableIndex(vertex_indices[j]);
+					slice_y_indices_[j][slice_index] = this->mesh_data_provider_->GetYVariableIndex(vertex_indices[j]);
+				}
+
+				slice_vertex_indices_[slice_index] = face_fan_slice.first;
+				slice_index++;
+			}
+		}
+
+		angular_defects_ = Eigen::VectorXd::Zero(face_fans_count);
+		singularity_weights_ = Eigen::VectorXd::Zero(face_fans_count);
+		value_per_fan_ = Eigen::VectorXd::Zero(face_fans_count);
+		value_per_slice_ = Eigen::VectorXd::Zero(slices_count);
+		first_derivatives_ = Eigen::MatrixX2d::Zero(slices_count, 2);
+		second_derivatives_ = Eigen::MatrixX2d::Zero(slices_count, 2);
+
+		singularity_weight_per_vertex_ = Eigen::VectorXd::Zero(this->mesh_data_provider_->GetImageVerticesCount());
+		angular_defect_signs_.assign(face_fans_count, AngularDefectSign::None);
+		positive_angular_defect_singularity_indices_.clear();
+		negative_angular_defect_singularity_indices_.clear();
+	}
+
+	void InitializeTriplets(std::vector<Eigen::Triplet<double>>& triplets) override
+	{
+		// Two diagonal entries per slice (the x and y variables of its corner vertex)
+		const auto slices_count = slice_vertex_indices_.size();
+		triplets.resize(2 * slices_count);
+		for (std::size_t i = 0; i < slices_count; i++)
+		{
+			triplets[2 * i] = Eigen::Triplet<double>(slice_x_indices_[0][i], slice_x_indices_[0][i], 0);
+			triplets[2 * i + 1] = Eigen::Triplet<double>(slice_y_indices_[0][i], slice_y_indices_[0][i], 0);
+		}
+	}
+
+	void PreUpdate(const Eigen::VectorXd& x) override
+	{
+		const long face_fans_count = face_fans_.size();
+
+		#pragma omp parallel for
+		for (long i = 0; i < face_fans_count; i++)
+		{
+			const auto slices_begin = fan_offsets_[i];
+			const auto slices_end = fan_offsets_[i + 1];
+
+			// Fan angle (the angle between the slice edges is taken through atan2, which needs neither normalization nor acos)
+			double angle = 0;
+			for (auto j = slices_begin; j < slices_end; j++)
+			{
+				const double v0_x = x.coeff(slice_x_indices_[0][j]);
+				const double v0_y = x.coeff(slice_y_indices_[0][j]);
+				const double e1_x = x.coeff(slice_x_indices_[1][j]) - v0_x;
+				const double e1_y = x.coeff(slice_y_indices_[1][j]) - v0_y;
+				const double e2_x = x.coeff(slice_x_indices_[2][j]) - v0_x;
+				const double e2_y = x.coeff(slice_y_indices_[2][j]) - v0_y;
+				angle += std::atan2(std::abs(e1_x * e2_y - e1_y * e2_x), e1_x * e2_x + e1_y * e2_y);
+			}
+
+			const double angular_defect = angle - 2 * M_PI;
+			const double singularity_weight = std::abs(angular_defect);
+			angular_defects_.coeffRef(i) = angular_defect;
+			singularity_weights_.coeffRef(i) = singularity_weight;
+
+			// Periodic coordinate terms
+			double value = 0;
+			for (auto j = slices_begin; j < slices_end; j++)
+			{
+				double x_value;
+				double y_value;
+				PeriodicObjective<StorageOrder_>::CalculatePolynomialDerivatives(x.coeff(slice_x_indices_[0][j]), interval_, polynomial_coeffs_, x_value, first_derivatives_.coeffRef(j, 0), second_derivatives_.coeffRef(j, 0));
+				PeriodicObjective<StorageOrder_>::CalculatePolynomialDerivatives(x.coeff(slice_y_indices_[0][j]), interval_, polynomial_coeffs_, y_value, first_derivatives_.coeffRef(j, 1), second_derivatives_.coeffRef(j, 1));
+				value_per_slice_.coeffRef(j) = x_value + y_value;
+				value += value_per_slice_.coeff(j);
+			}
+
+			value_per_fan_.coeffRef(i) = singularity_weight * value;
+
+			// A corner vertex belongs to the fan of its domain vertex only, so fans never write the same entries
+			for (auto j = slices_begin; j < slices_end; j++)
+			{
+				singularity_weight_per_vertex_.coeffRef(slice_vertex_indices_[j]) = 0;
+			}
+
+			for (auto j = slices_begin; j < slices_end; j++)
+			{
+				singularity_weight_per_vertex_.coeffRef(slice_vertex_indices_[j]) += singularity_weight;
+			}
+		}
+	}
+
+	void CalculateValue(double& f) override
+	{
+		f = value_per_fan_.sum();
+	}
+
+	// Each slice contributes its own (weighted) periodic terms to its corner vertex, as the periodic coordinate objectives do
+	void CalculateValuePerVertex(Eigen::VectorXd& f_per_vertex) override
+	{
+		f_per_vertex.setZero();
+		const auto face_fans_count = face_fans_.size();
+		for (std::size_t i = 0; i < face_fans_count; i++)
+		{
+			for (auto j = fan_offsets_[i]; j < fan_offsets_[i + 1]; j++)
+			{
+				f_per_vertex.coeffRef(slice_vertex_indices_[j]) += singularity_weights_.coeff(i) * value_per_slice_.coeff(j);
+			}
+		}
+	}
+
+	void CalculateGradient(Eigen::VectorXd& g) override
+	{
+		g.setZero();
+		const long face_fans_count = face_fans_.size();
+
+		#pragma omp parallel for
+		for (long i = 0; i < face_fans_count; i++)
+		{
+			const double singularity_weight = singularity_weights_.coeff(i);
+			for (auto j = fan_offsets_[i]; j < fan_offsets_[i + 1]; j++)
+			{
+				g.coeffRef(slice_x_indices_[0][j]) += singularity_weight * first_derivatives_.coeff(j, 0);
+				g.coeffRef(slice_y_indices_[0][j]) += singularity_weight * first_derivatives_.coeff(j, 1);
+			}
+		}
+	}
+
+	void CalculateRawTriplets(const TripletsView& triplets) override
+	{
+		const long face_fans_count = face_fans_.size();
+		const bool enforce_psd = this->GetEnforcePsd();
+
+		#pragma omp parallel for
+		for (long i = 0; i < face_fans_count; i++)
+		{
+			const double singularity_weight = singularity_weights_.coeff(i);
+			for (auto j = fan_offsets_[i]; j < fan_offsets_[i + 1]; j++)
+			{
+				for (int k = 0; k < 2; k++)
+				{
+					// The projection of a 1x1 hessian replaces a negative value by 10e-8 (as the periodic objectives do)
+					double second_derivative = second_derivatives_.coeff(j, k);
+					if (enforce_psd && second_derivative < 0)
+					{
+						second_derivative = 10e-8;
+					}
+
+					const_cast<double&>(triplets[2 * j + k].value()) = singularity_weight * second_derivative;
+				}
+			}
+		}
+	}
+
+	/**
+	 * Private methods
+	 */
+	static AngularDefectSign GetAngularDefectSign(const double angular_defect)
+	{
+		if (angular_defect > AngularDefectThreshold)
+		{
+			return AngularDefectSign::Positive;
+		}
+
+		if (angular_defect < -AngularDefectThreshold)
+		{
+			return AngularDefectSign::Negative;
+		}
+
+		return AngularDefectSign::None;
+	}
+
+	std::vector<RDS::VertexIndex>* GetSingularityIndices(const AngularDefectSign angular_defect_sign)
+	{
+		switch (angular_defect_sign)
+		{
+		case AngularDefectSign::Positive:
+			return &positive_angular_defect_singularity_indices_;
+		case AngularDefectSign::Negative:
+			return &negative_angular_defect_singularity_indices_;
+		default:
+			return nullptr;
+		}
+	}
+
+	void EraseSingularityIndex(const AngularDefectSign angular_defect_sign, const RDS::VertexIndex domain_vertex_index)
+	{
+		auto singularity_indices = GetSingularityIndices(angular_defect_sign);
+		if (singularity_indices != nullptr)
+		{
+			const auto it = std::lower_bound(singularity_indices->begin(), singularity_indices->end(), domain_vertex_index);
+			if (it != singularity_indices->end() && *it == domain_vertex_index)
+			{
+				singularity_indices->erase(it);
+			}
+		}
+	}
+
+	void InsertSingularityIndex(const AngularDefectSign angular_defect_sign, const RDS::VertexIndex domain_vertex_index)
+	{
+		auto singularity_indices = GetSingularityIndices(angular_defect_sign);
+		if (singularity_indices != nullptr)
+		{
+			singularity_indices->insert(std::lower_bound(singularity_indices->begin(), singularity_indices->end(), domain_vertex_index), domain_vertex_index);
+		}
+	}
+
+	/**
+	 * Private constants
+	 */
+	static constexpr double AngularDefectThreshold = 0.05;
+
+	/**
+	 * Private fields
+	 */
+	RDS::FaceFans face_fans_;
+	double interval_;
+	Eigen::VectorXd polynomial_coeffs_;
+
+	// Fans (CSR)
+	std::vector<std::size_t> fan_offsets_;
+	std::vector<RDS::VertexIndex> domain_vertex_indices_;
+
+	// Slices (structure of arrays; index 0 is the corner vertex, 1 and 2 are its neighbours)
+	std::array<std::vector<RDS::SparseVariableIndex>, 3> slice_x_indices_;
+	std::array<std::vector<RDS::SparseVariableIndex>, 3> slice_y_indices_;
+	std::vector<RDS::VertexIndex> slice_vertex_indices_;
+
+	// Per fan and per slice quantities
+	Eigen::VectorXd angular_defects_;
+	Eigen::VectorXd singularity_weights_;
+	Eigen::VectorXd value_per_fan_;
+	Eigen::VectorXd value_per_slice_;
+	Eigen::MatrixX2d first_derivatives_;
+	Eigen::MatrixX2d second_derivatives_;
+
+	// Singularities
+	Eigen::VectorXd singularity_weight_per_vertex_;
+	std::vector<AngularDefectSign> angular_defect_signs_;
+	std::vector<RDS::VertexIndex> positive_angular_defect_singularity_indices_;
+	std::vector<RDS::VertexIndex> negative_angular_defect_singularity_indices_;
+};
+
+#endif
@@ -61,6 +61,7 @@ public:
 			this->GetObjectiveFunction(i)->SetPeriod(interval);
 		}
 		interval_ = interval;
+		this->Invalidate();
 	}
 
 	bool SetProperty(const int32_t property_id, const std::any property_context, const std::any property_value) override
@@ -127,8 +128,16 @@ public:
 	/**
 	 * Public overrides
 	 */
+
+	// The periodic coordinate objectives are built once (Initialize is called again by the parents of this objective)
 	void PreInitialize() override
 	{
+		if (this->GetObjectiveFunctionsCount() > 0)
+		{
+			SummationObjective<PeriodicObjective<StorageOrder_>, Eigen::SparseVector<double>>::PreInitialize();
+			return;
+		}
+
 		const auto face_fan_data_provider = GetFaceFanDataProvider();
 		auto face_fan = face_fan_data_provider->GetFaceFan();
 		for (auto& face_fan_slice : face_fan)
@@ -171,6 +180,11 @@ private:
 	/**
 	 * Private overrides
 	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override
+	{
+		return std::make_shared<SingularPointPositionObjective>(*this);
+	}
+
 	void PreUpdate(const Eigen::VectorXd& x) override
 	{
 		angular_defect_ = GetFaceFanDataProvider()->GetAngle() - 2 * M_PI;
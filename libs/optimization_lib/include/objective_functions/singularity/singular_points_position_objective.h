@@ -12,6 +12,7 @@
 #include "../../data_providers/empty_data_provider.h"
 #include "../summation_objective.h"
 #include "./singular_point_position_objective.h"
+#include "./batch_singular_points_position_objective.h"
 
 template <Eigen::StorageOptions StorageOrder_>
 class SingularPointsPositionObjective : public SummationObjective<SingularPointPositionObjective<StorageOrder_>, Eigen::VectorXd>
@@ -25,7 +26,8 @@ public:
 		Interval = SummationObjective<SingularPointPositionObjective<StorageOrder_>, Eigen::VectorXd>::Properties::Count_,
 		SingularityWeightPerVertex,
 		PositiveAngularDefectSingularitiesIndices,
-		NegativeAngularDefectSingularitiesIndices
+		NegativeAngularDefectSingularitiesIndices,
+		BatchedSingularPoints
 	};
 
 	
@@ -34,7 +36,10 @@ public:
 	 */
 	SingularPointsPositionObjective(const std::shared_ptr<MeshDataProvider>& mesh_data_provider, const std::shared_ptr<EmptyDataProvider>& empty_data_provider, const std::string& name, double interval, const bool enforce_children_psd = true) :
 		SummationObjective(mesh_data_provider, empty_data_provider, name, enforce_children_psd),
-		interval_(interval)
+		interval_(interval),
+		batched_singular_points_(false),
+		batch_singular_points_triplets_valid_(false),
+		batch_singular_points_triplets_layout_version_(0)
 	{
 		this->Initialize();
 	}
@@ -59,7 +64,22 @@ public:
 		{
 			this->GetObjectiveFunction(i)->SetInterval(interval);
 		}
+
+		if (batch_singular_points_objective_)
+		{
+			batch_singular_points_objective_->SetInterval(interval);
+		}
+
 		interval_ = interval;
+		this->Invalidate();
+	}
+
+	// When enabled, all the face fans are evaluated by a single BatchSingularPointsPositionObjective, instead of a tree of per-fan objectives.
+	// Takes effect on the next Initialize().
+	void SetBatchedSingularPoints(const bool batched_singular_points)
+	{
+		batched_singular_points_ = batched_singular_points;
+		this->Invalidate();
 	}
 
 	bool SetProperty(const int32_t property_id, const std::any property_context, const std::any property_value) override
@@ -75,6 +95,9 @@ public:
 		case Properties::Interval:
 			SetInterval(std::any_cast<const double>(property_value));
 			return true;
+		case Properties::BatchedSingularPoints:
+			SetBatchedSingularPoints(std::any_cast<const bool>(property_value));
+			return true;
 		}
 
 		return false;
@@ -88,6 +111,11 @@ public:
 		return interval_;
 	}
 
+	[[nodiscard]] bool GetBatchedSingularPoints() const
+	{
+		return batched_singular_points_;
+	}
+
 	[[nodiscard]] const Eigen::VectorXd& GetSingularityWeightPerVertex() const
 	{
 		return singularity_weight_per_vertex_;
@@ -125,6 +153,9 @@ public:
 		case Properties::NegativeAngularDefectSingularitiesIndices:
 			property_value = GetNegativeAngularDefectSingularityIndices();
 			return true;
+		case Properties::BatchedSingularPoints:
+			property_value = GetBatchedSingularPoints();
+			return true;
 		}
 
 		return false;
@@ -135,6 +166,7 @@ public:
 	 */
 	void PreInitialize() override
 	{
+		SyncSingularPointObjectives();
 		SummationObjective<SingularPointPositionObjective<StorageOrder_>, Eigen::VectorXd>::PreInitialize();
 		singularity_weight_per_vertex_.resize(this->mesh_data_provider_->GetImageVerticesCount());
 	}
@@ -142,17 +174,46 @@ public:
 	/**
 	 * Public methods
 	 */
+	// In batched mode, the batch objective is (re)built once all the face fans were added (see SyncSingularPointObjectives)
 	void AddSingularPointObjective(const std::shared_ptr<FaceFanDataProvider>& face_fan_data_provider)
 	{
-		this->AddObjectiveFunction(std::make_shared<SingularPointPositionObjective<StorageOrder_>>(this->GetMeshDataProvider(), face_fan_data_provider, interval_, this->GetEnforceChildrenPsd()));
+		face_fan_data_providers_.push_back(face_fan_data_provider);
+		if (!batched_singular_points_)
+		{
+			SyncSingularPointObjectives();
+		}
 	}
 
 protected:
 	/**
 	 * Protected overrides
 	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override
+	{
+		return std::make_shared<SingularPointsPositionObjective>(*this);
+	}
+
+	void RemapDependencies(const UpdatableObject::CloneMap& clones) override
+	{
+		SummationObjective<SingularPointPositionObjective<StorageOrder_>, Eigen::VectorXd>::RemapDependencies(clones);
+		for (auto& face_fan_data_provider : face_fan_data_providers_)
+		{
+			face_fan_data_provider = UpdatableObject::Remap(face_fan_data_provider, clones);
+		}
+
+		batch_singular_points_objective_ = UpdatableObject::Remap(batch_singular_points_objective_, clones);
+	}
+
 	void PostUpdate(const Eigen::VectorXd& x) override
 	{
+		if (batch_singular_points_objective_)
+		{
+			singularity_weight_per_vertex_ = batch_singular_points_objective_->GetSingularityWeightPerVertex();
+			positive_angular_defect_singularity_indices_ = batch_singular_points_objective_->GetPositiveAngularDefectSingularityIndices();
+			negative_angular_defect_singularity_indices_ = batch_singular_points_objective_->GetNegativeAngularDefectSingularityIndices();
+			return;
+		}
+
 		positive_angular_defect_singularity_indices_.clear();
 		negative_angular_defect_singularity_indices_.clear();
 		singularity_weight_per_vertex_.setZero();
@@ -180,13 +241,160 @@ protected:
 	}
 
 private:
+	/**
+	 * Private overrides
+	 */
+	void CalculateValue(double& f) override
+	{
+		if (batch_singular_points_objective_)
+		{
+			f = batch_singular_points_objective_->GetValue();
+			return;
+		}
+
+		SummationObjective<SingularPointPositionObjective<StorageOrder_>, Eigen::VectorXd>::CalculateValue(f);
+	}
+
+	void CalculateValuePerVertex(Eigen::VectorXd& f_per_vertex) override
+	{
+		if (batch_singular_points_objective_)
+		{
+			f_per_vertex = batch_singular_points_objective_->GetValuePerVertex();
+			return;
+		}
+
+		SummationObjective<SingularPointPositionObjective<StorageOrder_>, Eigen::VectorXd>::CalculateValuePerVertex(f_per_vertex);
+	}
+
+	void CalculateGradient(Eigen::VectorXd& g) override
+	{
+		if (batch_singular_points_objective_)
+		{
+			g = batch_singular_points_objective_->GetGradient();
+			return;
+		}
+
+		SummationObjective<SingularPointPositionObjective<StorageOrder_>, Eigen::VectorXd>::CalculateGradient(g);
+	}
+
+	// The batch objective keeps its triplets layout, so after the first copy only the values are copied
+	void CalculateTriplets(std::vector<Eigen::Triplet<double>>& triplets) override
+	{
+		if (!batch_singular_points_objective_)
+		{
+			SummationObjective<SingularPointPositionObjective<StorageOrder_>, Eigen::VectorXd>::CalculateTriplets(triplets);
+			return;
+		}
+
+		const auto& batch_singular_points_triplets = batch_singular_points_objective_->GetTriplets();
+		if (!batch_singular_points_triplets_valid_ || batch_singular_points_triplets_layout_version_ != batch_singular_points_objective_->GetTripletsLayoutVersion())
+		{
+			triplets = batch_singular_points_triplets;
+			batch_singular_points_triplets_valid_ = true;
+			batch_singular_points_triplets_layout_version_ = batch_singular_points_objective_->GetTripletsLayoutVersion();
+			this->InvalidateHessianPattern();
+			return;
+		}
+
+		const int64_t triplets_count = triplets.size();
+		#pragma omp parallel for
+		for (int64_t i = 0; i < triplets_count; i++)
+		{
+			const_cast<double&>(triplets[i].value()) = batch_singular_points_triplets[i].value();
+		}
+	}
+
+	/**
+	 * Private methods
+	 */
+	// Brings the evaluated objectives in line with the face fans and the batched mode: builds the objectives of face fans that were added since,
+	// or (in batched mode) rebuilds the batch objective when the face fans changed
+	void SyncSingularPointObjectives()
+	{
+		const std::size_t face_fans_count = face_fan_data_providers_.size();
+		if (batched_singular_points_)
+		{
+			const bool batch_valid = face_fans_count == 0 || (batch_singular_points_objective_ && batch_singular_points_objective_->GetFaceFansCount() == static_cast<int64_t>(face_fans_count));
+			if (batch_valid && this->GetObjectiveFunctionsCount() == 0)
+			{
+				return;
+			}
+
+			std::vector<std::shared_ptr<SingularPointPositionObjective<StorageOrder_>>> singular_point_objectives;
+			for (std::size_t i = 0; i < this->GetObjectiveFunctionsCount(); i++)
+			{
+				singular_point_objectives.push_back(this->GetObjectiveFunction(i));
+			}
+
+			this->RemoveObjectiveFunctions(singular_point_objectives);
+			RemoveBatchSingularPointsObjective();
+			if (face_fans_count > 0)
+			{
+				RDS::FaceFans face_fans;
+				face_fans.reserve(face_fans_count);
+				for (const auto& face_fan_data_provider : face_fan_data_providers_)
+				{
+					face_fans.push_back(face_fan_data_provider->GetFaceFan());
+				}
+
+				auto empty_data_provider = std::make_shared<EmptyDataProvider>(this->GetMeshDataProvider());
+				batch_singular_points_objective_ = std::make_shared<BatchSingularPointsPositionObjective<StorageOrder_>>(this->GetMeshDataProvider(), empty_data_provider, face_fans, interval_, this->GetEnforceChildrenPsd());
+				this->dependencies_.push_back(batch_singular_points_objective_);
+			}
+		}
+		else
+		{
+			if (!batch_singular_points_objective_ && this->GetObjectiveFunctionsCount() == face_fans_count)
+			{
+				return;
+			}
+
+			RemoveBatchSingularPointsObjective();
+			for (std::size_t i = this->GetObjectiveFunctionsCount(); i < face_fans_count; i++)
+			{
+				this->AddObjectiveFunction(std::make_shared<SingularPointPositionObjective<StorageOrder_>>(this->GetMeshDataProvider(), face_fan_data_providers_[i], interval_, this->GetEnforceChildrenPsd()));
+			}
+		}
+
+		batch_singular_points_triplets_valid_ = false;
+		this->InvalidateHessianPattern();
+		this->Invalidate();
+	}
+
+	void RemoveBatchSingularPointsObjective()
+	{
+		if (!batch_singular_points_objective_)
+		{
+			return;
+		}
+
+		tbb::concurrent_vector<std::shared_ptr<UpdatableObject>> dependencies;
+		for (const auto& dependency : this->dependencies_)
+		{
+			if (dependency != batch_singular_points_objective_)
+			{
+				dependencies.push_back(dependency);
+			}
+		}
+
+		this->dependencies_ = dependencies;
+		batch_singular_points_objective_ = nullptr;
+	}
+
 	/**
 	 * Private fields
 	 */
 	double interval_;
+	bool batched_singular_points_;
+	tbb::concurrent_vector<std::shared_ptr<FaceFanDataProvider>> face_fan_data_providers_;
 	Eigen::VectorXd singularity_weight_per_vertex_;
 	std::vector<RDS::VertexIndex> positive_angular_defect_singularity_indices_;
 	std::vector<RDS::VertexIndex> negative_angular_defect_singularity_indices_;
+
+	// Batched mode
+	std::shared_ptr<BatchSingularPointsPositionObjective<StorageOrder_>> batch_singular_points_objective_;
+	bool batch_singular_points_triplets_valid_;
+	uint64_t batch_singular_points_triplets_layout_version_;
 };
 
 #endif
\ No newline at end of file
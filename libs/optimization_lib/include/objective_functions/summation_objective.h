@@ -5,12 +5,18 @@
 // STL includes
 #include <memory>
 #include <vector>
+#include <unordered_set>
+#include <type_traits>
 
 // TBB includes
 #include <tbb/concurrent_vector.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
 
 // Optimization lib includes
 #include "./objective_function.h"
+#include "../core/psd_projection.h"
 
 template<typename ObjectiveFunctionType_, typename VectorType_>
 class SummationObjective : public ObjectiveFunction<static_cast<Eigen::StorageOptions>(ObjectiveFunctionType_::StorageOrder), VectorType_>
@@ -27,7 +33,10 @@ public:
 	
 	SummationObjective(const std::shared_ptr<MeshDataProvider>& mesh_data_provider, const std::shared_ptr<DataProvider>& data_provider, const std::string& name, const bool enforce_children_psd = false) :
 		ObjectiveFunction(mesh_data_provider, data_provider, name),
-		enforce_children_psd_(enforce_children_psd)
+		enforce_children_psd_(enforce_children_psd),
+		parallel_gradient_(true),
+		batched_psd_projection_(true),
+		triplets_layout_valid_(false)
 	{
 		//this->Initialize();
 	}
@@ -58,7 +67,10 @@ public:
 
 	virtual ~SummationObjective()
 	{
-
+		for (const auto& objective_function : objective_functions_)
+		{
+			objective_function->ClearTripletsTarget(this);
+		}
 	}
 
 	/**
@@ -69,6 +81,22 @@ public:
 		return enforce_children_psd_;
 	}
 
+	bool GetParallelGradient() const
+	{
+		return parallel_gradient_;
+	}
+
+	bool GetBatchedPsdProjection() const
+	{
+		return batched_psd_projection_;
+	}
+
+	// A summation reads x only through its children (and data provider), which are its dependencies
+	bool GetVariablesFootprint(std::vector<RDS::SparseVariableIndex>& variables_footprint) const override
+	{
+		return true;
+	}
+
 	/**
 	 * Public setters
 	 */
@@ -76,6 +104,20 @@ public:
 	{
 		enforce_children_psd_ = enforce_children_psd;
 	}
+
+	// When enabled (and the gradient is dense), children accumulate into per-thread gradient buffers that are merged at the end
+	void SetParallelGradient(const bool parallel_gradient)
+	{
+		parallel_gradient_ = parallel_gradient;
+	}
+
+	// When enabled, children that project their (4x4, 6x6 or 8x8) local hessians onto the PSD cone defer it to this objective,
+	// which projects all of them together (see PsdProjection), and only then applies their weights (as the children would)
+	void SetBatchedPsdProjection(const bool batched_psd_projection)
+	{
+		batched_psd_projection_ = batched_psd_projection;
+		InvalidateTripletsLayout();
+	}
 	
 	/**
 	 * Public Methods
@@ -84,6 +126,7 @@ public:
 	{
 		objective_functions_.push_back(objective_function);
 		this->dependencies_.push_back(objective_function);
+		InvalidateTripletsLayout();
 	}
 
 	void AddObjectiveFunctions(const std::vector<std::shared_ptr<ObjectiveFunctionType_>>& objective_functions)
@@ -93,37 +136,49 @@ public:
 			objective_functions_.push_back(objective_function);
 			this->dependencies_.push_back(objective_function);
 		}
+
+		InvalidateTripletsLayout();
 	}
 
 	void RemoveObjectiveFunction(const std::shared_ptr<ObjectiveFunctionType_>& objective_function)
 	{
-		tbb::concurrent_vector<std::shared_ptr<ObjectiveFunctionType_>> objective_functions;
+		RemoveObjectiveFunctions(std::vector<std::shared_ptr<ObjectiveFunctionType_>>{ objective_function });
+	}
+
+	// Filters the children (and the dependencies) in a single pass, however many objectives are removed
+	void RemoveObjectiveFunctions(const std::vector<std::shared_ptr<ObjectiveFunctionType_>>& objective_functions)
+	{
+		std::unordered_set<const UpdatableObject*> removed_objects;
+		for (const auto& objective_function : objective_functions)
+		{
+			removed_objects.insert(objective_function.get());
+		}
+
+		tbb::concurrent_vector<std::shared_ptr<ObjectiveFunctionType_>> remaining_objective_functions;
 		for (const auto& current_objective_function : objective_functions_)
 		{
-			if(current_objective_function != objective_function)
+			if (removed_objects.find(current_objective_function.get()) == removed_objects.end())
 			{
-				objective_functions.push_back(current_objective_function);
+				remaining_objective_functions.push_back(current_objective_function);
+			}
+			else
+			{
+				current_objective_function->SetDeferPsdProjection(false);
+				current_objective_function->ClearTripletsTarget(this);
 			}
 		}
-		objective_functions_ = objective_functions;
+		objective_functions_ = remaining_objective_functions;
 
 		tbb::concurrent_vector<std::shared_ptr<UpdatableObject>> dependencies;
 		for (const auto& current_dependency : this->dependencies_)
 		{
-			if (current_dependency != objective_function)
+			if (removed_objects.find(current_dependency.get()) == removed_objects.end())
 			{
 				dependencies.push_back(current_dependency);
 			}
 		}
 		this->dependencies_ = dependencies;
-	}
-
-	void RemoveObjectiveFunctions(const std::vector<std::shared_ptr<ObjectiveFunctionType_>>& objective_functions)
-	{
-		for (const auto& objective_function : objective_functions)
-		{
-			RemoveObjectiveFunction(objective_function);
-		}
+		InvalidateTripletsLayout();
 	}
 
 	std::size_t GetObjectiveFunctionsCount() const
@@ -158,19 +213,44 @@ protected:
 	/**
 	 * Protected overrides
 	 */
+	std::shared_ptr<UpdatableObject> CloneObject() const override
+	{
+		return std::make_shared<SummationObjective>(*this);
+	}
+
+	void RemapDependencies(const UpdatableObject::CloneMap& clones) override
+	{
+		ObjectiveFunction::RemapDependencies(clones);
+		for (auto& objective_function : objective_functions_)
+		{
+			objective_function = UpdatableObject::Remap(objective_function, clones);
+		}
+
+		// The copied triplets hold the values of the children that wrote into the triplets of the original, so their clones write into the copy
+		if (!triplets_layout_valid_ || children_write_triplets_.size() != objective_functions_.size())
+		{
+			return;
+		}
+
+		for (std::size_t i = 0; i < objective_functions_.size(); i++)
+		{
+			if (children_write_triplets_[i] && !objective_functions_[i]->SetTripletsTarget(this, this->GetMutableTriplets(), triplets_offsets_[i], !psd_projection_deferred_[i]))
+			{
+				triplets_layout_valid_ = false;
+			}
+		}
+	}
+
 	void PreInitialize() override
 	{
 		for (const auto& objective_function : objective_functions_)
 		{
 			objective_function->Initialize();
 		}
+
+		InvalidateTripletsLayout();
 	}
 	
-private:
-
-	/**
-	 * Private overrides
-	 */
 	void CalculateValue(double& f) override
 	{
 		f = 0;
@@ -199,6 +279,15 @@ private:
 
 	void CalculateGradient(VectorType_& g) override
 	{
+		if constexpr (std::is_same_v<VectorType_, Eigen::VectorXd>)
+		{
+			if (parallel_gradient_)
+			{
+				CalculateGradientParallel(g);
+				return;
+			}
+		}
+
 		g.setZero();
 		for(int64_t i = 0; i < objective_functions_.size(); i++)
 		{
@@ -208,14 +297,40 @@ private:
 		}
 	}
 
+	// The children's triplets are laid out once, one contiguous range per child (in the order of objective_functions_). Afterwards, the children write
+	// their weighted values straight into their ranges when they are updated (see ObjectiveFunction::SetTripletsTarget); only the values of children that
+	// cannot are copied here. Either way, the parent's hessian pattern stays valid as well.
 	void CalculateTriplets(std::vector<Eigen::Triplet<double>>& triplets) override
 	{
-		triplets.clear();
-		for (const auto& objective_function : objective_functions_)
+		if (!IsTripletsLayoutValid(triplets))
 		{
-			auto w = objective_function->GetWeight();
-			objective_function->AddTriplets(triplets, w);
+			BuildTripletsLayout(triplets);
+			return;
+		}
+
+		// The hessians of deferring children are weighted after their projection; the weights of the others may have changed since they were written
+		const int64_t objective_functions_count = objective_functions_.size();
+		#pragma omp parallel for
+		for (int64_t i = 0; i < objective_functions_count; i++)
+		{
+			const auto& objective_function = objective_functions_[i];
+			if (children_write_triplets_[i])
+			{
+				objective_function->ReweightTripletsTarget(this);
+			}
+			else
+			{
+				objective_function->AssignTripletValues(triplets, triplets_offsets_[i], psd_projection_deferred_[i] ? 1 : objective_function->GetWeight());
+			}
 		}
+
+		// A child that writes into the triplets, and was not updated since the last assembly, still holds its projected values
+		for (int64_t i = 0; i < objective_functions_count; i++)
+		{
+			psd_projection_pending_[i] = !children_write_triplets_[i] || objective_functions_[i]->ConsumeTripletsTargetWritten();
+		}
+
+		ProjectChildrenHessians(triplets);
 	}
 
 	void InitializeTriplets(std::vector<Eigen::Triplet<double>>& triplets) override
@@ -223,12 +338,238 @@ private:
 		// Empty implementation
 	}
 
+private:
+	/**
+	 * Private type definitions
+	 */
+
+	// Children whose local hessians are projected together (of a single size), and the offsets of their triplets
+	struct PsdProjectionBatch
+	{
+		void Clear()
+		{
+			children.clear();
+			offsets.clear();
+			pending_offsets.clear();
+			pending_weights.clear();
+		}
+
+		std::vector<std::size_t> children;
+		std::vector<std::size_t> offsets;
+
+		// The hessians that are projected by the current assembly
+		std::vector<std::size_t> pending_offsets;
+		std::vector<double> pending_weights;
+	};
+
+	/**
+	 * Private methods
+	 */
+	bool IsTripletsLayoutValid(const std::vector<Eigen::Triplet<double>>& triplets) const
+	{
+		if (!triplets_layout_valid_ || triplets_offsets_.size() != objective_functions_.size() + 1 || triplets_offsets_.back() != triplets.size())
+		{
+			return false;
+		}
+
+		for (std::size_t i = 0; i < objective_functions_.size(); i++)
+		{
+			const auto& objective_function = objective_functions_[i];
+			if (triplets_offsets_[i + 1] - triplets_offsets_[i] != objective_function->GetTriplets().size() ||
+				triplets_layout_versions_[i] != objective_function->GetTripletsLayoutVersion() ||
+				(children_write_triplets_[i] && !objective_function->HasTripletsTarget(this)))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Children that wrote into the previous layout (and kept their own layout) hold their values there, rather than in their own triplets
+	void BuildTripletsLayout(std::vector<Eigen::Triplet<double>>& triplets)
+	{
+		for (const auto& objective_function : objective_functions_)
+		{
+			objective_function->ReweightTripletsTarget(this);
+		}
+
+		std::vector<Eigen::Triplet<double>> previous_triplets;
+		previous_triplets.swap(triplets);
+		triplets.reserve(previous_triplets.size());
+		triplets_offsets_.resize(objective_functions_.size() + 1);
+		triplets_offsets_[0] = 0;
+		triplets_layout_versions_.resize(objective_functions_.size());
+		children_write_triplets_.assign(objective_functions_.size(), false);
+		psd_projection_pending_.assign(objective_functions_.size(), true);
+		psd_projection_deferred_.assign(objective_functions_.size(), false);
+		psd_projection_batch_4_.Clear();
+		psd_projection_batch_6_.Clear();
+		psd_projection_batch_8_.Clear();
+
+		// Children that stop deferring were last updated with an unprojected hessian, so they are projected here once more
+		PsdProjectionBatch stale_psd_projection_batch_4;
+		PsdProjectionBatch stale_psd_projection_batch_6;
+		PsdProjectionBatch stale_psd_projection_batch_8;
+		for (std::size_t i = 0; i < objective_functions_.size(); i++)
+		{
+			const auto& objective_function = objective_functions_[i];
+			const auto psd_projection_size = objective_function->GetPsdProjectionSize();
+
+			PsdProjectionBatch* psd_projection_batch = nullptr;
+			if (batched_psd_projection_)
+			{
+				psd_projection_batch = SelectPsdProjectionBatch(psd_projection_size, psd_projection_batch_4_, psd_projection_batch_6_, psd_projection_batch_8_);
+			}
+			else if (objective_function->GetDeferPsdProjection())
+			{
+				psd_projection_batch = SelectPsdProjectionBatch(psd_projection_size, stale_psd_projection_batch_4, stale_psd_projection_batch_6, stale_psd_projection_batch_8);
+			}
+
+			if (objective_function->HasTripletsTarget(this))
+			{
+				// The written values are unweighted (and unprojected) only while the child defers its projection; otherwise they are final
+				const auto previous_offset = objective_function->GetTripletsTargetOffset();
+				const auto triplets_count = objective_function->GetTriplets().size();
+				triplets.insert(triplets.end(), previous_triplets.begin() + previous_offset, previous_triplets.begin() + previous_offset + triplets_count);
+				psd_projection_pending_[i] = objective_function->ConsumeTripletsTargetWritten() && objective_function->GetDeferPsdProjection();
+			}
+			else
+			{
+				objective_function->AddTriplets(triplets, psd_projection_batch != nullptr ? 1 : objective_function->GetWeight());
+			}
+
+			triplets_offsets_[i + 1] = triplets.size();
+			triplets_layout_versions_[i] = objective_function->GetTripletsLayoutVersion();
+
+			if (psd_projection_batch != nullptr)
+			{
+				psd_projection_batch->children.push_back(i);
+				psd_projection_batch->offsets.push_back(triplets_offsets_[i]);
+			}
+
+			psd_projection_deferred_[i] = batched_psd_projection_ && psd_projection_batch != nullptr;
+			objective_function->SetDeferPsdProjection(psd_projection_deferred_[i]);
+		}
+
+		ProjectChildrenHessians(triplets);
+		ProjectChildrenHessians<4>(triplets, stale_psd_projection_batch_4);
+		ProjectChildrenHessians<6>(triplets, stale_psd_projection_batch_6);
+		ProjectChildrenHessians<8>(triplets, stale_psd_projection_batch_8);
+
+		for (std::size_t i = 0; i < objective_functions_.size(); i++)
+		{
+			children_write_triplets_[i] = objective_functions_[i]->SetTripletsTarget(this, triplets, triplets_offsets_[i], !psd_projection_deferred_[i]);
+		}
+
+		triplets_layout_valid_ = true;
+		this->InvalidateHessianPattern();
+	}
+
+	static PsdProjectionBatch* SelectPsdProjectionBatch(const int64_t psd_projection_size, PsdProjectionBatch& psd_projection_batch_4, PsdProjectionBatch& psd_projection_batch_6, PsdProjectionBatch& psd_projection_batch_8)
+	{
+		switch (psd_projection_size)
+		{
+		case 4:
+			return &psd_projection_batch_4;
+		case 6:
+			return &psd_projection_batch_6;
+		case 8:
+			return &psd_projection_batch_8;
+		default:
+			return nullptr;
+		}
+	}
+
+	void ProjectChildrenHessians(std::vector<Eigen::Triplet<double>>& triplets)
+	{
+		ProjectChildrenHessians<4>(triplets, psd_projection_batch_4_);
+		ProjectChildrenHessians<6>(triplets, psd_projection_batch_6_);
+		ProjectChildrenHessians<8>(triplets, psd_projection_batch_8_);
+	}
+
+	// Only the pending hessians are projected. The weights are applied after the projection, and read on every assembly (they may change, and change sign, without a new layout).
+	template<int N>
+	void ProjectChildrenHessians(std::vector<Eigen::Triplet<double>>& triplets, PsdProjectionBatch& psd_projection_batch)
+	{
+		psd_projection_batch.pending_offsets.clear();
+		psd_projection_batch.pending_weights.clear();
+		for (std::size_t i = 0; i < psd_projection_batch.children.size(); i++)
+		{
+			const auto child_index = psd_projection_batch.children[i];
+			if (psd_projection_pending_[child_index])
+			{
+				psd_projection_batch.pending_offsets.push_back(psd_projection_batch.offsets[i]);
+				psd_projection_batch.pending_weights.push_back(objective_functions_[child_index]->GetWeight());
+			}
+		}
+
+		PsdProjection<N>::Project(triplets, psd_projection_batch.pending_offsets, psd_projection_batch.pending_weights);
+	}
+
+	void InvalidateTripletsLayout()
+	{
+		triplets_layout_valid_ = false;
+		this->InvalidateHessianPattern();
+		this->Invalidate();
+	}
+
+	// Every thread sums its share of the children into its own dense buffer (no locking, no sparse temporaries); the buffers are kept between calls
+	void CalculateGradientParallel(Eigen::VectorXd& g)
+	{
+		const auto variables_count = g.size();
+		for (auto& gradient_buffer : gradient_buffers_)
+		{
+			gradient_buffer.setZero(variables_count);
+		}
+
+		tbb::parallel_for(tbb::blocked_range<std::size_t>(0, objective_functions_.size()), [&](const tbb::blocked_range<std::size_t>& range) {
+			auto& gradient_buffer = gradient_buffers_.local();
+			if (gradient_buffer.size() != variables_count)
+			{
+				gradient_buffer.setZero(variables_count);
+			}
+
+			for (std::size_t i = range.begin(); i != range.end(); i++)
+			{
+				const auto& objective_function = objective_functions_[i];
+				objective_function->AddGradient(gradient_buffer, objective_function->GetWeight());
+			}
+		});
+
+		g.setZero();
+		for (const auto& gradient_buffer : gradient_buffers_)
+		{
+			g += gradient_buffer;
+		}
+	}
+
 	/**
 	 * Fields
 	 */
 	tbb::concurrent_vector<std::shared_ptr<ObjectiveFunctionType_>> objective_functions_;
 	bool parallel_update_;
 	bool enforce_children_psd_;
+	bool parallel_gradient_;
+	bool batched_psd_projection_;
+
+	// Per-thread gradient buffers
+	tbb::enumerable_thread_specific<Eigen::VectorXd> gradient_buffers_;
+
+	// Triplets layout (child index -> offset of its range in triplets_, and the layout version of the child's triplets it was built from)
+	std::vector<std::size_t> triplets_offsets_;
+	std::vector<uint64_t> triplets_layout_versions_;
+
+	// Children that write their values straight into their ranges (see ObjectiveFunction::SetTripletsTarget)
+	std::vector<bool> children_write_triplets_;
+
+	// Children whose local hessians are projected in batch (by size), whether each child defers its projection, and whether its hessian is pending projection
+	PsdProjectionBatch psd_projection_batch_4_;
+	PsdProjectionBatch psd_projection_batch_6_;
+	PsdProjectionBatch psd_projection_batch_8_;
+	std::vector<bool> psd_projection_deferred_;
+	std::vector<bool> psd_projection_pending_;
+	bool triplets_layout_valid_;
 };
 
 #endif
\ No newline at end of file
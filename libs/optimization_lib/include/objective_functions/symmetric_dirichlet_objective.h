@@ -4,6 +4,7 @@
 
 // STL includes
 #include <vector>
+#include <algorithm>
 
 // Eigen includes
 #include <Eigen/Core>
@@ -41,54 +42,45 @@ private:
 	/**
 	 * Overrides
 	 */
-	void CalculateValue(double& f) override
+	std::shared_ptr<UpdatableObject> CloneObject() const override
 	{
-		bool inversions_exist = UpdateJ(X);
-
-		// E = ||J||^2 + ||J^-1||^2 = ||J||^2 + ||J||^2 / det(J)^2
-		Eigen::VectorXd dirichlet = a.cwiseAbs2() + b.cwiseAbs2() + c.cwiseAbs2() + d.cwiseAbs2();
-		Eigen::VectorXd invDirichlet = dirichlet.cwiseQuotient(detJuv.cwiseAbs2());
-		Efi = dirichlet + invDirichlet;
+		return std::make_shared<SymmetricDirichlet>(*this);
+	}
 
+	void CalculateValue(double& f) override
+	{
+		UpdateJacobians();
 		f = 0.5 * (Area.asDiagonal() * Efi).sum();
 	}
 
 	void CalculateGradient(Eigen::VectorXd& g) override
 	{
-		bool inversions_exist = UpdateJ(X);
-		UpdateSSVDFunction();
-
-		Eigen::MatrixX2d invs = s.cwiseInverse();
+		UpdateSingularValues();
 
 		g.conservativeResize(X.size());
 		g.setZero();
-		ComputeDenseSSVDDerivatives();
 
-		for (int fi = 0; fi < numF; ++fi)
+		// Faces of the same color share no variables, so each color is scattered in parallel without conflicts
+		for (const auto& color_faces : face_colors)
 		{
-			double gS = s(fi, 0) - pow(invs(fi, 0), 3);
-			double gs = s(fi, 1) - pow(invs(fi, 1), 3);
-
-			if (bound > 0)
-			{
-				gS += gS / (bound - Efi(fi));
-				gs += gs / (bound - Efi(fi));
-			}
-
-			Eigen::Matrix<double, 6, 1> Dsdi0 = Dsd[0].col(fi);
-			Eigen::Matrix<double, 6, 1> Dsdi1 = Dsd[1].col(fi);
-			Eigen::Matrix<double, 6, 1> gi = Area(fi) * (Dsdi0 * gS + Dsdi1 * gs);
-
-			for (int vi = 0; vi < 6; ++vi)
+			const int color_faces_count = static_cast<int>(color_faces.size());
+			#pragma omp parallel for
+			for (int i = 0; i < color_faces_count; ++i)
 			{
-				g(Fuv(vi, fi)) += gi(vi);
+				AddFaceGradient(color_faces[i], g);
 			}
 		}
 	}
 	
+	// The per face intermediates are kept as long as x does not change (e.g. a value update followed by a full update at the same x)
 	void PreUpdate(const Eigen::VectorXd& x) override
 	{
-		X = Eigen::Map<const Eigen::MatrixX2d>(x.data(), x.rows() >> 1, 2);
+		const Eigen::Map<const Eigen::MatrixX2d> X_new(x.data(), x.rows() >> 1, 2);
+		if (X.rows() != X_new.rows() || X != X_new)
+		{
+			X = X_new;
+			x_version++;
+		}
 	}
 
 	
@@ -152,6 +144,10 @@ private:
 		b2d.bottomRows(3) = 0.5 * D1d;
 
 		Hi.resize(numF);
+
+		InitializeFaceColors(Fs);
+
+		x_version++;
 	}
 
 	void InitializeTriplets(std::vector<Eigen::Triplet<double>>& triplets) override
@@ -207,26 +203,9 @@ private:
 		}
 	}
 	
-	void CalculateRawTriplets(std::vector<Eigen::Triplet<double>>& triplets) override
+	void CalculateRawTriplets(const TripletsView& triplets) override
 	{
-		auto lambda1 = [](double a) {return a - 1.0 / (a * a * a); };
-
-		// gradient of outer function in composition
-		Eigen::VectorXd gradfS = s.col(0).unaryExpr(lambda1);
-		Eigen::VectorXd gradfs = s.col(1).unaryExpr(lambda1);
-		auto lambda2 = [](double a) {return 1 + 3 / (a * a * a * a); };
-
-		// hessian of outer function in composition (diagonal)
-		Eigen::VectorXd HS = s.col(0).unaryExpr(lambda2);
-		Eigen::VectorXd Hs = s.col(1).unaryExpr(lambda2);
-
-		// similarity alpha
-		Eigen::VectorXd aY = 0.5 * (a + d);
-		Eigen::VectorXd bY = 0.5 * (c - b);
-
-		// anti similarity beta
-		Eigen::VectorXd cY = 0.5 * (a - d);
-		Eigen::VectorXd dY = 0.5 * (b + c);
+		UpdateSingularValues();
 
 		#pragma omp parallel for
 		for (int i = 0; i < numF; ++i) 
@@ -354,6 +333,114 @@ private:
 		return H;
 	}
 
+	void AddFaceGradient(const int fi, Eigen::VectorXd& g) const
+	{
+		double gS = gradfS(fi);
+		double gs = gradfs(fi);
+
+		if (bound > 0)
+		{
+			gS += gS / (bound - Efi(fi));
+			gs += gs / (bound - Efi(fi));
+		}
+
+		Eigen::Matrix<double, 6, 1> Dsdi0 = Dsd[0].col(fi);
+		Eigen::Matrix<double, 6, 1> Dsdi1 = Dsd[1].col(fi);
+		Eigen::Matrix<double, 6, 1> gi = Area(fi) * (Dsdi0 * gS + Dsdi1 * gs);
+
+		for (int vi = 0; vi < 6; ++vi)
+		{
+			g(Fuv(vi, fi)) += gi(vi);
+		}
+	}
+
+	// Greedy coloring of the faces, where faces that share a vertex get different colors. The faces of a triangle soup (see MeshWrapper::GenerateSoupFaces)
+	// share no vertices, so they all get a single color and the gradient is scattered in one fully parallel pass.
+	void InitializeFaceColors(const Eigen::MatrixX3i& faces)
+	{
+		face_colors.clear();
+		std::vector<std::vector<std::size_t>> vertex_colors(numV);
+		std::vector<std::size_t> used_colors;
+		for (int fi = 0; fi < faces.rows(); ++fi)
+		{
+			used_colors.clear();
+			for (int vi = 0; vi < 3; ++vi)
+			{
+				const auto& colors = vertex_colors[faces(fi, vi)];
+				used_colors.insert(used_colors.end(), colors.begin(), colors.end());
+			}
+
+			std::size_t color = 0;
+			while (std::find(used_colors.begin(), used_colors.end(), color) != used_colors.end())
+			{
+				color++;
+			}
+
+			if (color == face_colors.size())
+			{
+				face_colors.emplace_back();
+			}
+
+			face_colors[color].push_back(fi);
+			for (int vi = 0; vi < 3; ++vi)
+			{
+				vertex_colors[faces(fi, vi)].push_back(color);
+			}
+		}
+	}
+
+	// Jacobians, their determinants and the per face energies of the current x
+	void UpdateJacobians()
+	{
+		if (jacobians_version == x_version)
+		{
+			return;
+		}
+
+		bool inversions_exist = UpdateJ(X);
+
+		// E = ||J||^2 + ||J^-1||^2 = ||J||^2 + ||J||^2 / det(J)^2
+		Eigen::VectorXd dirichlet = a.cwiseAbs2() + b.cwiseAbs2() + c.cwiseAbs2() + d.cwiseAbs2();
+		Eigen::VectorXd invDirichlet = dirichlet.cwiseQuotient(detJuv.cwiseAbs2());
+		Efi = dirichlet + invDirichlet;
+
+		jacobians_version = x_version;
+	}
+
+	// Singular values, their derivatives and the outer function derivatives of the current x (shared by the gradient and the hessian)
+	void UpdateSingularValues()
+	{
+		UpdateJacobians();
+		if (singular_values_version == x_version)
+		{
+			return;
+		}
+
+		UpdateSSVDFunction();
+		ComputeDenseSSVDDerivatives();
+
+		auto lambda1 = [](double a) {return a - 1.0 / (a * a * a); };
+
+		// gradient of outer function in composition
+		gradfS = s.col(0).unaryExpr(lambda1);
+		gradfs = s.col(1).unaryExpr(lambda1);
+		auto lambda2 = [](double a) {return 1 + 3 / (a * a * a * a); };
+
+		// hessian of outer function in composition (diagonal)
+		HS = s.col(0).unaryExpr(lambda2);
+		Hs = s.col(1).unaryExpr(lambda2);
+
+		// similarity alpha
+		aY = 0.5 * (a + d);
+		bY = 0.5 * (c - b);
+
+		// anti similarity beta
+		cY = 0.5 * (a - d);
+		dY = 0.5 * (b + c);
+
+		singular_values_version = x_version;
+	}
+
 	bool UpdateJ(const Eigen::MatrixX2d& x)
 	{
 		Eigen::Map<const Eigen::Matrix3Xd> X1(x.data(), 3, F.rows());
@@ -367,18 +454,24 @@ private:
 		return ((detJuv.array() < 0).any());
 	}
 	
+	// Blocks of faces are decomposed in parallel, each by the (vectorized) batched SSVD2x2
 	void UpdateSSVDFunction()
 	{
+		const Eigen::Index faces_count = a.size();
+		const Eigen::Index blocks_count = (faces_count + SSVDBlockSize - 1) / SSVDBlockSize;
 		#pragma omp parallel for
-		for (int i = 0; i < a.size(); i++)
+		for (Eigen::Index block = 0; block < blocks_count; block++)
 		{
-			Eigen::Matrix2d A;
-			Eigen::Matrix2d U, S, V;
-			A << a[i], b[i], c[i], d[i];
-			Utils::SSVD2x2(A, U, S, V);
-			u.row(i) << U(0), U(1), U(2), U(3);
-			v.row(i) << V(0), V(1), V(2), V(3);
-			s.row(i) << S(0), S(3);
+			const Eigen::Index begin = block * SSVDBlockSize;
+			const Eigen::Index size = std::min(SSVDBlockSize, faces_count - begin);
+			Utils::SSVD2x2(
+				a.segment(begin, size),
+				b.segment(begin, size),
+				c.segment(begin, size),
+				d.segment(begin, size),
+				s.middleRows(begin, size),
+				u.middleRows(begin, size),
+				v.middleRows(begin, size));
 		}
 	}
 	
@@ -401,6 +494,10 @@ private:
 	/**
 	 * Private fields
 	 */
+
+	// Faces per batched SSVD2x2 call
+	static constexpr Eigen::Index SSVDBlockSize = 1024;
+
 	Eigen::MatrixX2d X;
 
 	double bound=0;
@@ -431,6 +528,23 @@ private:
 	// Efi = sum(Ef_dist.^2, 2), for data->Efi history
 	Eigen::VectorXd Efi;
 
+	// Outer function derivatives per face (gradient and diagonal hessian)
+	Eigen::VectorXd gradfS;
+	Eigen::VectorXd gradfs;
+	Eigen::VectorXd HS;
+	Eigen::VectorXd Hs;
+
+	// Similarity (alpha) and anti similarity (beta) parts of the Jacobian per face
+	Eigen::VectorXd aY;
+	Eigen::VectorXd bY;
+	Eigen::VectorXd cY;
+	Eigen::VectorXd dY;
+
+	// Version of X, and the versions the per face intermediates were computed for
+	uint64_t x_version = 0;
+	uint64_t jacobians_version = 0;
+	uint64_t singular_values_version = 0;
+
 	// F of cut mesh for u and v indices 6XnumF
 	Eigen::MatrixXi Fuv;
 	Eigen::VectorXd Area;
@@ -446,6 +560,9 @@ private:
 
 	// Per face Hessians vector
 	std::vector<Eigen::Matrix<double,6,6>> Hi;
+
+	// Faces by color (faces of the same color share no vertices)
+	std::vector<std::vector<int>> face_colors;
 };
 
 #endif
\ No newline at end of file
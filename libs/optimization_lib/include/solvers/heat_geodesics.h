@@ -0,0 +1,117 @@
+#pragma once
+#ifndef OPTIMIZATION_LIB_HEAT_GEODESICS_H
+#define OPTIMIZATION_LIB_HEAT_GEODESICS_H
+
+// STL includes
+#include <vector>
+
+// Eigen includes
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+
+// LIBIGL includes
+#include <igl/grad.h>
+#include <igl/doublearea.h>
+#include <igl/avg_edge_length.h>
+
+// Optimization lib includes
+#include "../core/core.h"
+
+// Approximate geodesic distances by the heat method (Crane et al., "Geodesics in Heat").
+// The heat operator A + t * W and the poisson operator W are factorized once, so every query (single or multiple sources) costs two back-substitutions.
+// W is the (positive semi-definite) cotangent laplacian and A is the lumped mass matrix of the same geometry as v.
+// All queries are const and may run concurrently.
+class HeatGeodesics
+{
+public:
+	/**
+	 * Constructors and destructor
+	 */
+	HeatGeodesics(const Eigen::MatrixX3d& v, const Eigen::MatrixX3i& f, const Eigen::SparseMatrix<double>& W, const Eigen::SparseMatrix<double>& A)
+	{
+		// Face gradient operator, stacked as [x components of all faces; y components; z components]
+		igl::grad(v, f, G_);
+
+		Eigen::VectorXd double_area;
+		igl::doublearea(v, f, double_area);
+		face_areas_ = (double_area / 2).replicate(3, 1);
+
+		// Time step t = h^2, where h is the mean edge length
+		const double h = igl::avg_edge_length(v, f);
+		heat_solver_.compute(A + (h * h) * W);
+		if (heat_solver_.info() != Eigen::Success)
+		{
+			throw std::exception("Heat operator factorization failed");
+		}
+
+		// W is singular (constants), so a tiny mass term is added; the constant offset is removed after every solve anyway
+		poisson_solver_.compute(W + 1e-8 * A);
+		if (poisson_solver_.info() != Eigen::Success)
+		{
+			throw std::exception("Poisson operator factorization failed");
+		}
+	}
+
+	virtual ~HeatGeodesics()
+	{
+
+	}
+
+	/**
+	 * Public methods
+	 */
+	Eigen::VectorXd Compute(const RDS::VertexIndex source) const
+	{
+		return Compute(std::vector<RDS::VertexIndex>{ source });
+	}
+
+	Eigen::VectorXd Compute(const std::vector<RDS::VertexIndex>& sources) const
+	{
+		const int64_t faces_count = G_.rows() / 3;
+
+		// Diffuse heat from the sources for time t
+		Eigen::VectorXd u0 = Eigen::VectorXd::Zero(G_.cols());
+		for (const auto source : sources)
+		{
+			u0.coeffRef(source) = 1;
+		}
+
+		const Eigen::VectorXd u = heat_solver_.solve(u0);
+
+		// Normalized (negated) heat gradient per face, pointing away from the sources
+		Eigen::VectorXd X = G_ * u;
+		for (int64_t face_index = 0; face_index < faces_count; face_index++)
+		{
+			const double norm = std::sqrt(X.coeff(face_index) * X.coeff(face_index) + X.coeff(faces_count + face_index) * X.coeff(faces_count + face_index) + X.coeff(2 * faces_count + face_index) * X.coeff(2 * faces_count + face_index));
+			const double factor = norm > 0 ? -1 / norm : 0;
+			X.coeffRef(face_index) *= factor;
+			X.coeffRef(faces_count + face_index) *= factor;
+			X.coeffRef(2 * faces_count + face_index) *= factor;
+		}
+
+		// Recover the distance whose gradient best fits X (W * phi = div(X)), and shift it to vanish at the sources
+		const Eigen::VectorXd divergence = G_.transpose() * face_areas_.cwiseProduct(X);
+		Eigen::VectorXd distances = poisson_solver_.solve(divergence);
+
+		double offset = 0;
+		for (const auto source : sources)
+		{
+			offset += distances.coeff(source);
+		}
+
+		distances.array() -= offset / sources.size();
+		return distances.cwiseMax(0);
+	}
+
+private:
+	/**
+	 * Private fields
+	 */
+	Eigen::SparseMatrix<double> G_;
+	Eigen::VectorXd face_areas_;
+	Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> heat_solver_;
+	Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> poisson_solver_;
+};
+
+#endif
@@ -0,0 +1,96 @@
+#pragma once
+#ifndef OPTIMIZATION_LIB_LAPLACIAN_EIGEN_BASIS_H
+#define OPTIMIZATION_LIB_LAPLACIAN_EIGEN_BASIS_H
+
+// STL includes
+#include <memory>
+#include <algorithm>
+
+// Eigen includes
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+
+// Spectra includes
+#include <Spectra/SymEigsShiftSolver.h>
+#include <Spectra/MatOp/SparseSymShiftSolve.h>
+
+// Optimization lib includes
+#include "../core/core.h"
+#include "./mass_matrix_operator.h"
+
+// The low-frequency eigenpairs of a mesh's laplacian (W * x = lambda * A * x), computed once and meant to be shared (read-only) by every
+// objective that solves a shifted problem on the same mesh. The basis is stored in the standardized coordinates y = A^1/2 * x, in which it is orthonormal.
+// Requires a lumped (diagonal) mass matrix.
+class LaplacianEigenBasis
+{
+public:
+	/**
+	 * Constructors and destructor
+	 */
+	LaplacianEigenBasis(const Eigen::SparseMatrix<double>& W, const std::shared_ptr<MassMatrixOperator>& mass_matrix_operator, const int64_t basis_size = RDS_REDUCED_BASIS_SIZE)
+	{
+		if (!mass_matrix_operator->IsDiagonal())
+		{
+			throw std::exception("Laplacian eigen basis requires a lumped mass matrix");
+		}
+
+		const int64_t n = W.rows();
+		if (basis_size <= 0 || basis_size >= n)
+		{
+			throw std::exception("Invalid laplacian eigen basis size");
+		}
+
+		const auto& inverse_sqrt_diagonal = mass_matrix_operator->GetInverseSqrtDiagonal();
+		Eigen::SparseMatrix<double> W_scaled = inverse_sqrt_diagonal.asDiagonal() * W * inverse_sqrt_diagonal.asDiagonal();
+
+		// W is singular (constant vectors), so shift slightly to the left of the spectrum; any negative shift selects the smallest eigenvalues
+		const double sigma = -1e-6 * W_scaled.diagonal().mean();
+		const int64_t ncv = std::min(n, std::max(2 * basis_size + 1, basis_size + 20));
+
+		Spectra::SparseSymShiftSolve<double> op(W_scaled);
+		Spectra::SymEigsShiftSolver<double, Spectra::LARGEST_MAGN, Spectra::SparseSymShiftSolve<double>> eigs(&op, basis_size, ncv, sigma);
+		eigs.init();
+		eigs.compute();
+		if (eigs.info() != Spectra::SUCCESSFUL)
+		{
+			throw std::exception("Laplacian eigen basis computation did not converge");
+		}
+
+		eigenvalues_ = eigs.eigenvalues();
+		basis_ = eigs.eigenvectors();
+	}
+
+	virtual ~LaplacianEigenBasis()
+	{
+
+	}
+
+	/**
+	 * Public getters
+	 */
+
+	// n x k, orthonormal, in y = A^1/2 * x coordinates
+	const Eigen::MatrixXd& GetBasis() const
+	{
+		return basis_;
+	}
+
+	const Eigen::VectorXd& GetEigenvalues() const
+	{
+		return eigenvalues_;
+	}
+
+	int64_t GetSize() const
+	{
+		return basis_.cols();
+	}
+
+private:
+	/**
+	 * Private fields
+	 */
+	Eigen::MatrixXd basis_;
+	Eigen::VectorXd eigenvalues_;
+};
+
+#endif
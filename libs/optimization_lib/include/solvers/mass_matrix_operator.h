@@ -0,0 +1,145 @@
+#pragma once
+#ifndef OPTIMIZATION_LIB_MASS_MATRIX_OPERATOR_H
+#define OPTIMIZATION_LIB_MASS_MATRIX_OPERATOR_H
+
+// Eigen includes
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+
+// Spectra B-operator for the regular inverse mode of the generalized eigensolver, built once per mesh.
+// A lumped (diagonal) mass matrix is detected and kept as a vector, which also allows callers to reduce the generalized problem
+// (W + A * diag(v)) * x = lambda * A * x to the standard problem (A^-1/2 * W * A^-1/2 + diag(v)) * y = lambda * y, with x = A^-1/2 * y.
+// A non-diagonal mass matrix is factorized once with a sparse LDLT decomposition.
+// All operations are const and may be shared by concurrent solves.
+class MassMatrixOperator
+{
+public:
+	/**
+	 * Constructors and destructor
+	 */
+	MassMatrixOperator(const Eigen::SparseMatrix<double>& A) :
+		A_(A),
+		is_diagonal_(true)
+	{
+		for (int64_t col = 0; col < A_.outerSize() && is_diagonal_; col++)
+		{
+			for (Eigen::SparseMatrix<double>::InnerIterator it(A_, col); it; ++it)
+			{
+				if (it.row() != it.col() && it.value() != 0)
+				{
+					is_diagonal_ = false;
+					break;
+				}
+			}
+		}
+
+		if (is_diagonal_)
+		{
+			diagonal_ = A_.diagonal();
+			if ((diagonal_.array() <= 0).any())
+			{
+				throw std::exception("Mass matrix has a non-positive diagonal entry");
+			}
+
+			inverse_diagonal_ = diagonal_.cwiseInverse();
+			sqrt_diagonal_ = diagonal_.cwiseSqrt();
+			inverse_sqrt_diagonal_ = sqrt_diagonal_.cwiseInverse();
+		}
+		else
+		{
+			ldlt_.compute(A_);
+			if (ldlt_.info() != Eigen::Success)
+			{
+				throw std::exception("Mass matrix factorization failed");
+			}
+		}
+	}
+
+	virtual ~MassMatrixOperator()
+	{
+
+	}
+
+	/**
+	 * Public getters
+	 */
+	bool IsDiagonal() const
+	{
+		return is_diagonal_;
+	}
+
+	const Eigen::VectorXd& GetDiagonal() const
+	{
+		return diagonal_;
+	}
+
+	const Eigen::VectorXd& GetSqrtDiagonal() const
+	{
+		return sqrt_diagonal_;
+	}
+
+	const Eigen::VectorXd& GetInverseSqrtDiagonal() const
+	{
+		return inverse_sqrt_diagonal_;
+	}
+
+	/**
+	 * Spectra matrix operation interface
+	 */
+	Eigen::Index rows() const
+	{
+		return A_.rows();
+	}
+
+	Eigen::Index cols() const
+	{
+		return A_.cols();
+	}
+
+	// y_out = inv(A) * x_in
+	void solve(const double* x_in, double* y_out) const
+	{
+		Eigen::Map<const Eigen::VectorXd> x(x_in, A_.rows());
+		Eigen::Map<Eigen::VectorXd> y(y_out, A_.rows());
+		if (is_diagonal_)
+		{
+			y = inverse_diagonal_.cwiseProduct(x);
+		}
+		else
+		{
+			y = ldlt_.solve(x);
+		}
+	}
+
+	// y_out = A * x_in
+	void mat_prod(const double* x_in, double* y_out) const
+	{
+		Eigen::Map<const Eigen::VectorXd> x(x_in, A_.rows());
+		Eigen::Map<Eigen::VectorXd> y(y_out, A_.rows());
+		if (is_diagonal_)
+		{
+			y = diagonal_.cwiseProduct(x);
+		}
+		else
+		{
+			y.noalias() = A_ * x;
+		}
+	}
+
+private:
+	/**
+	 * Private fields
+	 */
+	Eigen::SparseMatrix<double> A_;
+	Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> ldlt_;
+	bool is_diagonal_;
+
+	// Lumped mass matrix only
+	Eigen::VectorXd diagonal_;
+	Eigen::VectorXd inverse_diagonal_;
+	Eigen::VectorXd sqrt_diagonal_;
+	Eigen::VectorXd inverse_sqrt_diagonal_;
+};
+
+#endif
@@ -0,0 +1,136 @@
+#pragma once
+#ifndef OPTIMIZATION_LIB_SHIFTED_LAPLACIAN_OPERATOR_H
+#define OPTIMIZATION_LIB_SHIFTED_LAPLACIAN_OPERATOR_H
+
+// STL includes
+#include <vector>
+
+// Eigen includes
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+
+// Spectra matrix operation that computes y = (W + A * diag(v)) * x, where W is a laplacian and A is a mass matrix.
+// The union sparsity pattern of W and A is compressed once, and setting a new potential v only rewrites (in place) the entries that A contributes to.
+class ShiftedLaplacianOperator
+{
+public:
+	/**
+	 * Constructors and destructor
+	 */
+	ShiftedLaplacianOperator(const Eigen::SparseMatrix<double>& W, const Eigen::SparseMatrix<double>& A)
+	{
+		InitializePattern(W, A);
+	}
+
+	virtual ~ShiftedLaplacianOperator()
+	{
+
+	}
+
+	/**
+	 * Public getters
+	 */
+	const Eigen::SparseMatrix<double, Eigen::RowMajor>& GetMatrix() const
+	{
+		return M_;
+	}
+
+	/**
+	 * Public setters
+	 */
+	void SetPotential(const Eigen::VectorXd& v)
+	{
+		double* values = M_.valuePtr();
+		const int64_t mass_entries_count = mass_entry_value_indices_.size();
+
+		#pragma omp parallel for
+		for (int64_t i = 0; i < mass_entries_count; i++)
+		{
+			values[mass_entry_value_indices_[i]] = mass_entry_laplacian_values_[i] + mass_entry_mass_values_[i] * v.coeff(mass_entry_columns_[i]);
+		}
+	}
+
+	/**
+	 * Spectra matrix operation interface
+	 */
+	Eigen::Index rows() const
+	{
+		return M_.rows();
+	}
+
+	Eigen::Index cols() const
+	{
+		return M_.cols();
+	}
+
+	void perform_op(const double* x_in, double* y_out) const
+	{
+		Eigen::Map<const Eigen::VectorXd> x(x_in, M_.cols());
+		Eigen::Map<Eigen::VectorXd> y(y_out, M_.rows());
+		y.noalias() = M_ * x;
+	}
+
+private:
+	/**
+	 * Private methods
+	 */
+	void InitializePattern(const Eigen::SparseMatrix<double>& W, const Eigen::SparseMatrix<double>& A)
+	{
+		const Eigen::SparseMatrix<double, Eigen::RowMajor> W_row_major = W;
+		const Eigen::SparseMatrix<double, Eigen::RowMajor> A_row_major = A;
+
+		// Eigen's sparse sum keeps every structural entry of both operands, so this is exactly the union pattern
+		M_ = W_row_major + A_row_major;
+		M_.makeCompressed();
+
+		mass_entry_value_indices_.clear();
+		mass_entry_columns_.clear();
+		mass_entry_laplacian_values_.clear();
+		mass_entry_mass_values_.clear();
+
+		double* values = M_.valuePtr();
+		for (int64_t row = 0; row < M_.outerSize(); row++)
+		{
+			Eigen::SparseMatrix<double, Eigen::RowMajor>::InnerIterator W_it(W_row_major, row);
+			Eigen::SparseMatrix<double, Eigen::RowMajor>::InnerIterator A_it(A_row_major, row);
+			int64_t value_index = M_.outerIndexPtr()[row];
+			for (Eigen::SparseMatrix<double, Eigen::RowMajor>::InnerIterator M_it(M_, row); M_it; ++M_it, value_index++)
+			{
+				const int64_t column = M_it.col();
+
+				double laplacian_value = 0;
+				if (W_it && W_it.col() == column)
+				{
+					laplacian_value = W_it.value();
+					++W_it;
+				}
+
+				if (A_it && A_it.col() == column)
+				{
+					mass_entry_value_indices_.push_back(value_index);
+					mass_entry_columns_.push_back(column);
+					mass_entry_laplacian_values_.push_back(laplacian_value);
+					mass_entry_mass_values_.push_back(A_it.value());
+					++A_it;
+				}
+
+				values[value_index] = laplacian_value;
+			}
+		}
+	}
+
+	/**
+	 * Private fields
+	 */
+
+	// W + A * diag(v), stored with the fixed union pattern of W and A
+	Eigen::SparseMatrix<double, Eigen::RowMajor> M_;
+
+	// Entries of M_ that depend on v (for a lumped mass matrix, these are the diagonal entries only)
+	std::vector<int64_t> mass_entry_value_indices_;
+	std::vector<int64_t> mass_entry_columns_;
+	std::vector<double> mass_entry_laplacian_values_;
+	std::vector<double> mass_entry_mass_values_;
+};
+
+#endif
@@ -1,15 +1,33 @@
 // STL includes
 #include <algorithm>
+#include <utility>
 
 // Optimization lib includes
 #include <core/updatable_object.h>
 
+std::atomic<uint64_t> UpdatableObject::last_state_version_(0);
+
 UpdatableObject::UpdatableObject(const std::shared_ptr<MeshDataProvider>& mesh_data_provider) :
-	mesh_data_provider_(mesh_data_provider)
+	mesh_data_provider_(mesh_data_provider),
+	update_x_(nullptr),
+	update_modifiers_(0),
+	state_version_(0),
+	dirty_tracking_(false)
 {
 	
 }
 
+UpdatableObject::UpdatableObject(const UpdatableObject& other) :
+	mesh_data_provider_(other.mesh_data_provider_),
+	dependencies_(other.dependencies_),
+	update_x_(nullptr),
+	update_modifiers_(0),
+	state_version_(other.state_version_.load()),
+	dirty_tracking_(other.dirty_tracking_)
+{
+
+}
+
 UpdatableObject::~UpdatableObject()
 {
 	
@@ -17,7 +35,8 @@ UpdatableObject::~UpdatableObject()
 
 void UpdatableObject::Initialize()
 {
-	InitializeDependencyLayers(dependency_layers_);
+	InitializeDependencyGraph();
+	Invalidate();
 }
 
 [[nodiscard]] std::shared_ptr<MeshDataProvider> UpdatableObject::GetMeshDataProvider() const
@@ -30,41 +49,379 @@ const tbb::concurrent_vector<std::shared_ptr<UpdatableObject>>& UpdatableObject:
 	return dependencies_;
 }
 
-void UpdatableObject::InitializeDependencyLayers(std::vector<std::vector<std::shared_ptr<UpdatableObject>>>& dependency_layers)
+uint64_t UpdatableObject::GetStateVersion() const
+{
+	uint64_t state_version = state_version_;
+	for (const auto& node : nodes_)
+	{
+		state_version = std::max<uint64_t>(state_version, node->state_version_);
+	}
+
+	return state_version;
+}
+
+int64_t UpdatableObject::GetUpdateCost() const
+{
+	return 1;
+}
+
+bool UpdatableObject::GetVariablesFootprint(std::vector<RDS::SparseVariableIndex>& variables_footprint) const
+{
+	return false;
+}
+
+void UpdatableObject::SetDirtyTracking(const bool dirty_tracking)
+{
+	dirty_tracking_ = dirty_tracking;
+	InvalidateDependencies();
+}
+
+void UpdatableObject::Invalidate()
+{
+	state_version_ = ++last_state_version_;
+}
+
+void UpdatableObject::InvalidateDependencies()
+{
+	std::fill(node_update_modifiers_.begin(), node_update_modifiers_.end(), 0);
+	previous_x_.resize(0);
+}
+
+std::shared_ptr<UpdatableObject> UpdatableObject::Clone(CloneMap& clones) const
 {
-	dependency_layers_.clear();
+	const auto it = clones.find(this);
+	if (it != clones.end())
+	{
+		return it->second;
+	}
+
+	auto clone = CloneObject();
+	clones.emplace(this, clone);
 	for (const auto& dependency : dependencies_)
 	{
-		BuildDependencyLayers(dependency, dependency_layers);
+		dependency->Clone(clones);
+	}
+
+	clone->RemapDependencies(clones);
+	clone->InitializeDependencyGraph();
+	return clone;
+}
+
+std::shared_ptr<UpdatableObject> UpdatableObject::CloneObject() const
+{
+	throw std::exception("UpdatableObject::CloneObject - Cloning is not supported by this object");
+}
+
+void UpdatableObject::RemapDependencies(const CloneMap& clones)
+{
+	for (auto& dependency : dependencies_)
+	{
+		dependency = Remap(dependency, clones);
 	}
 }
 
-int UpdatableObject::BuildDependencyLayers(const std::shared_ptr<UpdatableObject>& updatable_object, std::vector<std::vector<std::shared_ptr<UpdatableObject>>>& dependency_layers) const
+void UpdatableObject::UpdateDependencies(const Eigen::VectorXd& x, const int32_t update_modifiers)
 {
-	if(updatable_object->GetDependencies().empty())
+	if (dirty_tracking_ && previous_x_.size() == x.size())
 	{
-		if(dependency_layers.empty())
+		changed_variables_.clear();
+		for (Eigen::Index i = 0; i < x.size(); i++)
 		{
-			dependency_layers.resize(1);
+			if (x.coeff(i) != previous_x_.coeff(i))
+			{
+				changed_variables_.push_back(i);
+			}
 		}
 
-		dependency_layers[0].push_back(updatable_object);
-		return 0;
+		MarkChangedNodes(update_modifiers, changed_variables_);
 	}
+	else
+	{
+		std::fill(node_changed_.begin(), node_changed_.end(), 1);
+	}
+
+	RunUpdateGraph(x, update_modifiers);
+}
+
+void UpdatableObject::UpdateDependencies(const Eigen::VectorXd& x, const int32_t update_modifiers, const std::vector<RDS::SparseVariableIndex>& changed_variables)
+{
+	MarkChangedNodes(update_modifiers, changed_variables);
+	RunUpdateGraph(x, update_modifiers);
+}
+
+// A node is re-evaluated if one of its footprint variables changed, if it was invalidated, if one of its dependencies is re-evaluated,
+// or if its cached results do not cover the requested update modifiers
+void UpdatableObject::MarkChangedNodes(const int32_t update_modifiers, const std::vector<RDS::SparseVariableIndex>& changed_variables)
+{
+	const auto nodes_count = nodes_.size();
+	for (std::size_t node_index = 0; node_index < nodes_count; node_index++)
+	{
+		node_changed_[node_index] =
+			!node_footprint_known_[node_index] ||
+			((node_update_modifiers_[node_index] & update_modifiers) != update_modifiers) ||
+			(nodes_[node_index]->state_version_ != node_state_versions_[node_index]);
+	}
+
+	const auto footprint_variables_count = static_cast<RDS::SparseVariableIndex>(variable_node_offsets_.size()) - 1;
+	for (const auto variable_index : changed_variables)
+	{
+		if (variable_index < footprint_variables_count)
+		{
+			for (auto i = variable_node_offsets_[variable_index]; i < variable_node_offsets_[variable_index + 1]; i++)
+			{
+				node_changed_[variable_nodes_[i]] = 1;
+			}
+		}
+	}
+
+	for (std::size_t node_index = 0; node_index < nodes_count; node_index++)
+	{
+		if (!node_changed_[node_index])
+		{
+			for (const auto dependency_index : node_dependencies_[node_index])
+			{
+				if (node_changed_[dependency_index])
+				{
+					node_changed_[node_index] = 1;
+					break;
+				}
+			}
+		}
+	}
+}
 
-	std::vector<int> heights;
+void UpdatableObject::RunUpdateGraph(const Eigen::VectorXd& x, const int32_t update_modifiers)
+{
+	update_x_ = &x;
+	update_modifiers_ = update_modifiers;
+	if (update_graph_ == nullptr)
+	{
+		for (std::size_t chunk_index = 0; chunk_index < update_chunks_.size(); chunk_index++)
+		{
+			UpdateChunk(chunk_index);
+		}
+	}
+	else
+	{
+		for (const auto source_update_chunk : source_update_chunks_)
+		{
+			update_nodes_[source_update_chunk]->try_put(tbb::flow::continue_msg());
+		}
+
+		update_graph_->wait_for_all();
+	}
+
+	update_x_ = nullptr;
+	if (dirty_tracking_)
+	{
+		previous_x_ = x;
+	}
+}
+
+void UpdatableObject::UpdateChunk(const std::size_t chunk_index)
+{
+	for (const auto node_index : update_chunks_[chunk_index])
+	{
+		if (node_changed_[node_index])
+		{
+			// An invalidation that happens during the update (e.g. by a dependent objective) is picked up by the next one
+			const uint64_t state_version = nodes_[node_index]->state_version_;
+			nodes_[node_index]->Update(*update_x_, update_modifiers_);
+			node_update_modifiers_[node_index] = update_modifiers_;
+			node_state_versions_[node_index] = state_version;
+		}
+	}
+}
+
+void UpdatableObject::InitializeDependencyGraph()
+{
+	/**
+	 * Collect the (distinct) direct and indirect dependencies, in topological order
+	 */
+	std::unordered_map<UpdatableObject*, std::size_t> node_indices;
+	nodes_.clear();
+	node_dependencies_.clear();
+	for (const auto& dependency : dependencies_)
+	{
+		BuildDependencyGraph(dependency, node_indices);
+	}
+
+	InitializeVariablesFootprints();
+
+	/**
+	 * Split the nodes into topological levels (a node is one level above its deepest dependency), and pack each level into chunks by estimated cost.
+	 * The nodes of a level are ordered by the chunks they depend on, so that nodes that share predecessor chunks (e.g. the per-element objectives
+	 * of a summation, which all depend on the same data providers chunks) land in the same chunks. A chunk waits for the predecessor chunks of all
+	 * its nodes, and since those are on lower levels, the chunks graph is acyclic.
+	 */
+	std::vector<std::size_t> node_levels(nodes_.size(), 0);
+	std::size_t levels_count = 0;
+	for (std::size_t node_index = 0; node_index < nodes_.size(); node_index++)
+	{
+		for (const auto dependency_index : node_dependencies_[node_index])
+		{
+			node_levels[node_index] = std::max(node_levels[node_index], node_levels[dependency_index] + 1);
+		}
+
+		levels_count = std::max(levels_count, node_levels[node_index] + 1);
+	}
+
+	std::vector<std::vector<std::size_t>> levels(levels_count);
+	for (std::size_t node_index = 0; node_index < nodes_.size(); node_index++)
+	{
+		levels[node_levels[node_index]].push_back(node_index);
+	}
+
+	update_chunks_.clear();
+	std::vector<std::size_t> node_chunks(nodes_.size());
+	std::vector<std::vector<std::size_t>> chunk_predecessors;
+	for (const auto& level : levels)
+	{
+		std::vector<std::pair<std::vector<std::size_t>, std::size_t>> level_nodes;
+		level_nodes.reserve(level.size());
+		for (const auto node_index : level)
+		{
+			std::vector<std::size_t> predecessor_chunks;
+			for (const auto dependency_index : node_dependencies_[node_index])
+			{
+				predecessor_chunks.push_back(node_chunks[dependency_index]);
+			}
+
+			std::sort(predecessor_chunks.begin(), predecessor_chunks.end());
+			predecessor_chunks.erase(std::unique(predecessor_chunks.begin(), predecessor_chunks.end()), predecessor_chunks.end());
+			level_nodes.emplace_back(std::move(predecessor_chunks), node_index);
+		}
+
+		std::sort(level_nodes.begin(), level_nodes.end());
+
+		int64_t chunk_cost = UpdateChunkCost;
+		for (const auto& [predecessor_chunks, node_index] : level_nodes)
+		{
+			if (chunk_cost >= UpdateChunkCost)
+			{
+				update_chunks_.emplace_back();
+				chunk_predecessors.emplace_back();
+				chunk_cost = 0;
+			}
+
+			update_chunks_.back().push_back(node_index);
+			chunk_predecessors.back().insert(chunk_predecessors.back().end(), predecessor_chunks.begin(), predecessor_chunks.end());
+			node_chunks[node_index] = update_chunks_.size() - 1;
+			chunk_cost += nodes_[node_index]->GetUpdateCost();
+		}
+	}
+
+	/**
+	 * Build the task graph (a single chunk is simply updated in place)
+	 */
+	update_nodes_.clear();
+	update_graph_.reset();
+	source_update_chunks_.clear();
+	if (update_chunks_.size() <= 1)
+	{
+		return;
+	}
+
+	update_graph_ = std::make_unique<tbb::flow::graph>();
+	for (std::size_t chunk_index = 0; chunk_index < update_chunks_.size(); chunk_index++)
+	{
+		update_nodes_.push_back(std::make_unique<UpdateNode>(*update_graph_, [this, chunk_index](const tbb::flow::continue_msg&) {
+			UpdateChunk(chunk_index);
+			return tbb::flow::continue_msg();
+		}));
+	}
+
+	for (std::size_t chunk_index = 0; chunk_index < update_chunks_.size(); chunk_index++)
+	{
+		auto& predecessor_chunks = chunk_predecessors[chunk_index];
+		std::sort(predecessor_chunks.begin(), predecessor_chunks.end());
+		predecessor_chunks.erase(std::unique(predecessor_chunks.begin(), predecessor_chunks.end()), predecessor_chunks.end());
+		if (predecessor_chunks.empty())
+		{
+			source_update_chunks_.push_back(chunk_index);
+		}
+
+		for (const auto predecessor_chunk : predecessor_chunks)
+		{
+			tbb::flow::make_edge(*update_nodes_[predecessor_chunk], *update_nodes_[chunk_index]);
+		}
+	}
+}
+
+// Depth-first traversal; an object that is shared by several dependents is added (and updated) once
+std::size_t UpdatableObject::BuildDependencyGraph(const std::shared_ptr<UpdatableObject>& updatable_object, std::unordered_map<UpdatableObject*, std::size_t>& node_indices)
+{
+	const auto it = node_indices.find(updatable_object.get());
+	if (it != node_indices.end())
+	{
+		return it->second;
+	}
+
+	std::vector<std::size_t> dependencies;
 	for (const auto& dependency : updatable_object->GetDependencies())
 	{
-		heights.push_back(BuildDependencyLayers(dependency, dependency_layers));
+		dependencies.push_back(BuildDependencyGraph(dependency, node_indices));
 	}
 
-	const auto layer_index = (*std::max_element(heights.begin(), heights.end())) + 1;
-	const auto minimal_layers_count = layer_index + 1;
-	if (dependency_layers.size() < minimal_layers_count)
+	std::sort(dependencies.begin(), dependencies.end());
+	dependencies.erase(std::unique(dependencies.begin(), dependencies.end()), dependencies.end());
+
+	const auto node_index = nodes_.size();
+	nodes_.push_back(updatable_object);
+	node_dependencies_.push_back(std::move(dependencies));
+	node_indices.emplace(updatable_object.get(), node_index);
+	return node_index;
+}
+
+void UpdatableObject::InitializeVariablesFootprints()
+{
+	const auto nodes_count = nodes_.size();
+	std::vector<std::vector<RDS::SparseVariableIndex>> footprints(nodes_count);
+	node_footprint_known_.assign(nodes_count, false);
+	RDS::SparseVariableIndex footprint_variables_count = 0;
+	for (std::size_t node_index = 0; node_index < nodes_count; node_index++)
 	{
-		dependency_layers.resize(minimal_layers_count);
+		auto& footprint = footprints[node_index];
+		node_footprint_known_[node_index] = nodes_[node_index]->GetVariablesFootprint(footprint);
+		std::sort(footprint.begin(), footprint.end());
+		footprint.erase(std::unique(footprint.begin(), footprint.end()), footprint.end());
+		if (!footprint.empty())
+		{
+			footprint_variables_count = std::max(footprint_variables_count, footprint.back() + 1);
+		}
 	}
-	
-	dependency_layers[layer_index].push_back(updatable_object);
-	return layer_index;
+
+	variable_node_offsets_.assign(footprint_variables_count + 1, 0);
+	for (const auto& footprint : footprints)
+	{
+		for (const auto variable_index : footprint)
+		{
+			variable_node_offsets_[variable_index + 1]++;
+		}
+	}
+
+	for (RDS::SparseVariableIndex variable_index = 0; variable_index < footprint_variables_count; variable_index++)
+	{
+		variable_node_offsets_[variable_index + 1] += variable_node_offsets_[variable_index];
+	}
+
+	variable_nodes_.resize(variable_node_offsets_.back());
+	std::vector<std::size_t> positions(variable_node_offsets_.begin(), variable_node_offsets_.end() - 1);
+	for (std::size_t node_index = 0; node_index < nodes_count; node_index++)
+	{
+		for (const auto variable_index : footprints[node_index])
+		{
+			variable_nodes_[positions[variable_index]++] = node_index;
+		}
+	}
+
+	node_update_modifiers_.assign(nodes_count, 0);
+	node_state_versions_.resize(nodes_count);
+	for (std::size_t node_index = 0; node_index < nodes_count; node_index++)
+	{
+		node_state_versions_[node_index] = nodes_[node_index]->state_version_;
+	}
+
+	node_changed_.assign(nodes_count, 1);
+	previous_x_.resize(0);
 }
\ No newline at end of file
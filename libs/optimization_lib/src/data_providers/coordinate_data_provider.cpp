@@ -32,6 +32,12 @@ void CoordinateDataProvider::Update(const Eigen::VectorXd& x, int32_t update_mod
 	Update(x);
 }
 
+bool CoordinateDataProvider::GetVariablesFootprint(std::vector<RDS::SparseVariableIndex>& variables_footprint) const
+{
+	variables_footprint.push_back(sparse_variable_index_);
+	return true;
+}
+
 double CoordinateDataProvider::GetCoordinateValue() const
 {
 	return coordinate_value_;
@@ -40,4 +46,9 @@ double CoordinateDataProvider::GetCoordinateValue() const
 RDS::SparseVariableIndex CoordinateDataProvider::GetSparseVariableIndex() const
 {
 	return sparse_variable_index_;
+}
+
+std::shared_ptr<UpdatableObject> CoordinateDataProvider::CloneObject() const
+{
+	return std::make_shared<CoordinateDataProvider>(*this);
 }
\ No newline at end of file
@@ -35,6 +35,13 @@ void CoordinateDiffDataProvider::Update(const Eigen::VectorXd& x, int32_t update
 	Update(x);
 }
 
+bool CoordinateDiffDataProvider::GetVariablesFootprint(std::vector<RDS::SparseVariableIndex>& variables_footprint) const
+{
+	variables_footprint.push_back(sparse_variable1_index_);
+	variables_footprint.push_back(sparse_variable2_index_);
+	return true;
+}
+
 double CoordinateDiffDataProvider::GetCoordinateDiffValue() const
 {
 	return coordinate_diff_value_;
@@ -48,4 +55,9 @@ RDS::SparseVariableIndex CoordinateDiffDataProvider::GetSparseVariable1Index() c
 RDS::SparseVariableIndex CoordinateDiffDataProvider::GetSparseVariable2Index() const
 {
 	return sparse_variable2_index_;
+}
+
+std::shared_ptr<UpdatableObject> CoordinateDiffDataProvider::CloneObject() const
+{
+	return std::make_shared<CoordinateDiffDataProvider>(*this);
 }
\ No newline at end of file
@@ -50,6 +50,15 @@ void CrossCoordinateDiffDataProvider::Update(const Eigen::VectorXd& x, int32_t u
 	Update(x);
 }
 
+bool CrossCoordinateDiffDataProvider::GetVariablesFootprint(std::vector<RDS::SparseVariableIndex>& variables_footprint) const
+{
+	variables_footprint.push_back(edge1_variable1_index_);
+	variables_footprint.push_back(edge1_variable2_index_);
+	variables_footprint.push_back(edge2_variable1_index_);
+	variables_footprint.push_back(edge2_variable2_index_);
+	return true;
+}
+
 double CrossCoordinateDiffDataProvider::GetCoordinate1DiffValue() const
 {
 	return coordinate1_diff_value_;
@@ -88,4 +97,9 @@ RDS::SparseVariableIndex CrossCoordinateDiffDataProvider::GetEdge2Variable1Index
 RDS::SparseVariableIndex CrossCoordinateDiffDataProvider::GetEdge2Variable2Index() const
 {
 	return edge2_variable2_index_;
+}
+
+std::shared_ptr<UpdatableObject> CrossCoordinateDiffDataProvider::CloneObject() const
+{
+	return std::make_shared<CrossCoordinateDiffDataProvider>(*this);
 }
\ No newline at end of file
@@ -72,4 +72,22 @@ void EdgePairDataProvider::Update(const Eigen::VectorXd& x)
 void EdgePairDataProvider::Update(const Eigen::VectorXd& x, int32_t update_modifiers)
 {
 	Update(x);
+}
+
+bool EdgePairDataProvider::GetVariablesFootprint(std::vector<RDS::SparseVariableIndex>& variables_footprint) const
+{
+	variables_footprint.push_back(edge1_v1_x_index_);
+	variables_footprint.push_back(edge1_v1_y_index_);
+	variables_footprint.push_back(edge1_v2_x_index_);
+	variables_footprint.push_back(edge1_v2_y_index_);
+	variables_footprint.push_back(edge2_v1_x_index_);
+	variables_footprint.push_back(edge2_v1_y_index_);
+	variables_footprint.push_back(edge2_v2_x_index_);
+	variables_footprint.push_back(edge2_v2_y_index_);
+	return true;
+}
+
+std::shared_ptr<UpdatableObject> EdgePairDataProvider::CloneObject() const
+{
+	return std::make_shared<EdgePairDataProvider>(*this);
 }
\ No newline at end of file
@@ -20,4 +20,14 @@ void EmptyDataProvider::Update(const Eigen::VectorXd& x)
 void EmptyDataProvider::Update(const Eigen::VectorXd& x, int32_t update_modifiers)
 {
 	Update(x);
+}
+
+bool EmptyDataProvider::GetVariablesFootprint(std::vector<RDS::SparseVariableIndex>& variables_footprint) const
+{
+	return true;
+}
+
+std::shared_ptr<UpdatableObject> EmptyDataProvider::CloneObject() const
+{
+	return std::make_shared<EmptyDataProvider>(*this);
 }
\ No newline at end of file
@@ -23,6 +23,17 @@ void FaceDataProvider::Update(const Eigen::VectorXd& x, int32_t update_modifiers
 	Update(x);
 }
 
+bool FaceDataProvider::GetVariablesFootprint(std::vector<RDS::SparseVariableIndex>& variables_footprint) const
+{
+	for (const auto vertex_index : face_)
+	{
+		variables_footprint.push_back(mesh_data_provider_->GetXVariableIndex(vertex_index));
+		variables_footprint.push_back(mesh_data_provider_->GetYVariableIndex(vertex_index));
+	}
+
+	return true;
+}
+
 const RDS::Face& FaceDataProvider::GetFace() const
 {
 	return face_;
@@ -31,4 +42,9 @@ const RDS::Face& FaceDataProvider::GetFace() const
 const Eigen::VectorXd& FaceDataProvider::GetBarycenter() const
 {
 	return barycenter_;
+}
+
+std::shared_ptr<UpdatableObject> FaceDataProvider::CloneObject() const
+{
+	return std::make_shared<FaceDataProvider>(*this);
 }
\ No newline at end of file
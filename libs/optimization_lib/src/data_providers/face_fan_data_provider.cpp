@@ -61,6 +61,20 @@ void FaceFanDataProvider::Update(const Eigen::VectorXd& x, int32_t update_modifi
 	Update(x);
 }
 
+bool FaceFanDataProvider::GetVariablesFootprint(std::vector<RDS::SparseVariableIndex>& variables_footprint) const
+{
+	for (const auto& face_fan_slice : face_fan_)
+	{
+		for (const auto vertex_index : { face_fan_slice.first, face_fan_slice.second.first, face_fan_slice.second.second })
+		{
+			variables_footprint.push_back(mesh_data_provider_->GetXVariableIndex(vertex_index));
+			variables_footprint.push_back(mesh_data_provider_->GetYVariableIndex(vertex_index));
+		}
+	}
+
+	return true;
+}
+
 double FaceFanDataProvider::GetAngle() const
 {
 	return angle_;
@@ -74,4 +88,9 @@ const RDS::FaceFan& FaceFanDataProvider::GetFaceFan() const
 RDS::VertexIndex FaceFanDataProvider::GetDomainVertexIndex() const
 {
 	return domain_vertex_index_;
+}
+
+std::shared_ptr<UpdatableObject> FaceFanDataProvider::CloneObject() const
+{
+	return std::make_shared<FaceFanDataProvider>(*this);
 }
\ No newline at end of file
@@ -17,7 +17,6 @@
 #include <igl/massmatrix.h>
 #include <igl/readOFF.h>
 #include <igl/readOBJ.h>
-#include <igl/exact_geodesic.h>
 
 // Spectra
 #include <random>
@@ -157,6 +156,11 @@ const Eigen::MatrixX3d& MeshWrapper::GetD2() const
 	return d2_;
 }
 
+const std::vector<std::pair<int64_t, int64_t>>& MeshWrapper::GetCorrespondingVertexPairs() const
+{
+	return cv_pairs_;
+}
+
 const Eigen::SparseMatrix<double>& MeshWrapper::GetCorrespondingVertexPairsCoefficients() const
 {
 	return cv_pairs_coefficients_;
@@ -220,6 +224,12 @@ void MeshWrapper::LoadModel(const std::string& model_file_path)
 	W_ = -W_;
 
 	igl::massmatrix(v, f, igl::MassMatrixType::MASSMATRIX_TYPE_VORONOI, A_);
+	mass_matrix_operator_ = std::make_shared<MassMatrixOperator>(A_);
+
+	{
+		std::lock_guard<std::mutex> lock(heat_geodesics_mutex_);
+		heat_geodesics_.reset();
+	}
 
 	Eigen::VectorXd area_per_face;
 	area_per_face.resize(f.rows());
@@ -829,6 +839,11 @@ const Eigen::SparseMatrix<double>& MeshWrapper::GetMassMatrix() const
 	return A_;
 }
 
+std::shared_ptr<MassMatrixOperator> MeshWrapper::GetMassMatrixOperator() const
+{
+	return mass_matrix_operator_;
+}
+
 double MeshWrapper::GetArea() const
 {
 	return area_;
@@ -840,24 +855,7 @@ Eigen::VectorXd MeshWrapper::GetRandomVerticesGaussian(int64_t vertex_index)
 	
 
 
-	Eigen::VectorXi vs;
-	vs.resize(1);
-	vs.coeffRef(0) = vertex_index;
-
-	Eigen::VectorXi vt;
-	vt.resize(v_dom_.rows());
-	for(int64_t i = 0; i < v_dom_.rows(); i++)
-	{
-		vt.coeffRef(i) = i;
-	}
-
-	Eigen::VectorXi fs;
-	Eigen::VectorXi ft;
-
-	Eigen::VectorXd D;
-	D.resize(v_dom_.rows());
-	
-	igl::exact_geodesic(v_dom_, f_dom_, vs, fs, vt, ft, D);
+	const Eigen::VectorXd D = GetGeodesicDistances(vertex_index);
 	
 	Eigen::Vector3d center_vertex = v_dom_.row(vertex_index);
 
@@ -878,4 +876,32 @@ Eigen::VectorXd MeshWrapper::GetRandomVerticesGaussian(int64_t vertex_index)
 	}
 
 	return g;
+}
+
+Eigen::VectorXd MeshWrapper::GetGeodesicDistances(RDS::VertexIndex source)
+{
+	return GetHeatGeodesics()->Compute(source);
+}
+
+Eigen::VectorXd MeshWrapper::GetGeodesicDistances(const std::vector<RDS::VertexIndex>& sources)
+{
+	return GetHeatGeodesics()->Compute(sources);
+}
+
+std::shared_ptr<HeatGeodesics> MeshWrapper::GetHeatGeodesics()
+{
+	std::lock_guard<std::mutex> lock(heat_geodesics_mutex_);
+	if (!heat_geodesics_)
+	{
+		/**
+		 * W_ and A_ were computed before the domain was normalized; the cotangent laplacian is scale invariant,
+		 * and the mass matrix only has to be rescaled by the ratio of the areas
+		 */
+		Eigen::VectorXd area_per_face;
+		igl::doublearea(v_dom_, f_dom_, area_per_face);
+		const double area_ratio = (area_per_face.sum() / 2) / area_;
+		heat_geodesics_ = std::make_shared<HeatGeodesics>(v_dom_, f_dom_, W_, area_ratio * A_);
+	}
+
+	return heat_geodesics_;
 }
\ No newline at end of file
@@ -25,4 +25,9 @@ void PlainDataProvider::Update(const Eigen::VectorXd& x, int32_t update_modifier
 const Eigen::VectorXd& PlainDataProvider::GetX() const
 {
 	return x_;
+}
+
+std::shared_ptr<UpdatableObject> PlainDataProvider::CloneObject() const
+{
+	return std::make_shared<PlainDataProvider>(*this);
 }
\ No newline at end of file
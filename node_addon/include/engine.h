@@ -29,6 +29,7 @@
 #include <libs/optimization_lib/include/objective_functions/region_localization_objective.h>
 #include <libs/optimization_lib/include/iterative_methods/newton_method.h>
 #include <libs/optimization_lib/include/iterative_methods/projected_gradient_descent.h>
+#include <libs/optimization_lib/include/iterative_methods/multi_start_localization.h>
 #include <libs/optimization_lib/include/solvers/eigen_sparse_solver.h>
 #include <libs/optimization_lib/include/solvers/pardiso_solver.h>
 
@@ -85,6 +86,25 @@ private:
 		AUTOQUADS
 	};
 
+	// Runs a multi-start localization batch off the main thread, and settles the promise returned by runMultiStartLocalization back on it
+	class MultiStartLocalizationWorker : public Napi::AsyncWorker
+	{
+	public:
+		MultiStartLocalizationWorker(Napi::Env env, Engine& engine, std::unique_ptr<MultiStartLocalization<Eigen::StorageOptions::RowMajor>> multi_start_localization);
+		Napi::Promise GetPromise() const;
+
+	protected:
+		void Execute() override;
+		void OnOK() override;
+		void OnError(const Napi::Error& error) override;
+
+	private:
+		Engine& engine_;
+		Napi::ObjectReference engine_reference_;
+		std::unique_ptr<MultiStartLocalization<Eigen::StorageOptions::RowMajor>> multi_start_localization_;
+		Napi::Promise::Deferred deferred_;
+	};
+
 	static Napi::FunctionReference constructor;
 
 	/**
@@ -157,6 +177,8 @@ private:
 	Napi::Value GetLineSearchIteration(const Napi::CallbackInfo& info);
 	Napi::Value GetStepSize(const Napi::CallbackInfo& info);
 	Napi::Value SetInitialStepSize(const Napi::CallbackInfo& info);
+	Napi::Value SetDirtyTracking(const Napi::CallbackInfo& info);
+	Napi::Value RunMultiStartLocalization(const Napi::CallbackInfo& info);
 	
 	/**
 	 * Regular private instance methods
@@ -355,6 +377,8 @@ private:
 	std::shared_ptr<RegionLocalizationObjective<Eigen::StorageOptions::RowMajor>> region_localization_;
 	bool shape_ready_;
 	bool partial_ready_;
+	bool dirty_tracking_;
+	bool multi_start_localization_running_;
 };
 
 #endif
\ No newline at end of file
@@ -58,7 +58,9 @@ Napi::Object Engine::Init(Napi::Env env, Napi::Object exports)
 		InstanceMethod("getIteration", &Engine::GetIteration),
 		InstanceMethod("getLineSearchIteration", &Engine::GetLineSearchIteration),
 		InstanceMethod("getStepSize", &Engine::GetStepSize),
-		InstanceMethod("setInitialStepSize", &Engine::SetInitialStepSize)
+		InstanceMethod("setInitialStepSize", &Engine::SetInitialStepSize),
+		InstanceMethod("setDirtyTracking", &Engine::SetDirtyTracking),
+		InstanceMethod("runMultiStartLocalization", &Engine::RunMultiStartLocalization)
 	});
 
 	constructor = Napi::Persistent(func);
@@ -73,7 +75,9 @@ Engine::Engine(const Napi::CallbackInfo& info) :
 	mesh_wrapper_shape_(std::make_shared<MeshWrapper>()),
 	mesh_wrapper_partial_(std::make_shared<MeshWrapper>()),
 	shape_ready_(false),
-	partial_ready_(false)
+	partial_ready_(false),
+	dirty_tracking_(false),
+	multi_start_localization_running_(false)
 {
 	mesh_wrapper_shape_->RegisterModelLoadedCallback([this]() {
 		shape_ready_ = true;
@@ -104,28 +108,18 @@ void Engine::InitializeSolver()
 		std::uniform_int_distribution<std::mt19937::result_type> dist(0, mesh_wrapper_shape_->GetDomainVerticesCount() - 1);
 		int64_t vertex_index = dist(rng);
 		
-		Eigen::SparseMatrix<double> W = mesh_wrapper_partial_->GetLaplacian();
-		Eigen::SparseMatrix<double> A = mesh_wrapper_partial_->GetMassMatrix();
-		Eigen::SparseMatrix<double> lhs = W;
-		Eigen::SparseMatrix<double> rhs = A;
-		Spectra::SparseSymMatProd<double> lhs_op(lhs);
-		Spectra::SparseRegularInverse<double> rhs_op(rhs);
-		Spectra::SymGEigsSolver<double, Spectra::SMALLEST_MAGN, Spectra::SparseSymMatProd<double>, Spectra::SparseRegularInverse<double>, Spectra::GEIGS_REGULAR_INVERSE > geigs(&lhs_op, &rhs_op, RDS_NEV, RDS_NCV);
-		geigs.init();
-		int nconv = geigs.compute();
-		if (geigs.info() == Spectra::SUCCESSFUL)
+		Eigen::VectorXd mu;
+		if (RegionLocalizationObjective<Eigen::StorageOptions::RowMajor>::ComputeMu(mesh_wrapper_partial_, mu))
 		{
 			empty_data_provider_ = std::make_shared<EmptyDataProvider>(mesh_wrapper_shape_);
-			Eigen::VectorXd mu = geigs.eigenvalues();
-			mu.conservativeResize(mu.rows() - 1);
 			region_localization_ = std::make_shared<RegionLocalizationObjective<Eigen::StorageOptions::RowMajor>>(mesh_wrapper_shape_, mu, empty_data_provider_);
+			region_localization_->SetDirtyTracking(dirty_tracking_);
 			//Eigen::VectorXd v0 = (Eigen::VectorXd::Random(mesh_wrapper_shape_->GetDomainVerticesCount()) + Eigen::VectorXd::Ones(mesh_wrapper_shape_->GetDomainVerticesCount())) / 2;
 
 
 			
 			Eigen::VectorXd v0 = mesh_wrapper_shape_->GetRandomVerticesGaussian(vertex_index);
 			projected_gradient_descent_ = std::make_unique<ProjectedGradientDescent<Eigen::StorageOptions::RowMajor>>(region_localization_, v0);
-			projected_gradient_descent_->DisableFlipAvoidingLineSearch();
 		}
 	}
 }
@@ -1004,6 +998,13 @@ Napi::Value Engine::LoadShape(const Napi::CallbackInfo& info)
 		return Napi::Value();
 	}
 
+	// The running multi-start localization reads the shape
+	if (multi_start_localization_running_)
+	{
+		Napi::Error::New(env, "Cannot load a shape while a multi-start localization is running").ThrowAsJavaScriptException();
+		return Napi::Value();
+	}
+
 	/**
 	 * Load model
 	 */
@@ -1219,6 +1220,38 @@ Napi::Value Engine::SetInitialStepSize(const Napi::CallbackInfo& info)
 	return env.Null();
 }
 
+// Applies to the current region localization objective, and to the ones that are created later (e.g. by the multi-start localization)
+Napi::Value Engine::SetDirtyTracking(const Napi::CallbackInfo& info)
+{
+	Napi::Env env = info.Env();
+	Napi::HandleScope scope(env);
+
+	/**
+	 * Validate input arguments
+	 */
+	if (info.Length() >= 1)
+	{
+		if (!info[0].IsBoolean())
+		{
+			Napi::TypeError::New(env, "First argument is expected to be a boolean").ThrowAsJavaScriptException();
+			return Napi::Value();
+		}
+	}
+	else
+	{
+		Napi::TypeError::New(env, "Invalid number of arguments").ThrowAsJavaScriptException();
+		return Napi::Value();
+	}
+
+	dirty_tracking_ = info[0].ToBoolean();
+	if (region_localization_ != nullptr)
+	{
+		region_localization_->SetDirtyTracking(dirty_tracking_);
+	}
+
+	return env.Null();
+}
+
 Engine::ModelFileType Engine::GetModelFileType(std::string modelFilePath)
 {
 	std::string fileExtension = modelFilePath.substr(modelFilePath.find_last_of(".") + 1);
@@ -1261,6 +1294,134 @@ Napi::Value Engine::PauseSolver(const Napi::CallbackInfo& info)
 	return env.Null();
 }
 
+Napi::Value Engine::RunMultiStartLocalization(const Napi::CallbackInfo& info)
+{
+	Napi::Env env = info.Env();
+	Napi::HandleScope scope(env);
+
+	if (!region_localization_)
+	{
+		auto deferred = Napi::Promise::Deferred::New(env);
+		deferred.Resolve(env.Null());
+		return deferred.Promise();
+	}
+
+	/**
+	 * Validate input arguments
+	 */
+	if (info.Length() < 1 || info.Length() > 3)
+	{
+		Napi::TypeError::New(env, "Invalid number of arguments").ThrowAsJavaScriptException();
+		return Napi::Value();
+	}
+
+	for (std::size_t i = 0; i < info.Length(); i++)
+	{
+		if (!info[i].IsNumber())
+		{
+			Napi::TypeError::New(env, "Arguments are expected to be numbers").ThrowAsJavaScriptException();
+			return Napi::Value();
+		}
+	}
+
+	const int64_t runs_count = info[0].ToNumber().Int64Value();
+	if (runs_count <= 0)
+	{
+		Napi::TypeError::New(env, "Runs count is expected to be positive").ThrowAsJavaScriptException();
+		return Napi::Value();
+	}
+
+	if (multi_start_localization_running_)
+	{
+		Napi::Error::New(env, "A multi-start localization is already running").ThrowAsJavaScriptException();
+		return Napi::Value();
+	}
+
+	/**
+	 * Run all localizations on a worker thread; the returned promise resolves with the results, once the interactive solver continues from the best one
+	 */
+	auto multi_start_localization = std::make_unique<MultiStartLocalization<Eigen::StorageOptions::RowMajor>>(mesh_wrapper_shape_, region_localization_->GetMu(), runs_count);
+	if (info.Length() >= 2)
+	{
+		multi_start_localization->SetRoundsCount(info[1].ToNumber().Int64Value());
+	}
+
+	if (info.Length() >= 3)
+	{
+		multi_start_localization->SetRoundIterations(info[2].ToNumber().Int64Value());
+	}
+
+	if (projected_gradient_descent_)
+	{
+		projected_gradient_descent_->Terminate();
+	}
+
+	multi_start_localization_running_ = true;
+	auto* multi_start_localization_worker = new MultiStartLocalizationWorker(env, *this, std::move(multi_start_localization));
+	multi_start_localization_worker->Queue();
+	return multi_start_localization_worker->GetPromise();
+}
+
+Engine::MultiStartLocalizationWorker::MultiStartLocalizationWorker(Napi::Env env, Engine& engine, std::unique_ptr<MultiStartLocalization<Eigen::StorageOptions::RowMajor>> multi_start_localization) :
+	Napi::AsyncWorker(env),
+	engine_(engine),
+	engine_reference_(Napi::Persistent(engine.Value())),
+	multi_start_localization_(std::move(multi_start_localization)),
+	deferred_(Napi::Promise::Deferred::New(env))
+{
+
+}
+
+Napi::Promise Engine::MultiStartLocalizationWorker::GetPromise() const
+{
+	return deferred_.Promise();
+}
+
+// Runs on the worker thread; touches nothing but the batch
+void Engine::MultiStartLocalizationWorker::Execute()
+{
+	try
+	{
+		multi_start_localization_->Run();
+	}
+	catch (const std::exception& e)
+	{
+		SetError(e.what());
+	}
+}
+
+// Runs on the main thread
+void Engine::MultiStartLocalizationWorker::OnOK()
+{
+	Napi::Env env = Env();
+	engine_.multi_start_localization_running_ = false;
+
+	const auto& results = multi_start_localization_->GetResults();
+	const Eigen::VectorXd mu = engine_.region_localization_->GetMu();
+	engine_.region_localization_ = std::make_shared<RegionLocalizationObjective<Eigen::StorageOptions::RowMajor>>(engine_.mesh_wrapper_shape_, mu, engine_.empty_data_provider_);
+	engine_.region_localization_->SetDirtyTracking(engine_.dirty_tracking_);
+	engine_.projected_gradient_descent_ = std::make_unique<ProjectedGradientDescent<Eigen::StorageOptions::RowMajor>>(engine_.region_localization_, results.front().x);
+
+	Napi::Array results_array = Napi::Array::New(env, results.size());
+	for (uint32_t i = 0; i < results.size(); i++)
+	{
+		Napi::Object result_object = Napi::Object::New(env);
+		result_object.Set("vertexIndex", Napi::Number::New(env, results[i].seed_vertex_index));
+		result_object.Set("value", Napi::Number::New(env, results[i].value));
+		result_object.Set("iterations", Napi::Number::New(env, results[i].iterations));
+		result_object.Set("pruned", Napi::Boolean::New(env, results[i].pruned));
+		results_array[i] = result_object;
+	}
+
+	deferred_.Resolve(results_array);
+}
+
+void Engine::MultiStartLocalizationWorker::OnError(const Napi::Error& error)
+{
+	engine_.multi_start_localization_running_ = false;
+	deferred_.Reject(error.Value());
+}
+
 Engine::AlgorithmType Engine::StringToAlgorithmType(const std::string& algorithm_type_string)
 {
 	std::string mutable_string = algorithm_type_string;
@@ -1320,7 +1481,6 @@ Napi::Value Engine::SetAlgorithmType(const Napi::CallbackInfo& info)
 		newton_method_->Terminate();
 		newton_method_.release();
 		newton_method_ = std::make_unique<NewtonMethod<PardisoSolver, Eigen::StorageOptions::RowMajor>>(summation_objective_, x0);
-		newton_method_->EnableFlipAvoidingLineSearch(mesh_wrapper_->GetImageFaces());
 		newton_method_->Start();
 	}
 	return env.Null();
@@ -0,0 +1,345 @@
+// GTest includes
+#include <gtest/gtest.h>
+
+// STL includes
+#include <array>
+#include <cmath>
+#include <vector>
+#include <random>
+#include <type_traits>
+
+// Eigen includes
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <Eigen/Eigenvalues>
+
+// Optimization lib includes
+#include <libs/optimization_lib/include/core/psd_projection.h>
+#include <libs/optimization_lib/include/core/dual.h>
+#include <libs/optimization_lib/include/core/hyper_dual.h>
+#include <libs/optimization_lib/include/core/utils.h>
+
+template<typename Size_>
+class PsdProjectionTest : public ::testing::Test
+{
+protected:
+	static constexpr int N = Size_::value;
+	using Matrix = Eigen::Matrix<double, N, N>;
+
+	PsdProjectionTest() :
+		generator_(N)
+	{
+
+	}
+
+	// Random symmetric matrix with the given eigenvalues
+	Matrix CreateMatrix(const Eigen::Matrix<double, N, 1>& eigenvalues)
+	{
+		Matrix A;
+		for (int row = 0; row < N; row++)
+		{
+			for (int column = 0; column < N; column++)
+			{
+				A.coeffRef(row, column) = distribution_(generator_);
+			}
+		}
+
+		const Eigen::HouseholderQR<Matrix> qr(A);
+		const Matrix Q = qr.householderQ();
+		return Q * eigenvalues.asDiagonal() * Q.transpose();
+	}
+
+	// Indefinite, PSD and (repeated eigenvalues) degenerate matrices
+	std::vector<Matrix> CreateMatrices(const int count)
+	{
+		std::vector<Matrix> matrices;
+		for (int i = 0; i < count; i++)
+		{
+			Eigen::Matrix<double, N, 1> eigenvalues;
+			for (int j = 0; j < N; j++)
+			{
+				switch (i % 3)
+				{
+				case 0:
+					eigenvalues.coeffRef(j) = 10 * distribution_(generator_);
+					break;
+				case 1:
+					eigenvalues.coeffRef(j) = 1 + std::abs(10 * distribution_(generator_));
+					break;
+				case 2:
+					eigenvalues.coeffRef(j) = j < N / 2 ? -3 : 2;
+					break;
+				}
+			}
+
+			matrices.push_back(CreateMatrix(eigenvalues));
+		}
+
+		return matrices;
+	}
+
+	static Matrix ProjectReference(const Matrix& H, const double min_eigenvalue = 10e-8)
+	{
+		Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(H);
+		Eigen::VectorXd D = solver.eigenvalues();
+		for (int i = 0; i < N; i++)
+		{
+			if (D.coeff(i) < 0)
+			{
+				D.coeffRef(i) = min_eigenvalue;
+			}
+		}
+
+		return solver.eigenvectors() * D.asDiagonal() * solver.eigenvectors().transpose();
+	}
+
+	// Upper triangle, column by column (the layout expected by PsdProjection), after a padding triplet
+	static void AddTriplets(const Matrix& H, std::vector<Eigen::Triplet<double>>& triplets, std::vector<std::size_t>& offsets)
+	{
+		triplets.push_back(Eigen::Triplet<double>(0, 0, 0));
+		offsets.push_back(triplets.size());
+		for (int column = 0; column < N; column++)
+		{
+			for (int row = 0; row <= column; row++)
+			{
+				triplets.push_back(Eigen::Triplet<double>(row, column, H.coeff(row, column)));
+			}
+		}
+	}
+
+	static void AssertUpperTriangle(const Matrix& expected, const std::vector<Eigen::Triplet<double>>& triplets, std::size_t offset, const double tolerance)
+	{
+		for (int column = 0; column < N; column++)
+		{
+			for (int row = 0; row <= column; row++)
+			{
+				ASSERT_NEAR(triplets[offset++].value(), expected.coeff(row, column), tolerance);
+			}
+		}
+	}
+
+	std::mt19937 generator_;
+	std::uniform_real_distribution<double> distribution_{ -1, 1 };
+};
+
+using PsdProjectionSizes = ::testing::Types<std::integral_constant<int, 4>, std::integral_constant<int, 6>, std::integral_constant<int, 8>>;
+TYPED_TEST_SUITE(PsdProjectionTest, PsdProjectionSizes);
+
+TYPED_TEST(PsdProjectionTest, FixedSize)
+{
+	for (const auto& H : this->CreateMatrices(12))
+	{
+		auto projected_H = H;
+		PsdProjection<TestFixture::N>::Project(projected_H);
+		ASSERT_LT((projected_H - TestFixture::ProjectReference(H)).norm(), 1e-10 * H.norm());
+	}
+}
+
+// The batch size is not a multiple of the lanes count, so the last block is partial
+TYPED_TEST(PsdProjectionTest, Batched)
+{
+	const auto matrices = this->CreateMatrices((2 * PsdProjection<TestFixture::N>::LanesCount) + 3);
+	std::vector<Eigen::Triplet<double>> triplets;
+	std::vector<std::size_t> offsets;
+	for (const auto& H : matrices)
+	{
+		TestFixture::AddTriplets(H, triplets, offsets);
+	}
+
+	PsdProjection<TestFixture::N>::Project(triplets, offsets);
+	for (std::size_t i = 0; i < matrices.size(); i++)
+	{
+		TestFixture::AssertUpperTriangle(TestFixture::ProjectReference(matrices[i]), triplets, offsets[i], 1e-9 * matrices[i].norm());
+	}
+}
+
+// Scales of any sign (and zero) are applied after the projection
+TYPED_TEST(PsdProjectionTest, BatchedScaled)
+{
+	const auto matrices = this->CreateMatrices(PsdProjection<TestFixture::N>::LanesCount + 1);
+	std::vector<Eigen::Triplet<double>> triplets;
+	std::vector<std::size_t> offsets;
+	std::vector<double> scales;
+	for (std::size_t i = 0; i < matrices.size(); i++)
+	{
+		TestFixture::AddTriplets(matrices[i], triplets, offsets);
+		scales.push_back((i % 4 == 3) ? 0 : (i % 2 == 0 ? 2.5 : -0.5));
+	}
+
+	PsdProjection<TestFixture::N>::Project(triplets, offsets, scales);
+	for (std::size_t i = 0; i < matrices.size(); i++)
+	{
+		TestFixture::AssertUpperTriangle(scales[i] * TestFixture::ProjectReference(matrices[i]), triplets, offsets[i], 1e-9 * matrices[i].norm());
+	}
+}
+
+TYPED_TEST(PsdProjectionTest, BatchedLeavesPaddingUntouched)
+{
+	const auto matrices = this->CreateMatrices(5);
+	std::vector<Eigen::Triplet<double>> triplets;
+	std::vector<std::size_t> offsets;
+	for (const auto& H : matrices)
+	{
+		TestFixture::AddTriplets(H, triplets, offsets);
+	}
+
+	PsdProjection<TestFixture::N>::Project(triplets, offsets);
+	for (const auto offset : offsets)
+	{
+		ASSERT_EQ(triplets[offset - 1].value(), 0);
+	}
+}
+
+class SSVD2x2Test : public ::testing::Test
+{
+protected:
+	SSVD2x2Test() :
+		generator_(2)
+	{
+
+	}
+
+	// Random, diagonal, similarity ([a -b; b a], no distinct singular vectors), anti-similarity ([a b; b -a], opposite singular values),
+	// rank one, zero, and sign (and signed zero) combinations that hit the branch cut of atan2
+	std::vector<Eigen::Matrix2d> CreateMatrices(const int random_count)
+	{
+		std::vector<Eigen::Matrix2d> matrices;
+		for (int i = 0; i < random_count; i++)
+		{
+			const double a = 10 * distribution_(generator_);
+			const double b = 10 * distribution_(generator_);
+			const double c = 10 * distribution_(generator_);
+			const double d = 10 * distribution_(generator_);
+			matrices.push_back((Eigen::Matrix2d() << a, b, c, d).finished());
+			matrices.push_back((Eigen::Matrix2d() << a, 0, 0, d).finished());
+			matrices.push_back((Eigen::Matrix2d() << a, -b, b, a).finished());
+			matrices.push_back((Eigen::Matrix2d() << a, b, b, -a).finished());
+			matrices.push_back((Eigen::Matrix2d() << a, 2 * a, b, 2 * b).finished());
+		}
+
+		matrices.push_back(Eigen::Matrix2d::Zero());
+		matrices.push_back(Eigen::Matrix2d::Identity());
+		matrices.push_back(-Eigen::Matrix2d::Identity());
+		matrices.push_back((Eigen::Matrix2d() << -1, 0, 0, 1).finished());
+		matrices.push_back((Eigen::Matrix2d() << 1, 0, 0, -1).finished());
+		matrices.push_back((Eigen::Matrix2d() << -1, -0.0, 0.0, 1).finished());
+		matrices.push_back((Eigen::Matrix2d() << -1, 0.0, -0.0, 1).finished());
+		matrices.push_back((Eigen::Matrix2d() << -2, 0.0, -0.0, -1).finished());
+		matrices.push_back((Eigen::Matrix2d() << 0, 1, 1, 0).finished());
+		matrices.push_back((Eigen::Matrix2d() << 0, -1, 1, 0).finished());
+		matrices.push_back((Eigen::Matrix2d() << 1e-300, 0, 0, 1e-300).finished());
+		return matrices;
+	}
+
+	static void AssertNear(const Eigen::Matrix2d& expected, const Eigen::Matrix2d& actual, const double tolerance)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			ASSERT_NEAR(expected(i), actual(i), tolerance);
+		}
+	}
+
+	std::mt19937 generator_;
+	std::uniform_real_distribution<double> distribution_{ -1, 1 };
+};
+
+// Both variants decompose A into U * S * V^T, with the same (signed) singular values and singular vectors
+TEST_F(SSVD2x2Test, BatchedMatchesScalar)
+{
+	const auto matrices = CreateMatrices(64);
+	const auto count = static_cast<Eigen::Index>(matrices.size());
+	Eigen::VectorXd a(count), b(count), c(count), d(count);
+	for (Eigen::Index i = 0; i < count; i++)
+	{
+		a(i) = matrices[i](0, 0);
+		b(i) = matrices[i](0, 1);
+		c(i) = matrices[i](1, 0);
+		d(i) = matrices[i](1, 1);
+	}
+
+	Eigen::MatrixX2d batched_S(count, 2);
+	Eigen::MatrixX4d batched_U(count, 4);
+	Eigen::MatrixX4d batched_V(count, 4);
+	Utils::SSVD2x2(a, b, c, d, batched_S, batched_U, batched_V);
+
+	for (Eigen::Index i = 0; i < count; i++)
+	{
+		const Eigen::Matrix2d& A = matrices[i];
+		Eigen::Matrix2d U, S, V;
+		Utils::SSVD2x2(A, U, S, V);
+
+		const double tolerance = 1e-13 * std::max(1.0, A.norm());
+		const Eigen::Matrix2d batched_U_i = Eigen::Map<const Eigen::Matrix2d>(Eigen::RowVector4d(batched_U.row(i)).data());
+		const Eigen::Matrix2d batched_V_i = Eigen::Map<const Eigen::Matrix2d>(Eigen::RowVector4d(batched_V.row(i)).data());
+		const Eigen::Matrix2d batched_S_i = Eigen::Vector2d(batched_S.row(i).transpose()).asDiagonal();
+
+		AssertNear(S, batched_S_i, tolerance);
+		AssertNear(U, batched_U_i, 1e-13);
+		AssertNear(V, batched_V_i, 1e-13);
+		AssertNear(A, U * S * V.transpose(), tolerance);
+		AssertNear(A, batched_U_i * batched_S_i * batched_V_i.transpose(), tolerance);
+	}
+}
+
+// Exercises every operation and function, so that both dual types are compared on all of their derivative rules
+template<typename Scalar_>
+Scalar_ DualTestExpression(const std::array<Scalar_, 3>& x)
+{
+	using std::atan2;
+	using std::sqrt;
+	using std::pow;
+	using std::exp;
+	using std::log;
+	using std::sin;
+	using std::cos;
+	using std::abs;
+	const Scalar_ product = x[0] * x[1];
+	const Scalar_ quotient = (x[2] - 0.5) / x[0];
+	const Scalar_ radius = sqrt((x[0] * x[0]) + (x[1] * x[1]));
+	return (2 * atan2(x[1], x[0])) + pow(radius, 3.5) + exp(product / 4) - log(abs(quotient)) + (sin(x[2]) * cos(x[0])) + (1 / x[1]) - (3 - x[2]);
+}
+
+TEST(DualTest, GradientsMatch)
+{
+	std::array<Dual<3>, 3> dual_x;
+	std::array<HyperDual<3>, 3> hyper_dual_x;
+	const std::array<double, 3> values{ 0.7, -1.3, 2.1 };
+	for (int i = 0; i < 3; i++)
+	{
+		dual_x[i] = Dual<3>::Variable(values[i], i);
+		hyper_dual_x[i] = HyperDual<3>::Variable(values[i], i);
+	}
+
+	const auto dual = DualTestExpression(dual_x);
+	const auto hyper_dual = DualTestExpression(hyper_dual_x);
+	ASSERT_NEAR(dual.GetValue(), DualTestExpression(values), 1e-12);
+	ASSERT_NEAR(hyper_dual.GetValue(), DualTestExpression(values), 1e-12);
+	for (int i = 0; i < 3; i++)
+	{
+		ASSERT_NEAR(dual.GetGradient().coeff(i), hyper_dual.GetGradient().coeff(i), 1e-12);
+	}
+}
+
+// The derivatives of a^e are finite at a = 0, wherever they are defined
+TEST(DualTest, PowAtZero)
+{
+	const std::array<double, 4> exponents{ 0, 1, 2, 3 };
+	const std::array<double, 4> first_derivatives{ 0, 1, 0, 0 };
+	const std::array<double, 4> second_derivatives{ 0, 0, 2, 0 };
+	for (std::size_t i = 0; i < exponents.size(); i++)
+	{
+		const auto hyper_dual = pow(HyperDual<1>::Variable(0, 0), exponents[i]);
+		ASSERT_EQ(hyper_dual.GetValue(), std::pow(0.0, exponents[i]));
+		ASSERT_EQ(hyper_dual.GetGradient().coeff(0), first_derivatives[i]);
+		ASSERT_EQ(hyper_dual.GetHessian().coeff(0, 0), second_derivatives[i]);
+
+		const auto dual = pow(Dual<1>::Variable(0, 0), exponents[i]);
+		ASSERT_EQ(dual.GetValue(), std::pow(0.0, exponents[i]));
+		ASSERT_EQ(dual.GetGradient().coeff(0), first_derivatives[i]);
+	}
+
+	// Away from zero, for a non-integer exponent below 2
+	const auto hyper_dual = pow(HyperDual<1>::Variable(2, 0), 1.5);
+	ASSERT_NEAR(hyper_dual.GetGradient().coeff(0), 1.5 * std::sqrt(2.0), 1e-12);
+	ASSERT_NEAR(hyper_dual.GetHessian().coeff(0, 0), 0.75 / std::sqrt(2.0), 1e-12);
+}
@@ -0,0 +1,423 @@
+// GTest includes
+#include <gtest/gtest.h>
+
+// STL includes
+#include <memory>
+#include <cmath>
+
+// Eigen includes
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+
+// Optimization lib includes
+#include <libs/optimization_lib/include/core/utils.h>
+#include <libs/optimization_lib/include/data_providers/mesh_wrapper.h>
+#include <libs/optimization_lib/include/data_providers/empty_data_provider.h>
+#include <libs/optimization_lib/include/data_providers/edge_pair_data_provider.h>
+#include <libs/optimization_lib/include/data_providers/face_fan_data_provider.h>
+#include <libs/optimization_lib/include/objective_functions/objective_function.h>
+#include <libs/optimization_lib/include/objective_functions/seamless_objective.h>
+#include <libs/optimization_lib/include/objective_functions/separation_objective.h>
+#include <libs/optimization_lib/include/objective_functions/singularity/singular_points_position_objective.h>
+
+// Compares two implementations of the same objective (a reference one, and a batched / fused one) at a perturbed image
+template<Eigen::StorageOptions StorageOrder_, typename VectorType_>
+class EquivalenceTest : public ::testing::Test
+{
+protected:
+	EquivalenceTest(const std::string& filename) :
+		filename_(filename)
+	{
+		mesh_wrapper_ = std::make_shared<MeshWrapper>();
+	}
+
+	virtual ~EquivalenceTest() override
+	{
+
+	}
+
+	void SetUp() override
+	{
+		mesh_wrapper_->RegisterModelLoadedCallback([this]() {
+			CreateObjectiveFunctions();
+			auto image_vertices = mesh_wrapper_->GetImageVertices();
+			x_ = Eigen::Map<const Eigen::VectorXd>(image_vertices.data(), image_vertices.cols() * image_vertices.rows());
+
+			// Moves the image away from the rest state, so that no term sits at its minimum
+			for (Eigen::Index i = 0; i < x_.size(); i++)
+			{
+				x_.coeffRef(i) += 0.1 * std::sin(static_cast<double>(i + 1));
+			}
+		});
+
+		mesh_wrapper_->LoadModel(filename_);
+	}
+
+	void TearDown() override
+	{
+
+	}
+
+	virtual void CreateObjectiveFunctions() = 0;
+
+	void Update() const
+	{
+		reference_objective_function_->UpdateLayers(x_);
+		objective_function_->UpdateLayers(x_);
+	}
+
+	// Moves the image again, so that the next update runs on the layouts (and caches) built by the previous one
+	void MoveImage()
+	{
+		for (Eigen::Index i = 0; i < x_.size(); i++)
+		{
+			x_.coeffRef(i) += 0.05 * std::cos(static_cast<double>(i + 1));
+		}
+	}
+
+	static void AssertComponent(const double reference_value, const double value, const double tolerance)
+	{
+		ASSERT_LE(std::abs(reference_value - value), tolerance * (1 + std::abs(reference_value)));
+	}
+
+	void AssertValue(const double tolerance = 1e-10) const
+	{
+		Update();
+		AssertComponent(reference_objective_function_->GetValue(), objective_function_->GetValue(), tolerance);
+	}
+
+	void AssertValuePerVertex(const double tolerance = 1e-10) const
+	{
+		Update();
+		const Eigen::VectorXd reference_f_per_vertex = reference_objective_function_->GetValuePerVertex();
+		const Eigen::VectorXd f_per_vertex = objective_function_->GetValuePerVertex();
+		ASSERT_EQ(reference_f_per_vertex.size(), f_per_vertex.size());
+		for (Eigen::Index i = 0; i < f_per_vertex.size(); i++)
+		{
+			AssertComponent(reference_f_per_vertex.coeff(i), f_per_vertex.coeff(i), tolerance);
+		}
+	}
+
+	void AssertGradient(const double tolerance = 1e-10) const
+	{
+		Update();
+		const Eigen::VectorXd reference_g = reference_objective_function_->GetGradient();
+		const Eigen::VectorXd g = objective_function_->GetGradient();
+		ASSERT_EQ(reference_g.size(), g.size());
+		for (Eigen::Index i = 0; i < g.size(); i++)
+		{
+			AssertComponent(reference_g.coeff(i), g.coeff(i), tolerance);
+		}
+	}
+
+	// Compares the upper triangles (where the analytic hessians are stored)
+	void AssertHessian(const double tolerance = 1e-10) const
+	{
+		Update();
+		const Eigen::MatrixXd reference_H = reference_objective_function_->GetHessian();
+		const Eigen::MatrixXd H = objective_function_->GetHessian();
+		ASSERT_EQ(reference_H.rows(), H.rows());
+		ASSERT_EQ(reference_H.cols(), H.cols());
+		for (Eigen::Index row = 0; row < H.rows(); row++)
+		{
+			for (Eigen::Index col = row; col < H.cols(); col++)
+			{
+				AssertComponent(reference_H.coeff(row, col), H.coeff(row, col), tolerance);
+			}
+		}
+	}
+
+	// Same layout (rows, columns and order) and values
+	void AssertTriplets(const double tolerance = 1e-10) const
+	{
+		Update();
+		const auto& reference_triplets = reference_objective_function_->GetTriplets();
+		const auto& triplets = objective_function_->GetTriplets();
+		ASSERT_EQ(reference_triplets.size(), triplets.size());
+		for (std::size_t i = 0; i < triplets.size(); i++)
+		{
+			ASSERT_EQ(reference_triplets[i].row(), triplets[i].row());
+			ASSERT_EQ(reference_triplets[i].col(), triplets[i].col());
+			AssertComponent(reference_triplets[i].value(), triplets[i].value(), tolerance);
+		}
+	}
+
+	std::shared_ptr<ObjectiveFunction<StorageOrder_, VectorType_>> reference_objective_function_;
+	std::shared_ptr<ObjectiveFunction<StorageOrder_, VectorType_>> objective_function_;
+	std::shared_ptr<MeshWrapper> mesh_wrapper_;
+	Eigen::VectorXd x_;
+	std::string filename_;
+};
+
+// The tree of per-pair objectives against the edge pairs field objective (SeamlessObjective::SetBatchedEdgePairs)
+class SeamlessObjectiveEquivalenceTest : public EquivalenceTest<Eigen::StorageOptions::RowMajor, Eigen::VectorXd>
+{
+protected:
+	SeamlessObjectiveEquivalenceTest(const bool enforce_children_psd = false) :
+		EquivalenceTest("../../../models/obj/three_triangles.obj"),
+		enforce_children_psd_(enforce_children_psd)
+	{
+
+	}
+
+	~SeamlessObjectiveEquivalenceTest() override
+	{
+
+	}
+
+	void CreateObjectiveFunctions() override
+	{
+		reference_objective_function_ = CreateSeamlessObjective(false);
+		objective_function_ = CreateSeamlessObjective(true);
+	}
+
+	std::shared_ptr<SeamlessObjective<Eigen::StorageOptions::RowMajor>> CreateSeamlessObjective(const bool batched_edge_pairs) const
+	{
+		auto seamless_objective = std::make_shared<SeamlessObjective<Eigen::StorageOptions::RowMajor>>(
+			mesh_wrapper_,
+			std::make_shared<EmptyDataProvider>(mesh_wrapper_),
+			enforce_children_psd_);
+
+		seamless_objective->SetBatchedEdgePairs(batched_edge_pairs);
+		const auto& edge_pair_descriptors = mesh_wrapper_->GetEdgePairDescriptors();
+		for (const auto& edge_pair_descriptor : edge_pair_descriptors)
+		{
+			seamless_objective->AddEdgePairObjectives(std::make_shared<EdgePairDataProvider>(mesh_wrapper_, edge_pair_descriptor));
+		}
+
+		seamless_objective->Initialize();
+
+		// Non-default edge weights and interval, which both implementations must apply alike
+		const auto domain_edge_index = mesh_wrapper_->GetDomainEdgeIndex(edge_pair_descriptors[0].first);
+		seamless_objective->SetEdgeAngleWeight(domain_edge_index, 0.5);
+		seamless_objective->SetEdgeLengthWeight(domain_edge_index, 2);
+		seamless_objective->SetInterval(0.8);
+
+		return seamless_objective;
+	}
+
+	void SetEdgeWeights(const double edge_angle_weight, const double edge_length_weight) const
+	{
+		const auto domain_edge_index = mesh_wrapper_->GetDomainEdgeIndex(mesh_wrapper_->GetEdgePairDescriptors()[0].first);
+		for (const auto& objective_function : { reference_objective_function_, objective_function_ })
+		{
+			const auto seamless_objective = std::static_pointer_cast<SeamlessObjective<Eigen::StorageOptions::RowMajor>>(objective_function);
+			seamless_objective->SetEdgeAngleWeight(domain_edge_index, edge_angle_weight);
+			seamless_objective->SetEdgeLengthWeight(domain_edge_index, edge_length_weight);
+		}
+	}
+
+	bool enforce_children_psd_;
+};
+
+// The projected hessians differ by the clamping of (near) zero eigenvalues, and by the accuracy of the (batched and fixed-size) eigensolvers
+class ProjectedSeamlessObjectiveEquivalenceTest : public SeamlessObjectiveEquivalenceTest
+{
+protected:
+	ProjectedSeamlessObjectiveEquivalenceTest() :
+		SeamlessObjectiveEquivalenceTest(true)
+	{
+
+	}
+};
+
+TEST_F(SeamlessObjectiveEquivalenceTest, Value)
+{
+	AssertValue();
+}
+
+TEST_F(SeamlessObjectiveEquivalenceTest, Gradient)
+{
+	AssertGradient();
+}
+
+TEST_F(SeamlessObjectiveEquivalenceTest, Hessian)
+{
+	AssertHessian();
+}
+
+TEST_F(SeamlessObjectiveEquivalenceTest, HessianAfterMove)
+{
+	AssertHessian();
+	MoveImage();
+	AssertHessian();
+}
+
+TEST_F(ProjectedSeamlessObjectiveEquivalenceTest, Value)
+{
+	AssertValue();
+}
+
+TEST_F(ProjectedSeamlessObjectiveEquivalenceTest, Gradient)
+{
+	AssertGradient();
+}
+
+TEST_F(ProjectedSeamlessObjectiveEquivalenceTest, Hessian)
+{
+	AssertHessian(1e-5);
+}
+
+TEST_F(ProjectedSeamlessObjectiveEquivalenceTest, HessianAfterMove)
+{
+	AssertHessian(1e-5);
+	MoveImage();
+	AssertHessian(1e-5);
+}
+
+TEST_F(ProjectedSeamlessObjectiveEquivalenceTest, HessianAfterWeightsChange)
+{
+	AssertHessian(1e-5);
+	SetEdgeWeights(3, 0.25);
+	AssertHessian(1e-5);
+	AssertHessian(1e-5);
+}
+
+// The tree of per-fan objectives against the batch objective (SingularPointsPositionObjective::SetBatchedSingularPoints)
+class SingularPointsPositionObjectiveEquivalenceTest : public EquivalenceTest<Eigen::StorageOptions::RowMajor, Eigen::VectorXd>
+{
+protected:
+	SingularPointsPositionObjectiveEquivalenceTest() :
+		EquivalenceTest("../../../models/obj/two_triangles_v2.obj")
+	{
+
+	}
+
+	~SingularPointsPositionObjectiveEquivalenceTest() override
+	{
+
+	}
+
+	void CreateObjectiveFunctions() override
+	{
+		reference_objective_function_ = CreateSingularPointsPositionObjective(false);
+		objective_function_ = CreateSingularPointsPositionObjective(true);
+	}
+
+	std::shared_ptr<SingularPointsPositionObjective<Eigen::StorageOptions::RowMajor>> CreateSingularPointsPositionObjective(const bool batched_singular_points) const
+	{
+		auto singular_points_objective = std::make_shared<SingularPointsPositionObjective<Eigen::StorageOptions::RowMajor>>(
+			mesh_wrapper_,
+			std::make_shared<EmptyDataProvider>(mesh_wrapper_),
+			1,
+			false);
+
+		singular_points_objective->SetBatchedSingularPoints(batched_singular_points);
+		const auto& face_fans = mesh_wrapper_->GetFaceFans();
+		singular_points_objective->AddSingularPointObjective(std::make_shared<FaceFanDataProvider>(mesh_wrapper_, face_fans[1]));
+		singular_points_objective->AddSingularPointObjective(std::make_shared<FaceFanDataProvider>(mesh_wrapper_, face_fans[2]));
+		singular_points_objective->Initialize();
+
+		// A non-default interval, which both implementations must apply alike
+		singular_points_objective->SetInterval(0.8);
+
+		return singular_points_objective;
+	}
+
+	void AssertSingularityWeightPerVertex() const
+	{
+		Update();
+		const auto reference_singular_points_objective = std::static_pointer_cast<SingularPointsPositionObjective<Eigen::StorageOptions::RowMajor>>(reference_objective_function_);
+		const auto singular_points_objective = std::static_pointer_cast<SingularPointsPositionObjective<Eigen::StorageOptions::RowMajor>>(objective_function_);
+		const Eigen::VectorXd& reference_singularity_weight_per_vertex = reference_singular_points_objective->GetSingularityWeightPerVertex();
+		const Eigen::VectorXd& singularity_weight_per_vertex = singular_points_objective->GetSingularityWeightPerVertex();
+		ASSERT_EQ(reference_singularity_weight_per_vertex.size(), singularity_weight_per_vertex.size());
+		for (Eigen::Index i = 0; i < singularity_weight_per_vertex.size(); i++)
+		{
+			AssertComponent(reference_singularity_weight_per_vertex.coeff(i), singularity_weight_per_vertex.coeff(i), 1e-10);
+		}
+	}
+};
+
+TEST_F(SingularPointsPositionObjectiveEquivalenceTest, Value)
+{
+	AssertValue();
+}
+
+TEST_F(SingularPointsPositionObjectiveEquivalenceTest, ValuePerVertex)
+{
+	AssertValuePerVertex();
+}
+
+TEST_F(SingularPointsPositionObjectiveEquivalenceTest, Gradient)
+{
+	AssertGradient();
+}
+
+TEST_F(SingularPointsPositionObjectiveEquivalenceTest, Hessian)
+{
+	AssertHessian();
+}
+
+TEST_F(SingularPointsPositionObjectiveEquivalenceTest, HessianAfterMove)
+{
+	AssertHessian();
+	MoveImage();
+	AssertHessian();
+}
+
+TEST_F(SingularPointsPositionObjectiveEquivalenceTest, SingularityWeightPerVertex)
+{
+	AssertSingularityWeightPerVertex();
+}
+
+// The sparse products of the corresponding vertex pairs coefficients matrix against the fused per pair kernel (Separation::SetFusedKernel)
+class SeparationEquivalenceTest : public EquivalenceTest<Eigen::StorageOptions::RowMajor, Eigen::VectorXd>
+{
+protected:
+	SeparationEquivalenceTest() :
+		EquivalenceTest("../../../models/obj/three_triangles.obj")
+	{
+
+	}
+
+	~SeparationEquivalenceTest() override
+	{
+
+	}
+
+	void CreateObjectiveFunctions() override
+	{
+		reference_objective_function_ = CreateSeparation(false);
+		objective_function_ = CreateSeparation(true);
+	}
+
+	std::shared_ptr<Separation<Eigen::StorageOptions::RowMajor>> CreateSeparation(const bool fused_kernel) const
+	{
+		auto separation = std::make_shared<Separation<Eigen::StorageOptions::RowMajor>>(
+			mesh_wrapper_,
+			std::make_shared<EmptyDataProvider>(mesh_wrapper_));
+
+		separation->SetFusedKernel(fused_kernel);
+
+		// A non-default delta, which both implementations must apply alike
+		separation->SetDelta(0.5);
+
+		return separation;
+	}
+};
+
+TEST_F(SeparationEquivalenceTest, Value)
+{
+	AssertValue();
+}
+
+TEST_F(SeparationEquivalenceTest, ValuePerVertex)
+{
+	AssertValuePerVertex();
+}
+
+TEST_F(SeparationEquivalenceTest, Gradient)
+{
+	AssertGradient();
+}
+
+TEST_F(SeparationEquivalenceTest, Triplets)
+{
+	AssertTriplets();
+}
+
+TEST_F(SeparationEquivalenceTest, Hessian)
+{
+	AssertHessian();
+}
@@ -17,13 +17,16 @@
 #include <libs/optimization_lib/include/objective_functions/objective_function.h>
 #include <libs/optimization_lib/include/objective_functions/composite_objective.h>
 #include <libs/optimization_lib/include/objective_functions/edge_pair/edge_pair_angle_objective.h>
+#include <libs/optimization_lib/include/objective_functions/edge_pair/edge_pair_angle_auto_diff_objective.h>
 #include <libs/optimization_lib/include/objective_functions/edge_pair/edge_pair_length_objective.h>
 #include <libs/optimization_lib/include/objective_functions/edge_pair/edge_pair_translation_objective.h>
+#include <libs/optimization_lib/include/objective_functions/edge_pair/edge_pair_field_objective.h>
 #include <libs/optimization_lib/include/objective_functions/coordinate_objective.h>
 #include <libs/optimization_lib/include/objective_functions/coordinate_diff_objective.h>
 #include <libs/optimization_lib/include/objective_functions/periodic_objective.h>
 #include <libs/optimization_lib/include/objective_functions/singularity/singular_point_position_objective.h>
 #include <libs/optimization_lib/include/objective_functions/singularity/singular_points_position_objective.h>
+#include <libs/optimization_lib/include/objective_functions/singularity/batch_singular_points_position_objective.h>
 #include <libs/optimization_lib/include/objective_functions/seamless_objective.h>
 #include <libs/optimization_lib/include/objective_functions/separation_objective.h>
 
@@ -215,6 +218,41 @@ protected:
 	}
 };
 
+class PeriodicEdgePairAngleAutoDiffObjectiveFDTest : public FiniteDifferencesTest<Eigen::StorageOptions::RowMajor, Eigen::SparseVector<double>>
+{
+protected:
+	PeriodicEdgePairAngleAutoDiffObjectiveFDTest() :
+		FiniteDifferencesTest("../../../models/obj/two_triangles_v2.obj")
+	{
+
+	}
+
+	~PeriodicEdgePairAngleAutoDiffObjectiveFDTest() override
+	{
+
+	}
+
+	void CreateDataProvider() override
+	{
+		auto& edge_pair_descriptors = mesh_wrapper_->GetEdgePairDescriptors();
+		data_providers_.push_back(std::make_shared<EdgePairDataProvider>(mesh_wrapper_, edge_pair_descriptors[0]));
+	}
+
+	void CreateObjectiveFunction() override
+	{
+		auto edge_pair_angle_objective = std::make_shared<EdgePairAngleAutoDiffObjective<Eigen::StorageOptions::RowMajor>>(
+			mesh_wrapper_,
+			std::dynamic_pointer_cast<EdgePairDataProvider>(data_providers_[0]));
+
+		objective_function_ = std::make_shared<PeriodicObjective<Eigen::StorageOptions::RowMajor>>(
+			mesh_wrapper_,
+			std::make_shared<EmptyDataProvider>(mesh_wrapper_),
+			edge_pair_angle_objective,
+			M_PI / 2,
+			false);
+	}
+};
+
 class EdgePairLengthObjectiveFDTest : public FiniteDifferencesTest<Eigen::StorageOptions::RowMajor, Eigen::SparseVector<double>>
 {
 protected:
@@ -341,6 +379,37 @@ protected:
 	}
 };
 
+class BatchSingularPointsObjectiveFDTest : public FiniteDifferencesTest<Eigen::StorageOptions::RowMajor, Eigen::VectorXd>
+{
+protected:
+	BatchSingularPointsObjectiveFDTest() :
+		FiniteDifferencesTest("../../../models/obj/two_triangles_v2.obj")
+	{
+
+	}
+
+	~BatchSingularPointsObjectiveFDTest() override
+	{
+
+	}
+
+	void CreateDataProvider() override
+	{
+		data_providers_.push_back(std::make_shared<EmptyDataProvider>(mesh_wrapper_));
+	}
+
+	void CreateObjectiveFunction() override
+	{
+		auto& face_fans = mesh_wrapper_->GetFaceFans();
+		objective_function_ = std::make_shared<BatchSingularPointsPositionObjective<Eigen::StorageOptions::RowMajor>>(
+			mesh_wrapper_,
+			std::static_pointer_cast<EmptyDataProvider>(data_providers_[0]),
+			RDS::FaceFans({ face_fans[1], face_fans[2] }),
+			1,
+			false);
+	}
+};
+
 class SeamlessObjectiveFDTest : public FiniteDifferencesTest<Eigen::StorageOptions::RowMajor, Eigen::VectorXd>
 {
 protected:
@@ -379,6 +448,40 @@ protected:
 	}
 };
 
+class EdgePairFieldObjectiveFDTest : public FiniteDifferencesTest<Eigen::StorageOptions::RowMajor, Eigen::VectorXd>
+{
+protected:
+	EdgePairFieldObjectiveFDTest() :
+		FiniteDifferencesTest("../../../models/obj/three_triangles.obj")
+	{
+
+	}
+
+	~EdgePairFieldObjectiveFDTest() override
+	{
+
+	}
+
+	void CreateDataProvider() override
+	{
+		data_providers_.push_back(std::make_shared<EmptyDataProvider>(mesh_wrapper_));
+	}
+
+	void CreateObjectiveFunction() override
+	{
+		auto edge_pair_field_objective = std::make_shared<EdgePairFieldObjective<Eigen::StorageOptions::RowMajor>>(
+			mesh_wrapper_,
+			std::static_pointer_cast<EmptyDataProvider>(data_providers_[0]),
+			mesh_wrapper_->GetEdgePairDescriptors(),
+			false);
+
+		// Seamless leaves the translation term out; turn it on so that it is covered as well
+		edge_pair_field_objective->SetTranslationWeight(1);
+
+		objective_function_ = edge_pair_field_objective;
+	}
+};
+
 class SeparationObjectiveFDTest : public FiniteDifferencesTest<Eigen::StorageOptions::RowMajor, Eigen::VectorXd>
 {
 protected:
@@ -417,6 +520,16 @@ TEST_F(PeriodicEdgePairAngleObjectiveFDTest, Hessian)
 	AssertHessian();
 }
 
+TEST_F(PeriodicEdgePairAngleAutoDiffObjectiveFDTest, Gradient)
+{
+	AssertGradient();
+}
+
+TEST_F(PeriodicEdgePairAngleAutoDiffObjectiveFDTest, Hessian)
+{
+	AssertHessian();
+}
+
 TEST_F(PeriodicCoordinateObjectiveFDTest, Gradient)
 {
 	AssertGradient();
@@ -481,6 +594,18 @@ TEST_F(SingularPointsObjectiveFDTest, Hessian)
 	AssertHessian();
 }
 
+TEST_F(BatchSingularPointsObjectiveFDTest, Gradient)
+{
+	// NOTE: Must hold the fan weights constant in order for this test to pass
+	AssertGradient();
+}
+
+TEST_F(BatchSingularPointsObjectiveFDTest, Hessian)
+{
+	// NOTE: Must hold the fan weights constant in order for this test to pass
+	AssertHessian();
+}
+
 TEST_F(SeamlessObjectiveFDTest, Gradient)
 {
 	AssertGradient();
@@ -491,6 +616,16 @@ TEST_F(SeamlessObjectiveFDTest, Hessian)
 	AssertHessian();
 }
 
+TEST_F(EdgePairFieldObjectiveFDTest, Gradient)
+{
+	AssertGradient();
+}
+
+TEST_F(EdgePairFieldObjectiveFDTest, Hessian)
+{
+	AssertHessian();
+}
+
 TEST_F(SeparationObjectiveFDTest, Gradient)
 {
 	AssertGradient();